@@ -33,6 +33,7 @@ namespace AudioCommon
 	SoundStream* InitSoundStream()
 	{
 		CMixer *mixer = new CMixer(48000);
+		mixer->SetLatency(SConfig::GetInstance().m_MixerLatency);
 
 		// TODO: possible memleak with mixer
 
@@ -135,11 +136,7 @@ namespace AudioCommon
 			CMixer* pMixer = g_sound_stream->GetMixer();
 			if (pMixer)
 			{
-				std::mutex& csMixing = pMixer->MixerCritical();
-				if (doLock)
-					csMixing.lock();
-				else
-					csMixing.unlock();
+				pMixer->PauseMixing(doLock);
 			}
 		}
 	}
@@ -2,10 +2,13 @@
 // Licensed under GPLv2
 // Refer to the license.txt file included.
 
+#include <cmath>
+
 #include "AudioCommon/AudioCommon.h"
 #include "AudioCommon/Mixer.h"
 #include "Common/CPUDetect.h"
 #include "Common/MathUtil.h"
+#include "Common/Thread.h"
 #include "Core/ConfigManager.h"
 #include "Core/Core.h"
 #include "Core/HW/AudioInterface.h"
@@ -18,6 +21,40 @@
 #include <tmmintrin.h>
 #endif
 
+// 4-tap cubic (Catmull-Rom) interpolation filter, split into 256 phases of
+// the fractional sample position. Coefficients are 2.14 fixed point and each
+// phase sums to exactly 1.0, so constant input is passed through unchanged.
+#define RESAMPLER_PHASES 256
+
+static s16 s_resampler_coefs[RESAMPLER_PHASES][4];
+
+static bool InitResamplerCoefs()
+{
+	for (int phase = 0; phase < RESAMPLER_PHASES; ++phase)
+	{
+		double t = phase / (double)RESAMPLER_PHASES;
+		double t2 = t * t;
+		double t3 = t2 * t;
+		s16* c = s_resampler_coefs[phase];
+		c[0] = (s16)lround(16384.0 * (-t3 + 2.0 * t2 - t) / 2.0);
+		c[2] = (s16)lround(16384.0 * (-3.0 * t3 + 4.0 * t2 + t) / 2.0);
+		c[3] = (s16)lround(16384.0 * (t3 - t2) / 2.0);
+		c[1] = 16384 - c[0] - c[2] - c[3];
+	}
+	return true;
+}
+
+static const bool s_resampler_coefs_initialized = InitResamplerCoefs();
+
+static inline int ResampleChannel(const short* buffer, u32 index, const s16* c)
+{
+	s16 s0 = Common::swap16(buffer[(index - 2) & INDEX_MASK]); // previous
+	s16 s1 = Common::swap16(buffer[index & INDEX_MASK]);       // current
+	s16 s2 = Common::swap16(buffer[(index + 2) & INDEX_MASK]); // next
+	s16 s3 = Common::swap16(buffer[(index + 4) & INDEX_MASK]); // after next
+	return (s0 * c[0] + s1 * c[1] + s2 * c[2] + s3 * c[3]) >> 14;
+}
+
 // Executed from sound stream thread
 unsigned int CMixer::MixerFifo::Mix(short* samples, unsigned int numSamples, bool consider_framelimit)
 {
@@ -35,7 +72,7 @@ unsigned int CMixer::MixerFifo::Mix(short* samples, unsigned int numSamples, boo
 
 	float numLeft = (float)(((indexW - indexR) & INDEX_MASK) / 2);
 	m_numLeftI = (numLeft + m_numLeftI*(CONTROL_AVG-1)) / CONTROL_AVG;
-	float offset = (m_numLeftI - LOW_WATERMARK) * CONTROL_FACTOR;
+	float offset = (m_numLeftI - m_low_watermark.load()) * CONTROL_FACTOR;
 	if (offset > MAX_FREQ_SHIFT) offset = MAX_FREQ_SHIFT;
 	if (offset < -MAX_FREQ_SHIFT) offset = -MAX_FREQ_SHIFT;
 
@@ -55,22 +92,18 @@ unsigned int CMixer::MixerFifo::Mix(short* samples, unsigned int numSamples, boo
 	s32 lvolume = m_LVolume.load();
 	s32 rvolume = m_RVolume.load();
 
-	// TODO: consider a higher-quality resampling algorithm.
-	for (; currentSample < numSamples * 2 && ((indexW-indexR) & INDEX_MASK) > 2; currentSample += 2)
+	// The filter reads one sample pair behind and two ahead of indexR.
+	for (; currentSample < numSamples * 2 && ((indexW-indexR) & INDEX_MASK) > 4; currentSample += 2)
 	{
-		u32 indexR2 = indexR + 2; //next sample
+		const s16* coefs = s_resampler_coefs[m_frac >> 8];
 
-		s16 l1 = Common::swap16(m_buffer[indexR & INDEX_MASK]); //current
-		s16 l2 = Common::swap16(m_buffer[indexR2 & INDEX_MASK]); //next
-		int sampleL = ((l1 << 16) + (l2 - l1) * (u16)m_frac) >> 16;
+		int sampleL = ResampleChannel(m_buffer, indexR, coefs);
 		sampleL = (sampleL * lvolume) >> 8;
 		sampleL += samples[currentSample + 1];
 		MathUtil::Clamp(&sampleL, -32767, 32767);
 		samples[currentSample + 1] = sampleL;
 
-		s16 r1 = Common::swap16(m_buffer[(indexR + 1) & INDEX_MASK]); //current
-		s16 r2 = Common::swap16(m_buffer[(indexR2 + 1) & INDEX_MASK]); //next
-		int sampleR = ((r1 << 16) + (r2 - r1) * (u16)m_frac) >> 16;
+		int sampleR = ResampleChannel(m_buffer, indexR + 1, coefs);
 		sampleR = (sampleR * rvolume) >> 8;
 		sampleR += samples[currentSample];
 		MathUtil::Clamp(&sampleR, -32767, 32767);
@@ -81,6 +114,12 @@ unsigned int CMixer::MixerFifo::Mix(short* samples, unsigned int numSamples, boo
 		m_frac &= 0xffff;
 	}
 
+	// Count each time the buffer runs dry, not every call spent padding.
+	bool underrun = currentSample < numSamples * 2;
+	if (underrun && !m_underrunning)
+		m_underruns.fetch_add(1);
+	m_underrunning = underrun;
+
 	// Padding
 	short s[2];
 	s[0] = Common::swap16(m_buffer[(indexR - 1) & INDEX_MASK]);
@@ -108,22 +147,39 @@ unsigned int CMixer::Mix(short* samples, unsigned int num_samples, bool consider
 	if (!samples)
 		return 0;
 
-	std::lock_guard<std::mutex> lk(m_csMixing);
-
 	memset(samples, 0, num_samples * 2 * sizeof(short));
 
-	if (PowerPC::GetState() != PowerPC::CPU_RUNNING)
+	// PauseMixing sets the flag before waiting for the counter to drop, and we
+	// increment the counter before checking the flag, so either it sees this
+	// call or this call sees the pause.
+	m_mixing_in_progress.fetch_add(1);
+
+	if (m_mixing_paused.load() || PowerPC::GetState() != PowerPC::CPU_RUNNING)
 	{
 		// Silence
+		m_mixing_in_progress.fetch_sub(1);
 		return num_samples;
 	}
 
 	m_dma_mixer.Mix(samples, num_samples, consider_framelimit);
 	m_streaming_mixer.Mix(samples, num_samples, consider_framelimit);
 	m_wiimote_speaker_mixer.Mix(samples, num_samples, consider_framelimit);
+
+	m_mixing_in_progress.fetch_sub(1);
 	return num_samples;
 }
 
+void CMixer::PauseMixing(bool pause)
+{
+	m_mixing_paused.store(pause);
+
+	if (pause)
+	{
+		while (m_mixing_in_progress.load())
+			Common::YieldCPU();
+	}
+}
+
 void CMixer::MixerFifo::PushSamples(const short *samples, unsigned int num_samples)
 {
 	// Cache access in non-volatile variable
@@ -132,8 +188,9 @@ void CMixer::MixerFifo::PushSamples(const short *samples, unsigned int num_sampl
 	u32 indexW = m_indexW.load();
 
 	// Check if we have enough free space
-	// indexW == m_indexR results in empty buffer, so indexR must always be smaller than indexW
-	if (num_samples * 2 + ((indexW - m_indexR.load()) & INDEX_MASK) >= MAX_SAMPLES * 2)
+	// indexW == m_indexR results in empty buffer, so indexR must always be smaller than indexW.
+	// The sample pair right before indexR is still read by the resampler.
+	if (num_samples * 2 + ((indexW - m_indexR.load()) & INDEX_MASK) + 2 >= MAX_SAMPLES * 2)
 		return;
 
 	// AyuanX: Actual re-sampling work has been moved to sound thread
@@ -205,6 +262,13 @@ void CMixer::SetWiimoteSpeakerVolume(unsigned int lvolume, unsigned int rvolume)
 	m_wiimote_speaker_mixer.SetVolume(lvolume, rvolume);
 }
 
+void CMixer::SetLatency(unsigned int latency_ms)
+{
+	m_dma_mixer.SetLatency(latency_ms);
+	m_streaming_mixer.SetLatency(latency_ms);
+	m_wiimote_speaker_mixer.SetLatency(latency_ms);
+}
+
 void CMixer::MixerFifo::SetInputSampleRate(unsigned int rate)
 {
 	m_input_sample_rate = rate;
@@ -215,3 +279,16 @@ void CMixer::MixerFifo::SetVolume(unsigned int lvolume, unsigned int rvolume)
 	m_LVolume.store(lvolume + (lvolume >> 7));
 	m_RVolume.store(rvolume + (rvolume >> 7));
 }
+
+void CMixer::MixerFifo::SetLatency(unsigned int latency_ms)
+{
+	latency_ms = MathUtil::Clamp<unsigned int>(latency_ms, MIN_LATENCY_MS, MAX_LATENCY_MS);
+	// The rate control works in 32 kHz sample pairs regardless of the input rate.
+	m_low_watermark.store(latency_ms * 32);
+}
+
+u32 CMixer::MixerFifo::GetBufferedMs() const
+{
+	u32 buffered = ((m_indexW.load() - m_indexR.load()) & INDEX_MASK) / 2;
+	return buffered * 1000 / m_input_sample_rate;
+}
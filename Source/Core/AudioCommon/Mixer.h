@@ -5,7 +5,6 @@
 #pragma once
 
 #include <atomic>
-#include <mutex>
 #include <string>
 
 #include "AudioCommon/WaveFile.h"
@@ -14,7 +13,10 @@
 #define MAX_SAMPLES     (1024 * 2) // 64ms
 #define INDEX_MASK      (MAX_SAMPLES * 2 - 1)
 
-#define LOW_WATERMARK   1280 // 40 ms
+// Target amount of buffered audio, configurable through DSP/MixerLatency.
+#define DEFAULT_LATENCY_MS 40
+#define MIN_LATENCY_MS     5
+#define MAX_LATENCY_MS     56 // leave some room below MAX_SAMPLES
 #define MAX_FREQ_SHIFT  200  // per 32000 Hz
 #define CONTROL_FACTOR  0.2f // in freq_shift per fifo size offset
 #define CONTROL_AVG     32
@@ -30,6 +32,8 @@ public:
 		, m_log_dtk_audio(0)
 		, m_log_dsp_audio(0)
 		, m_speed(0)
+		, m_mixing_paused(false)
+		, m_mixing_in_progress(0)
 	{
 		INFO_LOG(AUDIO_INTERFACE, "Mixer is initialized");
 	}
@@ -49,6 +53,7 @@ public:
 	void SetStreamInputSampleRate(unsigned int rate);
 	void SetStreamingVolume(unsigned int lvolume, unsigned int rvolume);
 	void SetWiimoteSpeakerVolume(unsigned int lvolume, unsigned int rvolume);
+	void SetLatency(unsigned int latency_ms);
 
 	virtual void StartLogDTKAudio(const std::string& filename)
 	{
@@ -108,7 +113,13 @@ public:
 		}
 	}
 
-	std::mutex& MixerCritical() { return m_csMixing; }
+	// Makes the audio thread output silence instead of reading the FIFOs.
+	// When pausing, waits until a Mix call in progress has returned.
+	void PauseMixing(bool pause);
+
+	// Statistics of the DMA (main audio) FIFO, for the OSD.
+	u32 GetBufferedMs() const { return m_dma_mixer.GetBufferedMs(); }
+	u32 GetUnderrunCount() const { return m_dma_mixer.GetUnderrunCount(); }
 
 	float GetCurrentSpeed() const { return m_speed.load(); }
 	void UpdateSpeed(float val) { m_speed.store(val); }
@@ -125,6 +136,9 @@ protected:
 			, m_RVolume(256)
 			, m_numLeftI(0.0f)
 			, m_frac(0)
+			, m_low_watermark(DEFAULT_LATENCY_MS * 32)
+			, m_underruns(0)
+			, m_underrunning(false)
 		{
 			memset(m_buffer, 0, sizeof(m_buffer));
 		}
@@ -132,6 +146,9 @@ protected:
 		unsigned int Mix(short* samples, unsigned int numSamples, bool consider_framelimit = true);
 		void SetInputSampleRate(unsigned int rate);
 		void SetVolume(unsigned int lvolume, unsigned int rvolume);
+		void SetLatency(unsigned int latency_ms);
+		u32 GetBufferedMs() const;
+		u32 GetUnderrunCount() const { return m_underruns.load(); }
 	private:
 		CMixer *m_mixer;
 		unsigned m_input_sample_rate;
@@ -143,6 +160,12 @@ protected:
 		std::atomic<s32> m_RVolume;
 		float m_numLeftI;
 		u32 m_frac;
+		// Buffered stereo samples the rate control aims for.
+		std::atomic<u32> m_low_watermark;
+		// Number of times the buffer ran out of samples and Mix had to pad.
+		std::atomic<u32> m_underruns;
+		// Whether the last Mix call padded; only used by the mixing thread.
+		bool m_underrunning;
 	};
 	MixerFifo m_dma_mixer;
 	MixerFifo m_streaming_mixer;
@@ -155,7 +178,8 @@ protected:
 	bool m_log_dtk_audio;
 	bool m_log_dsp_audio;
 
-	std::mutex m_csMixing;
-
 	std::atomic<float> m_speed; // Current rate of the emulation (1.0 = 100% speed)
+
+	std::atomic<bool> m_mixing_paused;
+	std::atomic<u32> m_mixing_in_progress;
 };
@@ -2,6 +2,8 @@
 // Licensed under GPLv2
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <cstring>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -165,13 +167,12 @@ void MemChecks::AddFromStrings(const TMemChecksStr& mcstrs)
 
 void MemChecks::Add(const TMemCheck& _rMemoryCheck)
 {
-	bool had_any = HasAny();
 	if (GetMemCheck(_rMemoryCheck.StartAddress) == nullptr)
+	{
+		bool had_any = HasAny();
 		m_MemChecks.push_back(_rMemoryCheck);
-	// If this is the first one, clear the JIT cache so it can switch to
-	// watchpoint-compatible code.
-	if (!had_any)
-		jit->ClearCache();
+		Update(had_any);
+	}
 }
 
 void MemChecks::Remove(u32 _Address)
@@ -181,30 +182,75 @@ void MemChecks::Remove(u32 _Address)
 		if (i->StartAddress == _Address)
 		{
 			m_MemChecks.erase(i);
+			Update(true);
 			return;
 		}
 	}
-	if (!HasAny())
+}
+
+void MemChecks::Clear()
+{
+	bool had_any = HasAny();
+	m_MemChecks.clear();
+	Update(had_any);
+}
+
+void MemChecks::Update(bool had_any)
+{
+	m_intervals.clear();
+	for (u32 i = 0; i < (u32)m_MemChecks.size(); ++i)
+	{
+		const TMemCheck& mc = m_MemChecks[i];
+		u32 end = mc.bRange ? mc.EndAddress : mc.StartAddress;
+		m_intervals.push_back({mc.StartAddress, end, end, i});
+	}
+	std::stable_sort(m_intervals.begin(), m_intervals.end(),
+		[](const Interval& a, const Interval& b) { return a.start < b.start; });
+	for (size_t i = 1; i < m_intervals.size(); ++i)
+		m_intervals[i].max_end = std::max(m_intervals[i].end, m_intervals[i - 1].max_end);
+
+	std::vector<u32> pages(NUM_PAGES / 32);
+	for (const Interval& interval : m_intervals)
+	{
+		if (interval.end < interval.start)
+			continue;
+		u32 last = interval.end >> PAGE_SHIFT;
+		for (u32 page = interval.start >> PAGE_SHIFT; page <= last; ++page)
+			pages[page / 32] |= 1u << (page % 32);
+	}
+
+	// Code compiled by the JIT may access memory directly at constant
+	// addresses on pages that weren't watched yet, and its memory options
+	// depend on whether there are any checks at all.
+	bool pages_changed = memcmp(pages.data(), m_watched_pages, sizeof(m_watched_pages)) != 0;
+	memcpy(m_watched_pages, pages.data(), sizeof(m_watched_pages));
+	if ((pages_changed || had_any != HasAny()) && jit)
 		jit->ClearCache();
 }
 
 TMemCheck *MemChecks::GetMemCheck(u32 address)
 {
-	for (TMemCheck& bp : m_MemChecks)
+	if (!IsPageWatched(address))
+		return nullptr;
+
+	// Look at the checks starting at or before the address, from the last one
+	// back, until none of the remaining ones reach far enough. Overlapping
+	// checks resolve to the one that was added first.
+	auto it = std::upper_bound(m_intervals.begin(), m_intervals.end(), address,
+		[](u32 addr, const Interval& interval) { return addr < interval.start; });
+	u32 found = UINT32_MAX;
+	while (it != m_intervals.begin())
 	{
-		if (bp.bRange)
-		{
-			if (address >= bp.StartAddress && address <= bp.EndAddress)
-				return &(bp);
-		}
-		else if (bp.StartAddress == address)
-		{
-			return &(bp);
-		}
+		--it;
+		if (it->max_end < address)
+			break;
+		if (it->end >= address)
+			found = std::min(found, it->index);
 	}
 
-	// none found
-	return nullptr;
+	if (found == UINT32_MAX)
+		return nullptr;
+	return &m_MemChecks[found];
 }
 
 bool TMemCheck::Action(DebugInterface *debug_interface, u32 iValue, u32 addr, bool write, int size, u32 pc)
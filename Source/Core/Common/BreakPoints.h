@@ -92,7 +92,13 @@ public:
 	typedef std::vector<TMemCheck> TMemChecks;
 	typedef std::vector<std::string> TMemChecksStr;
 
-	TMemChecks m_MemChecks;
+	// Pages that have a memory check on them are marked in a bitmap, so that
+	// accesses to any other page can skip looking for a check.
+	enum
+	{
+		PAGE_SHIFT = 12,
+		NUM_PAGES = 1 << (32 - PAGE_SHIFT),
+	};
 
 	const TMemChecks& GetMemChecks() { return m_MemChecks; }
 
@@ -105,9 +111,35 @@ public:
 	TMemCheck *GetMemCheck(u32 address);
 	void Remove(u32 _Address);
 
-	void Clear() { m_MemChecks.clear(); }
+	void Clear();
 
 	bool HasAny() const { return !m_MemChecks.empty(); }
+
+	bool IsPageWatched(u32 address) const
+	{
+		u32 page = address >> PAGE_SHIFT;
+		return (m_watched_pages[page / 32] >> (page % 32)) & 1;
+	}
+
+	// One bit per page, for the JIT to test inline.
+	const u32* GetWatchedPages() const { return m_watched_pages; }
+
+private:
+	struct Interval
+	{
+		u32 start;
+		u32 end;
+		// Highest end of this and all earlier intervals
+		u32 max_end;
+		u32 index;
+	};
+
+	void Update(bool had_any);
+
+	TMemChecks m_MemChecks;
+	// The checks sorted by start address
+	std::vector<Interval> m_intervals;
+	u32 m_watched_pages[NUM_PAGES / 32] = {};
 };
 
 class Watches
@@ -13,6 +13,7 @@
 // - Zero backwards/forwards compatibility
 // - Serialization code for anything complex has to be manually written.
 
+#include <algorithm>
 #include <array>
 #include <cstddef>
 #include <deque>
@@ -64,13 +65,36 @@ public:
 	u8 **ptr;
 	Mode mode;
 
+private:
+	// Only set for growable writers, see below.
+	std::vector<u8>* m_buffer;
+
 public:
-	PointerWrap(u8 **ptr_, Mode mode_) : ptr(ptr_), mode(mode_) {}
+	PointerWrap(u8 **ptr_, Mode mode_) : ptr(ptr_), mode(mode_), m_buffer(nullptr) {}
+
+	// Writer which grows <buffer> as needed, so a state can be saved in a
+	// single pass instead of measuring it first. *ptr_ must initially point to
+	// the start of the buffer. Once done, the caller should shrink the buffer
+	// to the written size (*ptr_ - buffer->data()). The buffer is only ever
+	// grown, so reusing it for states of a similar size doesn't reallocate.
+	PointerWrap(u8 **ptr_, std::vector<u8>* buffer) : ptr(ptr_), mode(MODE_WRITE), m_buffer(buffer) {}
 
 	void SetMode(Mode mode_) { mode = mode_; }
 	Mode GetMode() const { return mode; }
 	u8** GetPPtr() { return ptr; }
 
+	bool IsGrowableWriter() const { return mode == MODE_WRITE && m_buffer != nullptr; }
+
+	// Only valid for growable writers: skips <size> bytes which the caller
+	// fills in later, and returns their offset from the start of the buffer.
+	size_t DoDeferred(u32 size)
+	{
+		ReserveForWrite(size);
+		size_t offset = *ptr - m_buffer->data();
+		*ptr += size;
+		return offset;
+	}
+
 	template <typename K, class V>
 	void Do(std::map<K, V>& x)
 	{
@@ -293,6 +317,17 @@ public:
 	}
 
 private:
+	void ReserveForWrite(u32 size)
+	{
+		size_t offset = *ptr - m_buffer->data();
+		if (offset + size > m_buffer->size())
+		{
+			// Grow geometrically so that many small writes stay cheap.
+			m_buffer->resize(std::max(offset + size, m_buffer->size() * 2));
+			*ptr = m_buffer->data() + offset;
+		}
+	}
+
 	template <typename T>
 	void DoContainer(T& x)
 	{
@@ -314,6 +349,8 @@ private:
 			break;
 
 		case MODE_WRITE:
+			if (m_buffer)
+				ReserveForWrite(size);
 			memcpy(*ptr, data, size);
 			break;
 
@@ -0,0 +1,177 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <string>
+
+#include "Common/CommonFuncs.h"
+#include "Common/CommonTypes.h"
+#include "Common/MappedFile.h"
+#include "Common/StringUtil.h"
+#include "Common/Logging/Log.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#ifdef _WIN32
+
+bool MappedFile::Open(const std::string& filename, bool writable)
+{
+	Close();
+
+	HANDLE file = CreateFile(UTF8ToTStr(filename).c_str(), writable ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ,
+	                         FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		ERROR_LOG(COMMON, "MappedFile: Failed to open %s: %s", filename.c_str(), GetLastErrorMsg().c_str());
+		return false;
+	}
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size))
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	m_file = file;
+	m_size = size.QuadPart;
+	m_writable = writable;
+	m_is_open = true;
+
+	// Empty files can't be mapped.
+	if (m_size == 0)
+		return true;
+
+	m_mapping = CreateFileMapping(file, nullptr, writable ? PAGE_READWRITE : PAGE_READONLY, 0, 0, nullptr);
+	if (m_mapping)
+		m_data = (u8*)MapViewOfFile(m_mapping, writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, 0);
+
+	if (!m_data)
+	{
+		ERROR_LOG(COMMON, "MappedFile: Failed to map %s: %s", filename.c_str(), GetLastErrorMsg().c_str());
+		Close();
+		return false;
+	}
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (m_data)
+		UnmapViewOfFile(m_data);
+	if (m_mapping)
+		CloseHandle(m_mapping);
+	if (m_file)
+		CloseHandle(m_file);
+
+	m_data = nullptr;
+	m_mapping = nullptr;
+	m_file = nullptr;
+	m_size = 0;
+	m_is_open = false;
+	m_writable = false;
+}
+
+bool MappedFile::Flush()
+{
+	if (!m_data || !m_writable)
+		return true;
+
+	return FlushViewOfFile(m_data, 0) && FlushFileBuffers(m_file);
+}
+
+bool MappedFile::Flush(u64 offset, u64 size)
+{
+	if (!m_data || !m_writable || offset >= m_size)
+		return true;
+
+	size = std::min(size, m_size - offset);
+	return FlushViewOfFile(m_data + offset, (SIZE_T)size) && FlushFileBuffers(m_file);
+}
+
+#else
+
+bool MappedFile::Open(const std::string& filename, bool writable)
+{
+	Close();
+
+	int fd = open(filename.c_str(), writable ? O_RDWR : O_RDONLY);
+	if (fd < 0)
+	{
+		ERROR_LOG(COMMON, "MappedFile: Failed to open %s: %s", filename.c_str(), strerror(errno));
+		return false;
+	}
+
+	struct stat st;
+	if (fstat(fd, &st) != 0)
+	{
+		close(fd);
+		return false;
+	}
+
+	m_fd = fd;
+	m_size = st.st_size;
+	m_writable = writable;
+	m_is_open = true;
+
+	// Empty files can't be mapped.
+	if (m_size == 0)
+		return true;
+
+	void* data = mmap(nullptr, (size_t)m_size, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+	if (data == MAP_FAILED)
+	{
+		ERROR_LOG(COMMON, "MappedFile: Failed to map %s: %s", filename.c_str(), strerror(errno));
+		Close();
+		return false;
+	}
+
+	m_data = (u8*)data;
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (m_data)
+		munmap(m_data, (size_t)m_size);
+	if (m_fd >= 0)
+		close(m_fd);
+
+	m_data = nullptr;
+	m_fd = -1;
+	m_size = 0;
+	m_is_open = false;
+	m_writable = false;
+}
+
+bool MappedFile::Flush()
+{
+	if (!m_data || !m_writable)
+		return true;
+
+	return msync(m_data, (size_t)m_size, MS_SYNC) == 0;
+}
+
+bool MappedFile::Flush(u64 offset, u64 size)
+{
+	if (!m_data || !m_writable || offset >= m_size)
+		return true;
+
+	// msync needs a page aligned start.
+	u64 page_size = (u64)sysconf(_SC_PAGESIZE);
+	u64 start = offset & ~(page_size - 1);
+	u64 end = std::min(offset + size, m_size);
+	return msync(m_data + start, (size_t)(end - start), MS_SYNC) == 0;
+}
+
+#endif
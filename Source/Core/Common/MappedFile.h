@@ -0,0 +1,48 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+// Maps a whole file into memory. Read-only mappings are shared with the page
+// cache, so large files can be accessed randomly without reading them up
+// front; writable mappings write changes back to the file.
+
+#pragma once
+
+#include <string>
+
+#include "Common/Common.h"
+#include "Common/CommonTypes.h"
+
+class MappedFile final : public NonCopyable
+{
+public:
+	MappedFile() {}
+	~MappedFile() { Close(); }
+
+	// Fails if the file doesn't exist. An empty file can be opened, but
+	// GetData() returns nullptr for it.
+	bool Open(const std::string& filename, bool writable);
+	void Close();
+
+	// Writes changes of a writable mapping back to the file.
+	bool Flush();
+	// Same, but only for the pages overlapping [offset, offset + size).
+	bool Flush(u64 offset, u64 size);
+
+	bool IsOpen() const { return m_is_open; }
+	bool IsWritable() const { return m_writable; }
+	u8* GetData() const { return m_data; }
+	u64 GetSize() const { return m_size; }
+
+private:
+	u8* m_data = nullptr;
+	u64 m_size = 0;
+	bool m_is_open = false;
+	bool m_writable = false;
+#ifdef _WIN32
+	void* m_file = nullptr;
+	void* m_mapping = nullptr;
+#else
+	int m_fd = -1;
+#endif
+};
@@ -9,6 +9,7 @@
 
 #include <map>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -70,7 +71,7 @@ class SymbolDB
 {
 public:
 	typedef std::map<u32, Symbol>  XFuncMap;
-	typedef std::map<u32, Symbol*> XFuncPtrMap;
+	typedef std::unordered_map<u32, Symbol*> XFuncPtrMap;
 
 protected:
 	XFuncMap    functions;
@@ -97,7 +98,7 @@ public:
 	const XFuncMap &Symbols() const { return functions; }
 	XFuncMap &AccessSymbols() { return functions; }
 
-	void Clear(const char *prefix = "");
+	virtual void Clear(const char *prefix = "");
 	void List();
-	void Index();
+	virtual void Index();
 };
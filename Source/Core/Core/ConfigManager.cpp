@@ -2,6 +2,7 @@
 // Licensed under GPLv2
 // Refer to the license.txt file included.
 
+#include "AudioCommon/Mixer.h"
 #include "Common/CommonPaths.h"
 #include "Common/CommonTypes.h"
 #include "Common/FileUtil.h"
@@ -337,6 +338,7 @@ void SConfig::SaveCoreSettings(IniFile& ini)
 	core->Set("Latency", m_LocalCoreStartupParameter.iLatency);
 	core->Set("MemcardAPath", m_strMemoryCardA);
 	core->Set("MemcardBPath", m_strMemoryCardB);
+	core->Set("MapMemcards", m_MapMemcards);
 	core->Set("AgpCartAPath", m_strGbaCartA);
 	core->Set("AgpCartBPath", m_strGbaCartB);
 	core->Set("SlotA", m_EXIDevice[0]);
@@ -369,6 +371,7 @@ void SConfig::SaveMovieSettings(IniFile& ini)
 
 	movie->Set("PauseMovie", m_PauseMovie);
 	movie->Set("Author", m_strMovieAuthor);
+	movie->Set("StreamInput", m_StreamMovieInput);
 	movie->Set("DumpFrames", m_DumpFrames);
 	movie->Set("DumpFramesSilent", m_DumpFramesSilent);
 	movie->Set("ShowInputDisplay", m_ShowInputDisplay);
@@ -383,6 +386,8 @@ void SConfig::SaveDSPSettings(IniFile& ini)
 	dsp->Set("Backend", sBackend);
 	dsp->Set("Volume", m_Volume);
 	dsp->Set("CaptureLog", m_DSPCaptureLog);
+	dsp->Set("MixerLatency", m_MixerLatency);
+	dsp->Set("ShowAudioStats", m_ShowAudioStats);
 }
 
 void SConfig::SaveInputSettings(IniFile& ini)
@@ -601,6 +606,7 @@ void SConfig::LoadCoreSettings(IniFile& ini)
 	core->Get("Latency",           &m_LocalCoreStartupParameter.iLatency, 2);
 	core->Get("MemcardAPath",      &m_strMemoryCardA);
 	core->Get("MemcardBPath",      &m_strMemoryCardB);
+	core->Get("MapMemcards",       &m_MapMemcards, false);
 	core->Get("AgpCartAPath",      &m_strGbaCartA);
 	core->Get("AgpCartBPath",      &m_strGbaCartB);
 	core->Get("SlotA",       (int*)&m_EXIDevice[0], EXIDEVICE_MEMORYCARD);
@@ -640,6 +646,7 @@ void SConfig::LoadMovieSettings(IniFile& ini)
 
 	movie->Get("PauseMovie", &m_PauseMovie, false);
 	movie->Get("Author", &m_strMovieAuthor, "");
+	movie->Get("StreamInput", &m_StreamMovieInput, false);
 	movie->Get("DumpFrames", &m_DumpFrames, false);
 	movie->Get("DumpFramesSilent", &m_DumpFramesSilent, false);
 	movie->Get("ShowInputDisplay", &m_ShowInputDisplay, false);
@@ -664,6 +671,8 @@ void SConfig::LoadDSPSettings(IniFile& ini)
 #endif
 	dsp->Get("Volume", &m_Volume, 100);
 	dsp->Get("CaptureLog", &m_DSPCaptureLog, false);
+	dsp->Get("MixerLatency", &m_MixerLatency, DEFAULT_LATENCY_MS);
+	dsp->Get("ShowAudioStats", &m_ShowAudioStats, false);
 
 	m_IsMuted = false;
 }
@@ -41,6 +41,8 @@ struct SConfig : NonCopyable
 
 	std::string m_strMemoryCardA;
 	std::string m_strMemoryCardB;
+	// Map raw memory card files instead of reading them into memory
+	bool m_MapMemcards;
 	std::string m_strGbaCartA;
 	std::string m_strGbaCartB;
 	TEXIDevices m_EXIDevice[3];
@@ -98,6 +100,7 @@ struct SConfig : NonCopyable
 	bool m_ShowLag;
 	bool m_ShowFrameCount;
 	std::string m_strMovieAuthor;
+	bool m_StreamMovieInput;
 	unsigned int m_FrameSkip;
 	bool m_DumpFrames;
 	bool m_DumpFramesSilent;
@@ -112,6 +115,9 @@ struct SConfig : NonCopyable
 	bool m_IsMuted;
 	int m_Volume;
 	std::string sBackend;
+	// Amount of audio (in ms) the mixer tries to keep buffered
+	int m_MixerLatency;
+	bool m_ShowAudioStats;
 
 	// Input settings
 	bool m_BackgroundInput;
@@ -109,7 +109,7 @@ void SCoreStartupParameter::LoadDefaults()
 	m_strUniqueID = "00000000";
 }
 
-static const char* GetRegionOfCountry(DiscIO::IVolume::ECountry country)
+const char* SCoreStartupParameter::GetRegionOfCountry(DiscIO::IVolume::ECountry country)
 {
 	switch (country)
 	{
@@ -329,51 +329,60 @@ bool SCoreStartupParameter::AutoSetup(EBootBS2 _BootBS2)
 	return true;
 }
 
+static bool MemcardPathHasRegion(const std::string& memcardPath)
+{
+	std::string region = memcardPath.substr(memcardPath.size()-7, 3);
+	bool hasregion = false;
+	hasregion |= region.compare(USA_DIR) == 0;
+	hasregion |= region.compare(JAP_DIR) == 0;
+	hasregion |= region.compare(EUR_DIR) == 0;
+	return hasregion;
+}
+
 void SCoreStartupParameter::CheckMemcardPath(std::string& memcardPath, std::string gameRegion, bool isSlotA)
+{
+	std::string filename = GetMemcardPathForRegion(memcardPath, gameRegion, isSlotA);
+	if (!memcardPath.empty() && !MemcardPathHasRegion(memcardPath) && File::Exists(memcardPath))
+	{
+		// filename doesn't have region in the extension
+		// If the old file exists we are polite and ask if we should copy it
+		if (PanicYesNoT("Memory Card filename in Slot %c is incorrect\n"
+			"Region not specified\n\n"
+			"Slot %c path was changed to\n"
+			"%s\n"
+			"Would you like to copy the old file to this new location?\n",
+			isSlotA ? 'A':'B', isSlotA ? 'A':'B', filename.c_str()))
+		{
+			if (!File::Copy(memcardPath, filename))
+				PanicAlertT("Copy failed");
+		}
+	}
+	memcardPath = filename; // Always correct the path!
+}
+
+std::string SCoreStartupParameter::GetMemcardPathForRegion(const std::string& memcardPath, const std::string& gameRegion, bool isSlotA)
 {
 	std::string ext("." + gameRegion + ".raw");
 	if (memcardPath.empty())
 	{
 		// Use default memcard path if there is no user defined name
 		std::string defaultFilename = isSlotA ? GC_MEMCARDA : GC_MEMCARDB;
-		memcardPath = File::GetUserPath(D_GCUSER_IDX) + defaultFilename + ext;
+		return File::GetUserPath(D_GCUSER_IDX) + defaultFilename + ext;
 	}
-	else
+
+	std::string filename = memcardPath;
+	if (!MemcardPathHasRegion(filename))
 	{
-		std::string filename = memcardPath;
-		std::string region = filename.substr(filename.size()-7, 3);
-		bool hasregion = false;
-		hasregion |= region.compare(USA_DIR) == 0;
-		hasregion |= region.compare(JAP_DIR) == 0;
-		hasregion |= region.compare(EUR_DIR) == 0;
-		if (!hasregion)
-		{
-			// filename doesn't have region in the extension
-			if (File::Exists(filename))
-			{
-				// If the old file exists we are polite and ask if we should copy it
-				std::string oldFilename = filename;
-				filename.replace(filename.size()-4, 4, ext);
-				if (PanicYesNoT("Memory Card filename in Slot %c is incorrect\n"
-					"Region not specified\n\n"
-					"Slot %c path was changed to\n"
-					"%s\n"
-					"Would you like to copy the old file to this new location?\n",
-					isSlotA ? 'A':'B', isSlotA ? 'A':'B', filename.c_str()))
-				{
-					if (!File::Copy(oldFilename, filename))
-						PanicAlertT("Copy failed");
-				}
-			}
-			memcardPath = filename; // Always correct the path!
-		}
-		else if (region.compare(gameRegion) != 0)
-		{
-			// filename has region, but it's not == gameRegion
-			// Just set the correct filename, the EXI Device will create it if it doesn't exist
-			memcardPath = filename.replace(filename.size()-ext.size(), ext.size(), ext);
-		}
+		// filename doesn't have region in the extension
+		filename.replace(filename.size()-4, 4, ext);
+	}
+	else if (filename.compare(filename.size()-ext.size(), ext.size(), ext) != 0)
+	{
+		// filename has region, but it's not == gameRegion
+		// Just set the correct filename, the EXI Device will create it if it doesn't exist
+		filename.replace(filename.size()-ext.size(), ext.size(), ext);
 	}
+	return filename;
 }
 
 DiscIO::IVolume::ELanguage SCoreStartupParameter::GetCurrentLanguage(bool wii) const
@@ -255,6 +255,10 @@ struct SCoreStartupParameter
 	bool AutoSetup(EBootBS2 _BootBS2);
 	const std::string &GetUniqueID() const { return m_strUniqueID; }
 	void CheckMemcardPath(std::string& memcardPath, std::string gameRegion, bool isSlotA);
+	// The path CheckMemcardPath corrects memcardPath to, without asking to copy anything.
+	static std::string GetMemcardPathForRegion(const std::string& memcardPath, const std::string& gameRegion, bool isSlotA);
+	// USA_DIR, JAP_DIR or EUR_DIR, nullptr if unknown
+	static const char* GetRegionOfCountry(DiscIO::IVolume::ECountry country);
 	DiscIO::IVolume::ELanguage GetCurrentLanguage(bool wii) const;
 
 	IniFile LoadDefaultGameIni() const;
@@ -321,16 +321,30 @@ void DSPEmitter::Compile(u16 start_addr)
 		}
 	}
 
+	bool waits_for_next = false;
 	if (fixup_pc)
 	{
 		MOV(16, M(&(g_dsp.pc)), Imm16(compilePC));
+
+		// The block simply ran into the next one, so chain to it directly
+		// instead of bouncing through the dispatcher. Idle skip blocks have to
+		// go back to the dispatcher to report the skipped cycles. If the next
+		// block isn't compiled yet, this one is recompiled once it is.
+		if (!(DSPAnalyzer::code_flags[start_addr] & DSPAnalyzer::CODE_IDLE_SKIP))
+		{
+			waits_for_next = blockLinks[compilePC] == nullptr;
+			WriteBlockLink(compilePC);
+		}
 	}
 
 	blocks[start_addr] = (DSPCompiledCode)entryPoint;
 
 	// Mark this block as a linkable destination if it does not contain
-	// any unresolved CALL's
-	if (unresolvedJumps[start_addr].empty())
+	// any unresolved CALL's. Waiting for the next block doesn't count, or the
+	// blocks of a loop that jumps back to its start would all wait for each
+	// other and never become linkable.
+	if (unresolvedJumps[start_addr].empty() ||
+	    (waits_for_next && unresolvedJumps[start_addr].size() == 1))
 	{
 		blockLinks[start_addr] = blockLinkEntry;
 
@@ -372,6 +386,29 @@ void DSPEmitter::Compile(u16 start_addr)
 	JMP(returnDispatcher, true);
 }
 
+void DSPEmitter::WriteBlockLink(u16 dest)
+{
+	if (blockLinks[dest] != nullptr)
+	{
+		gpr.flushRegs();
+		// Check if we have enough cycles to execute the next block
+		MOV(16, R(ECX), M(&cyclesLeft));
+		CMP(16, R(ECX), Imm16(blockSize[startAddr] + blockSize[dest]));
+		FixupBranch notEnoughCycles = J_CC(CC_BE);
+
+		SUB(16, R(ECX), Imm16(blockSize[startAddr]));
+		MOV(16, M(&cyclesLeft), R(ECX));
+		JMP(blockLinks[dest], true);
+		SetJumpTarget(notEnoughCycles);
+	}
+	else
+	{
+		// The destination has not been compiled yet.  Add it to the list
+		// of blocks that this block is waiting on.
+		unresolvedJumps[startAddr].push_back(dest);
+	}
+}
+
 const u8 *DSPEmitter::CompileStub()
 {
 	const u8 *entryPoint = AlignCode16();
@@ -35,6 +35,10 @@ public:
 	void Compile(u16 start_addr);
 	void ClearCallFlag();
 
+	// Jumps straight to the block at dest if it is linkable and there are
+	// enough cycles left to run it, otherwise falls through.
+	void WriteBlockLink(u16 dest);
+
 	bool FlagsNeeded();
 
 	void Default(UDSPInstruction inst);
@@ -94,27 +94,7 @@ static void WriteBlockLink(DSPEmitter& emitter, u16 dest)
 {
 	// Jump directly to the called block if it has already been compiled.
 	if (!(dest >= emitter.startAddr && dest <= emitter.compilePC))
-	{
-		if (emitter.blockLinks[dest] != nullptr )
-		{
-			emitter.gpr.flushRegs();
-			// Check if we have enough cycles to execute the next block
-			emitter.MOV(16, R(ECX), M(&cyclesLeft));
-			emitter.CMP(16, R(ECX), Imm16(emitter.blockSize[emitter.startAddr] + emitter.blockSize[dest]));
-			FixupBranch notEnoughCycles = emitter.J_CC(CC_BE);
-
-			emitter.SUB(16, R(ECX), Imm16(emitter.blockSize[emitter.startAddr]));
-			emitter.MOV(16, M(&cyclesLeft), R(ECX));
-			emitter.JMP(emitter.blockLinks[dest], true);
-			emitter.SetJumpTarget(notEnoughCycles);
-		}
-		else
-		{
-			// The destination has not been compiled yet.  Add it to the list
-			// of blocks that this block is waiting on.
-			emitter.unresolvedJumps[emitter.startAddr].push_back(dest);
-		}
-	}
+		emitter.WriteBlockLink(dest);
 }
 
 static void r_jcc(const UDSPInstruction opc, DSPEmitter& emitter)
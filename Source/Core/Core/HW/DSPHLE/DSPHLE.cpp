@@ -11,6 +11,8 @@
 
 #include "Core/ConfigManager.h"
 #include "Core/Core.h"
+#include "Core/Movie.h"
+#include "Core/NetPlayProto.h"
 #include "Core/HW/AudioInterface.h"
 #include "Core/HW/SystemTimers.h"
 #include "Core/HW/VideoInterface.h"
@@ -42,6 +44,10 @@ struct DSPState
 bool DSPHLE::Initialize(bool bWii, bool bDSPThread)
 {
 	m_bWii = bWii;
+	// Running the ucode asynchronously makes the timing of its memory accesses
+	// relative to the CPU nondeterministic.
+	m_bDSPThread = bDSPThread && !NetPlay::IsNetPlayRunning() &&
+	               !Movie::IsMovieActive() && !Core::g_want_determinism;
 	m_pUCode = nullptr;
 	m_lastUCode = nullptr;
 	m_bHalt = false;
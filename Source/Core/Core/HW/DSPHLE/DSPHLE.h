@@ -34,6 +34,9 @@ public:
 
 	CMailHandler& AccessMailHandler() { return m_MailHandler; }
 
+	// Whether ucodes may process their work on a separate thread.
+	bool IsDSPThreadEnabled() const { return m_bDSPThread; }
+
 	// Formerly DSPHandler
 	UCodeInterface *GetUCode();
 	void SetUCode(u32 _crc);
@@ -44,6 +47,7 @@ private:
 
 	// Declarations and definitions
 	bool m_bWii;
+	bool m_bDSPThread;
 
 	// Fake mailbox utility
 	struct DSPState
@@ -4,9 +4,11 @@
 
 #include "Common/FileUtil.h"
 #include "Common/MathUtil.h"
+#include "Common/Thread.h"
 
 #include "Core/ConfigManager.h"
 #include "Core/HW/DSP.h"
+#include "Core/HW/DSPHLE/DSPHLE.h"
 #include "Core/HW/DSPHLE/UCodes/AX.h"
 
 #define AX_GC
@@ -15,6 +17,9 @@
 AXUCode::AXUCode(DSPHLE* dsphle, u32 crc)
 	: UCodeInterface(dsphle, crc)
 	, m_work_available(false)
+	, m_use_worker(dsphle->IsDSPThreadEnabled())
+	, m_work_in_flight(false)
+	, m_list_started(false)
 	, m_cmdlist_size(0)
 {
 	WARN_LOG(DSPHLE, "Instantiating AXUCode: crc=%08x", crc);
@@ -22,13 +27,63 @@ AXUCode::AXUCode(DSPHLE* dsphle, u32 crc)
 	DSP::GenerateDSPInterruptFromDSPEmu(DSP::INT_DSP);
 
 	LoadResamplingCoefficients();
+
+	if (m_use_worker)
+	{
+		m_worker_running.Set();
+		m_worker = std::thread(&AXUCode::WorkerThread, this);
+	}
 }
 
 AXUCode::~AXUCode()
 {
+	StopWorker();
 	m_mail_handler.Clear();
 }
 
+void AXUCode::WorkerThread()
+{
+	Common::SetCurrentThreadName("DSP HLE thread");
+
+	while (true)
+	{
+		m_work_event.Wait();
+		if (!m_worker_running.IsSet())
+			break;
+
+		HandleCommandList();
+		m_work_done_event.Set();
+	}
+}
+
+// Derived ucodes have to call this from their destructor as well: the worker
+// calls the virtual HandleCommandList.
+void AXUCode::StopWorker()
+{
+	if (!m_worker.joinable())
+		return;
+
+	WaitForAsyncWork();
+	m_worker_running.Clear();
+	m_work_event.Set();
+	m_worker.join();
+}
+
+void AXUCode::StartAsyncWork()
+{
+	m_work_in_flight = true;
+	m_work_event.Set();
+}
+
+void AXUCode::WaitForAsyncWork()
+{
+	if (m_work_in_flight)
+	{
+		m_work_done_event.Wait();
+		m_work_in_flight = false;
+	}
+}
+
 void AXUCode::LoadResamplingCoefficients()
 {
 	m_coeffs_available = false;
@@ -608,8 +663,27 @@ void AXUCode::HandleMail(u32 mail)
 
 	if (next_is_cmdlist)
 	{
+		// The worker may still be reading the previous list.
+		WaitForAsyncWork();
 		CopyCmdList(mail, cmdlist_size);
 		m_work_available = true;
+		if (m_use_worker)
+		{
+			if (!m_list_started)
+			{
+				m_list_started = true;
+				StartAsyncWork();
+			}
+			else
+			{
+				// The ucode only runs the newest list on an update. A game
+				// that sends several lists per frame can't be run ahead of
+				// the update without mixing all of them, so it falls back to
+				// processing lists synchronously from now on.
+				WARN_LOG(DSPHLE, "Several command lists per update, disabling the AX worker");
+				m_use_worker = false;
+			}
+		}
 	}
 	else if (m_upload_setup_in_progress)
 	{
@@ -671,7 +745,20 @@ void AXUCode::Update()
 	}
 	else if (m_work_available)
 	{
-		HandleCommandList();
+		if (m_use_worker)
+		{
+			// Lists received since the last update are already being
+			// processed; otherwise the previous list is run again, as in
+			// synchronous mode.
+			if (!m_work_in_flight)
+				StartAsyncWork();
+			WaitForAsyncWork();
+			m_list_started = false;
+		}
+		else
+		{
+			HandleCommandList();
+		}
 		m_cmdlist_size = 0;
 		SignalWorkEnd();
 	}
@@ -684,6 +771,11 @@ u32 AXUCode::GetUpdateMs()
 
 void AXUCode::DoAXState(PointerWrap& p)
 {
+	WaitForAsyncWork();
+	// A loaded list is run from the next update.
+	if (p.GetMode() == PointerWrap::MODE_READ)
+		m_list_started = false;
+
 	p.Do(m_cmdlist);
 	p.Do(m_cmdlist_size);
 
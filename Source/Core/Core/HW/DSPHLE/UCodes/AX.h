@@ -12,6 +12,10 @@
 
 #pragma once
 
+#include <thread>
+
+#include "Common/Event.h"
+#include "Common/Flag.h"
 #include "Core/HW/DSPHLE/UCodes/AXStructs.h"
 #include "Core/HW/DSPHLE/UCodes/UCodes.h"
 
@@ -87,6 +91,24 @@ protected:
 	// This flag is set if there is anything to process.
 	bool m_work_available;
 
+	// When the DSP thread is enabled, command lists are processed on a worker
+	// thread as soon as they are received, overlapping with CPU emulation.
+	// Update() waits for the results before signaling the end of the work to
+	// the CPU, so the CPU never sees a partially processed frame.
+	bool m_use_worker;
+	bool m_work_in_flight;
+	// A list was handed to the worker since the last update.
+	bool m_list_started;
+	std::thread m_worker;
+	Common::Flag m_worker_running;
+	Common::Event m_work_event;
+	Common::Event m_work_done_event;
+
+	void StopWorker();
+	void StartAsyncWork();
+	void WaitForAsyncWork();
+	void WorkerThread();
+
 	u16 m_cmdlist[512];
 	u32 m_cmdlist_size;
 
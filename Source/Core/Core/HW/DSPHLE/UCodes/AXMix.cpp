@@ -0,0 +1,108 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include "Common/CommonTypes.h"
+#include "Common/Intrinsics.h"
+#include "Common/MathUtil.h"
+#include "Core/HW/DSPHLE/UCodes/AXMix.h"
+
+namespace AXMix
+{
+
+static inline s16 ScaleSample(s16 sample, u16 volume)
+{
+	return (s16)MathUtil::Clamp(((s32)sample * volume) >> 15, -32767, 32767);	// -32768 ?
+}
+
+#ifdef _M_X86
+// Scales 8 samples by 8 unsigned 1.15 volumes, with the same rounding and
+// clamping as ScaleSample. SSE2 only has signed 16x16 multiplies, so the
+// high half of the product is fixed up for volumes >= 0x8000.
+static inline __m128i ScaleSamples(__m128i samples, __m128i volumes)
+{
+	__m128i lo = _mm_mullo_epi16(samples, volumes);
+	__m128i hi = _mm_mulhi_epi16(samples, volumes);
+	hi = _mm_add_epi16(hi, _mm_and_si128(samples, _mm_srai_epi16(volumes, 15)));
+
+	__m128i prod_lo = _mm_srai_epi32(_mm_unpacklo_epi16(lo, hi), 15);
+	__m128i prod_hi = _mm_srai_epi32(_mm_unpackhi_epi16(lo, hi), 15);
+
+	// Packing saturates to [-32768, 32767], the lower bound is one higher.
+	return _mm_max_epi16(_mm_packs_epi32(prod_lo, prod_hi), _mm_set1_epi16(-32767));
+}
+
+// Volumes for the next 8 samples when ramping by <delta> per sample.
+static inline __m128i RampVolumes(u16 volume, u16 delta)
+{
+	__m128i steps = _mm_mullo_epi16(_mm_setr_epi16(0, 1, 2, 3, 4, 5, 6, 7), _mm_set1_epi16(delta));
+	return _mm_add_epi16(_mm_set1_epi16(volume), steps);
+}
+#endif
+
+void ApplyVolume(s16* samples, u32 count, u16* volume, s16 volume_delta)
+{
+	u16 vol = *volume;
+	u32 i = 0;
+
+#ifdef _M_X86
+	for (; i + 8 <= count; i += 8)
+	{
+		__m128i in = _mm_loadu_si128((__m128i*)&samples[i]);
+		_mm_storeu_si128((__m128i*)&samples[i], ScaleSamples(in, RampVolumes(vol, volume_delta)));
+		vol += volume_delta * 8;
+	}
+#endif
+
+	for (; i < count; ++i)
+	{
+		samples[i] = ScaleSample(samples[i], vol);
+		vol += volume_delta;
+	}
+
+	*volume = vol;
+}
+
+void MixAdd(int* out, const s16* input, u32 count, u16* pvol, s16* dpop, bool ramp)
+{
+	u16& volume = pvol[0];
+	u16 volume_delta = pvol[1];
+
+	// If volume ramping is disabled, set volume_delta to 0. That way, the
+	// mixing loop can avoid testing if volume ramping is enabled at each step,
+	// and just add volume_delta.
+	if (!ramp)
+		volume_delta = 0;
+
+	u32 i = 0;
+
+#ifdef _M_X86
+	for (; i + 8 <= count; i += 8)
+	{
+		__m128i in = _mm_loadu_si128((const __m128i*)&input[i]);
+		__m128i scaled = ScaleSamples(in, RampVolumes(volume, volume_delta));
+
+		// Sign extend to 32 bits and accumulate.
+		__m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(scaled, scaled), 16);
+		__m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(scaled, scaled), 16);
+		__m128i* dst = (__m128i*)&out[i];
+		_mm_storeu_si128(dst, _mm_add_epi32(_mm_loadu_si128(dst), lo));
+		_mm_storeu_si128(dst + 1, _mm_add_epi32(_mm_loadu_si128(dst + 1), hi));
+
+		volume += volume_delta * 8;
+		*dpop = (s16)_mm_extract_epi16(scaled, 7);
+	}
+#endif
+
+	for (; i < count; ++i)
+	{
+		s16 sample = ScaleSample(input[i], volume);
+
+		out[i] += sample;
+		volume += volume_delta;
+
+		*dpop = sample;
+	}
+}
+
+}
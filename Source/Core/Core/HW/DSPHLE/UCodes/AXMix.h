@@ -0,0 +1,26 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "Common/CommonTypes.h"
+
+// Sample mixing kernels shared by the GC and Wii versions of AX. These are
+// the inner loops run for every voice and every output bus, so they are kept
+// out of AXVoice.h to allow vectorized implementations.
+namespace AXMix
+{
+
+// Multiplies <count> samples in place by a 1.15 fixed point volume which is
+// incremented by <volume_delta> after each sample. Results are clamped to
+// [-32767, 32767]. <volume> is updated to the volume after the last sample.
+void ApplyVolume(s16* samples, u32 count, u16* volume, s16 volume_delta);
+
+// Same as ApplyVolume, but adds the scaled samples to <out> instead of
+// writing them back. <pvol> points to a volume/delta pair as stored in the
+// PB mixer structures. If <ramp> is false, the volume stays constant. The
+// last scaled sample is stored in <dpop>.
+void MixAdd(int* out, const s16* input, u32 count, u16* pvol, s16* dpop, bool ramp);
+
+}
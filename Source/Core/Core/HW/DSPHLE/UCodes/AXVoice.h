@@ -12,13 +12,12 @@
 #error AXVoice.h included without specifying version
 #endif
 
-#include <functional>
-
 #include "Common/CommonTypes.h"
 #include "Common/MathUtil.h"
 #include "Core/HW/DSP.h"
 #include "Core/HW/Memmap.h"
 #include "Core/HW/DSPHLE/UCodes/AX.h"
+#include "Core/HW/DSPHLE/UCodes/AXMix.h"
 #include "Core/HW/DSPHLE/UCodes/AXStructs.h"
 
 #ifdef AX_GC
@@ -277,7 +276,11 @@ u16 AcceleratorGetSample()
 // We start getting samples not from sample 0, but 0.<curr_pos_frac>. This
 // avoids discontinuities in the audio stream, especially with very low ratios
 // which interpolate a lot of values between two "real" samples.
-u32 ResampleAudio(std::function<s16(u32)> input_callback, s16* output, u32 count,
+//
+// <input_callback> is called with the index of each input sample to read. It
+// is a template parameter so that the per-sample call can be inlined.
+template <typename InputCallback>
+u32 ResampleAudio(InputCallback input_callback, s16* output, u32 count,
                   s16* last_samples, u32 curr_pos, u32 ratio, int srctype,
                   const s16* coeffs)
 {
@@ -413,32 +416,6 @@ void GetInputSamples(PB_TYPE& pb, s16* samples, u16 count, const s16* coeffs)
 	pb.audio_addr.cur_addr_lo = (u16)(cur_addr & 0xFFFF);
 }
 
-// Add samples to an output buffer, with optional volume ramping.
-void MixAdd(int* out, const s16* input, u32 count, u16* pvol, s16* dpop, bool ramp)
-{
-	u16& volume = pvol[0];
-	u16 volume_delta = pvol[1];
-
-	// If volume ramping is disabled, set volume_delta to 0. That way, the
-	// mixing loop can avoid testing if volume ramping is enabled at each step,
-	// and just add volume_delta.
-	if (!ramp)
-		volume_delta = 0;
-
-	for (u32 i = 0; i < count; ++i)
-	{
-		s64 sample = input[i];
-		sample *= volume;
-		sample >>= 15;
-		sample = MathUtil::Clamp((s32)sample, -32767, 32767);	// -32768 ?
-
-		out[i] += (s16)sample;
-		volume += volume_delta;
-
-		*dpop = (s16)sample;
-	}
-}
-
 // Execute a low pass filter on the samples using one history value. Returns
 // the new history value.
 s16 LowPassFilter(s16* samples, u32 count, s16 yn1, u16 a0, u16 b0)
@@ -461,11 +438,7 @@ void ProcessVoice(PB_TYPE& pb, const AXBuffers& buffers, u16 count, AXMixControl
 	GetInputSamples(pb, samples, count, coeffs);
 
 	// Apply a global volume ramp using the volume envelope parameters.
-	for (u32 i = 0; i < count; ++i)
-	{
-		samples[i] = MathUtil::Clamp(((s32)samples[i] * pb.vol_env.cur_volume) >> 15, -32767, 32767);	// -32768 ?
-		pb.vol_env.cur_volume += pb.vol_env.cur_volume_delta;
-	}
+	AXMix::ApplyVolume(samples, count, &pb.vol_env.cur_volume, pb.vol_env.cur_volume_delta);
 
 	// Optionally, execute a low pass filter
 	// TODO: LPF code is currently broken, causing Super Monkey Ball sound
@@ -482,33 +455,33 @@ void ProcessVoice(PB_TYPE& pb, const AXBuffers& buffers, u16 count, AXMixControl
 #define RAMP_ON(C) (0 != (mctrl & MIX_##C##_RAMP))
 
 	if (MIX_ON(L))
-		MixAdd(buffers.left, samples, count, &pb.mixer.left, &pb.dpop.left, RAMP_ON(L));
+		AXMix::MixAdd(buffers.left, samples, count, &pb.mixer.left, &pb.dpop.left, RAMP_ON(L));
 	if (MIX_ON(R))
-		MixAdd(buffers.right, samples, count, &pb.mixer.right, &pb.dpop.right, RAMP_ON(R));
+		AXMix::MixAdd(buffers.right, samples, count, &pb.mixer.right, &pb.dpop.right, RAMP_ON(R));
 	if (MIX_ON(S))
-		MixAdd(buffers.surround, samples, count, &pb.mixer.surround, &pb.dpop.surround, RAMP_ON(S));
+		AXMix::MixAdd(buffers.surround, samples, count, &pb.mixer.surround, &pb.dpop.surround, RAMP_ON(S));
 
 	if (MIX_ON(AUXA_L))
-		MixAdd(buffers.auxA_left, samples, count, &pb.mixer.auxA_left, &pb.dpop.auxA_left, RAMP_ON(AUXA_L));
+		AXMix::MixAdd(buffers.auxA_left, samples, count, &pb.mixer.auxA_left, &pb.dpop.auxA_left, RAMP_ON(AUXA_L));
 	if (MIX_ON(AUXA_R))
-		MixAdd(buffers.auxA_right, samples, count, &pb.mixer.auxA_right, &pb.dpop.auxA_right, RAMP_ON(AUXA_R));
+		AXMix::MixAdd(buffers.auxA_right, samples, count, &pb.mixer.auxA_right, &pb.dpop.auxA_right, RAMP_ON(AUXA_R));
 	if (MIX_ON(AUXA_S))
-		MixAdd(buffers.auxA_surround, samples, count, &pb.mixer.auxA_surround, &pb.dpop.auxA_surround, RAMP_ON(AUXA_S));
+		AXMix::MixAdd(buffers.auxA_surround, samples, count, &pb.mixer.auxA_surround, &pb.dpop.auxA_surround, RAMP_ON(AUXA_S));
 
 	if (MIX_ON(AUXB_L))
-		MixAdd(buffers.auxB_left, samples, count, &pb.mixer.auxB_left, &pb.dpop.auxB_left, RAMP_ON(AUXB_L));
+		AXMix::MixAdd(buffers.auxB_left, samples, count, &pb.mixer.auxB_left, &pb.dpop.auxB_left, RAMP_ON(AUXB_L));
 	if (MIX_ON(AUXB_R))
-		MixAdd(buffers.auxB_right, samples, count, &pb.mixer.auxB_right, &pb.dpop.auxB_right, RAMP_ON(AUXB_R));
+		AXMix::MixAdd(buffers.auxB_right, samples, count, &pb.mixer.auxB_right, &pb.dpop.auxB_right, RAMP_ON(AUXB_R));
 	if (MIX_ON(AUXB_S))
-		MixAdd(buffers.auxB_surround, samples, count, &pb.mixer.auxB_surround, &pb.dpop.auxB_surround, RAMP_ON(AUXB_S));
+		AXMix::MixAdd(buffers.auxB_surround, samples, count, &pb.mixer.auxB_surround, &pb.dpop.auxB_surround, RAMP_ON(AUXB_S));
 
 #ifdef AX_WII
 	if (MIX_ON(AUXC_L))
-		MixAdd(buffers.auxC_left, samples, count, &pb.mixer.auxC_left, &pb.dpop.auxC_left, RAMP_ON(AUXC_L));
+		AXMix::MixAdd(buffers.auxC_left, samples, count, &pb.mixer.auxC_left, &pb.dpop.auxC_left, RAMP_ON(AUXC_L));
 	if (MIX_ON(AUXC_R))
-		MixAdd(buffers.auxC_right, samples, count, &pb.mixer.auxC_right, &pb.dpop.auxC_right, RAMP_ON(AUXC_R));
+		AXMix::MixAdd(buffers.auxC_right, samples, count, &pb.mixer.auxC_right, &pb.dpop.auxC_right, RAMP_ON(AUXC_R));
 	if (MIX_ON(AUXC_S))
-		MixAdd(buffers.auxC_surround, samples, count, &pb.mixer.auxC_surround, &pb.dpop.auxC_surround, RAMP_ON(AUXC_S));
+		AXMix::MixAdd(buffers.auxC_surround, samples, count, &pb.mixer.auxC_surround, &pb.dpop.auxC_surround, RAMP_ON(AUXC_S));
 #endif
 
 #undef MIX_ON
@@ -543,21 +516,21 @@ void ProcessVoice(PB_TYPE& pb, const AXBuffers& buffers, u16 count, AXMixControl
 #define WMCHAN_MIX_RAMP(n) (0 != ((pb.remote_mixer_control >> (2 * n)) & 2))
 
 		if (WMCHAN_MIX_ON(0))
-			MixAdd(buffers.wm_main0, wm_samples, wm_count, &pb.remote_mixer.main0, &pb.remote_dpop.main0, WMCHAN_MIX_RAMP(0));
+			AXMix::MixAdd(buffers.wm_main0, wm_samples, wm_count, &pb.remote_mixer.main0, &pb.remote_dpop.main0, WMCHAN_MIX_RAMP(0));
 		if (WMCHAN_MIX_ON(1))
-			MixAdd(buffers.wm_aux0, wm_samples, wm_count, &pb.remote_mixer.aux0, &pb.remote_dpop.aux0, WMCHAN_MIX_RAMP(1));
+			AXMix::MixAdd(buffers.wm_aux0, wm_samples, wm_count, &pb.remote_mixer.aux0, &pb.remote_dpop.aux0, WMCHAN_MIX_RAMP(1));
 		if (WMCHAN_MIX_ON(2))
-			MixAdd(buffers.wm_main1, wm_samples, wm_count, &pb.remote_mixer.main1, &pb.remote_dpop.main1, WMCHAN_MIX_RAMP(2));
+			AXMix::MixAdd(buffers.wm_main1, wm_samples, wm_count, &pb.remote_mixer.main1, &pb.remote_dpop.main1, WMCHAN_MIX_RAMP(2));
 		if (WMCHAN_MIX_ON(3))
-			MixAdd(buffers.wm_aux1, wm_samples, wm_count, &pb.remote_mixer.aux1, &pb.remote_dpop.aux1, WMCHAN_MIX_RAMP(3));
+			AXMix::MixAdd(buffers.wm_aux1, wm_samples, wm_count, &pb.remote_mixer.aux1, &pb.remote_dpop.aux1, WMCHAN_MIX_RAMP(3));
 		if (WMCHAN_MIX_ON(4))
-			MixAdd(buffers.wm_main2, wm_samples, wm_count, &pb.remote_mixer.main2, &pb.remote_dpop.main2, WMCHAN_MIX_RAMP(4));
+			AXMix::MixAdd(buffers.wm_main2, wm_samples, wm_count, &pb.remote_mixer.main2, &pb.remote_dpop.main2, WMCHAN_MIX_RAMP(4));
 		if (WMCHAN_MIX_ON(5))
-			MixAdd(buffers.wm_aux2, wm_samples, wm_count, &pb.remote_mixer.aux2, &pb.remote_dpop.aux2, WMCHAN_MIX_RAMP(5));
+			AXMix::MixAdd(buffers.wm_aux2, wm_samples, wm_count, &pb.remote_mixer.aux2, &pb.remote_dpop.aux2, WMCHAN_MIX_RAMP(5));
 		if (WMCHAN_MIX_ON(6))
-			MixAdd(buffers.wm_main3, wm_samples, wm_count, &pb.remote_mixer.main3, &pb.remote_dpop.main3, WMCHAN_MIX_RAMP(6));
+			AXMix::MixAdd(buffers.wm_main3, wm_samples, wm_count, &pb.remote_mixer.main3, &pb.remote_dpop.main3, WMCHAN_MIX_RAMP(6));
 		if (WMCHAN_MIX_ON(7))
-			MixAdd(buffers.wm_aux3, wm_samples, wm_count, &pb.remote_mixer.aux3, &pb.remote_dpop.aux3, WMCHAN_MIX_RAMP(7));
+			AXMix::MixAdd(buffers.wm_aux3, wm_samples, wm_count, &pb.remote_mixer.aux3, &pb.remote_dpop.aux3, WMCHAN_MIX_RAMP(7));
 	}
 #undef WMCHAN_MIX_RAMP
 #undef WMCHAN_MIX_ON
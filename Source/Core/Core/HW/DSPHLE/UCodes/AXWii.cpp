@@ -29,6 +29,7 @@ AXWiiUCode::AXWiiUCode(DSPHLE *dsphle, u32 crc)
 
 AXWiiUCode::~AXWiiUCode()
 {
+	StopWorker();
 }
 
 void AXWiiUCode::HandleCommandList()
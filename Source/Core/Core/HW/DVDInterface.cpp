@@ -17,6 +17,7 @@
 #include "Core/Movie.h"
 #include "Core/HW/AudioInterface.h"
 #include "Core/HW/DVDInterface.h"
+#include "Core/HW/DVDThread.h"
 #include "Core/HW/Memmap.h"
 #include "Core/HW/MMIO.h"
 #include "Core/HW/ProcessorInterface.h"
@@ -316,6 +317,8 @@ void DoState(PointerWrap &p)
 	p.Do(g_last_read_time);
 
 	p.Do(g_bStopAtTrackEnd);
+
+	DVDThread::DoState(p);
 }
 
 static void FinishExecuteCommand(u64 userdata, int cyclesLate)
@@ -336,9 +339,16 @@ static void FinishExecuteReadCommand(u64 userdata, int cyclesLate)
 	}
 	else
 	{
-		// Here is the actual disc reading
-		if (!DVDRead(current_read_command.DVD_offset, current_read_command.output_address,
-		             current_read_command.length, current_read_command.decrypt))
+		// The read was started by ExecuteCommand; it is only redone here
+		// if a savestate was loaded in the meantime.
+		bool success;
+		if (DVDThread::IsReadPending())
+			success = DVDThread::FinishRead(current_read_command.output_address);
+		else
+			success = DVDRead(current_read_command.DVD_offset, current_read_command.output_address,
+			                  current_read_command.length, current_read_command.decrypt);
+
+		if (!success)
 		{
 			PanicAlertT("Can't read from DVD_Plugin - DVD-Interface: Fatal Error");
 		}
@@ -379,6 +389,7 @@ static u32 ProcessDTKSamples(short *tempPCM, u32 num_samples)
 
 		u8 tempADPCM[NGCADPCM::ONE_BLOCK_SIZE];
 		// TODO: What if we can't read from AudioPos?
+		DVDThread::WaitUntilIdle();
 		s_inserted_volume->Read(AudioPos, sizeof(tempADPCM), tempADPCM, false);
 		AudioPos += sizeof(tempADPCM);
 		NGCADPCM::DecodeBlock(tempPCM + samples_processed * 2, tempADPCM);
@@ -451,26 +462,32 @@ void Init()
 	dtk = CoreTiming::RegisterEvent("StreamingTimer", DTKStreamingCallback);
 
 	CoreTiming::ScheduleEvent(0, dtk);
+
+	DVDThread::Start();
 }
 
 void Shutdown()
 {
+	DVDThread::Stop();
 	s_inserted_volume.reset();
 }
 
 const DiscIO::IVolume& GetVolume()
 {
+	DVDThread::WaitUntilIdle();
 	return *s_inserted_volume;
 }
 
 bool SetVolumeName(const std::string& disc_path)
 {
+	DVDThread::Flush();
 	s_inserted_volume = std::unique_ptr<DiscIO::IVolume>(DiscIO::CreateVolumeFromFilename(disc_path));
 	return VolumeIsValid();
 }
 
 bool SetVolumeDirectory(const std::string& full_path, bool is_wii, const std::string& apploader_path, const std::string& DOL_path)
 {
+	DVDThread::Flush();
 	s_inserted_volume = std::unique_ptr<DiscIO::IVolume>(DiscIO::CreateVolumeFromDirectory(full_path, is_wii, apploader_path, DOL_path));
 	return VolumeIsValid();
 }
@@ -501,6 +518,7 @@ void EjectDiscCallback(u64 userdata, int cyclesLate)
 {
 	// Empty the drive
 	SetDiscInside(false);
+	DVDThread::Flush();
 	s_inserted_volume.reset();
 }
 
@@ -547,11 +565,15 @@ void SetLidOpen(bool _bOpen)
 
 bool DVDRead(u64 _iDVDOffset, u32 _iRamAddress, u32 _iLength, bool decrypt)
 {
-	return s_inserted_volume->Read(_iDVDOffset, _iLength, Memory::GetPointer(_iRamAddress), decrypt);
+	DVDThread::WaitUntilIdle();
+	u8* ptr = Memory::GetPointer(_iRamAddress);
+	Memory::PrepareHostWrite(ptr, _iLength);
+	return s_inserted_volume->Read(_iDVDOffset, _iLength, ptr, decrypt);
 }
 
 bool ChangePartition(u64 offset)
 {
+	DVDThread::Flush();
 	return s_inserted_volume->ChangePartition(offset);
 }
 
@@ -1309,6 +1331,9 @@ void ExecuteCommand(u32 command_0, u32 command_1, u32 command_2, u32 output_addr
 		read_command.callback_event_type = callback_event_type;
 		read_command.interrupt_type = interrupt_type;
 		current_read_command = read_command;
+		// The data is read in the background and copied to memory by
+		// FinishExecuteReadCommand.
+		DVDThread::StartRead(*s_inserted_volume, read_command.DVD_offset, read_command.length, read_command.decrypt);
 		CoreTiming::ScheduleEvent((int)ticks_until_completion, finish_execute_read_command);
 	}
 	else
@@ -0,0 +1,231 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Common/ChunkFile.h"
+#include "Common/CommonTypes.h"
+#include "Common/Thread.h"
+#include "Common/Logging/Log.h"
+
+#include "Core/HW/DVDThread.h"
+#include "Core/HW/Memmap.h"
+
+#include "DiscIO/Volume.h"
+
+namespace DVDThread
+{
+
+// Bounds for the size of a speculative read, which is the size of the read
+// that triggered it.
+static const u32 MIN_READ_AHEAD_SIZE = 0x8000;
+static const u32 MAX_READ_AHEAD_SIZE = 0x80000;
+
+struct ReadRequest
+{
+	const DiscIO::IVolume* volume;
+	u64 dvd_offset;
+	u32 length;
+	bool decrypt;
+};
+
+static std::thread s_thread;
+static std::mutex s_mutex;
+static std::condition_variable s_request_cv;
+static std::condition_variable s_done_cv;
+
+// Protected by s_mutex
+static bool s_quit = false;
+static bool s_request_queued = false;
+static bool s_busy = false;
+static bool s_result_ready = false;
+static ReadRequest s_request;
+static std::vector<u8> s_result;
+static bool s_result_success;
+
+// Only touched by the CPU thread
+static bool s_read_pending = false;
+
+// Only touched by the DVD thread, or by the CPU thread while it is idle
+static std::vector<u8> s_read_ahead;
+static u64 s_read_ahead_offset;
+static bool s_read_ahead_decrypt;
+static u64 s_next_sequential_offset = UINT64_MAX;
+
+static bool ReadFromVolume(const ReadRequest& request, std::vector<u8>* out)
+{
+	out->resize(request.length);
+
+	if (!s_read_ahead.empty() && request.decrypt == s_read_ahead_decrypt &&
+	    request.dvd_offset >= s_read_ahead_offset &&
+	    request.dvd_offset + request.length <= s_read_ahead_offset + s_read_ahead.size())
+	{
+		memcpy(out->data(), &s_read_ahead[request.dvd_offset - s_read_ahead_offset], request.length);
+		return true;
+	}
+
+	return request.volume->Read(request.dvd_offset, request.length, out->data(), request.decrypt);
+}
+
+static void ReadAhead(const ReadRequest& request)
+{
+	bool sequential = request.dvd_offset == s_next_sequential_offset;
+	u64 end = request.dvd_offset + request.length;
+	s_next_sequential_offset = end;
+
+	if (!sequential)
+		return;
+
+	// Still covered by the previous read-ahead
+	if (!s_read_ahead.empty() && request.decrypt == s_read_ahead_decrypt &&
+	    end >= s_read_ahead_offset && end + request.length <= s_read_ahead_offset + s_read_ahead.size())
+		return;
+
+	u32 size = std::min(std::max(request.length, MIN_READ_AHEAD_SIZE), MAX_READ_AHEAD_SIZE);
+	s_read_ahead.resize(size);
+	if (request.volume->Read(end, size, s_read_ahead.data(), request.decrypt))
+	{
+		s_read_ahead_offset = end;
+		s_read_ahead_decrypt = request.decrypt;
+	}
+	else
+	{
+		// Most likely past the end of the disc
+		s_read_ahead.clear();
+	}
+}
+
+static void DVDThread()
+{
+	Common::SetCurrentThreadName("DVD thread");
+
+	std::unique_lock<std::mutex> lk(s_mutex);
+	while (true)
+	{
+		s_request_cv.wait(lk, [] { return s_request_queued || s_quit; });
+		if (s_quit)
+			break;
+
+		ReadRequest request = s_request;
+		s_request_queued = false;
+		s_busy = true;
+
+		lk.unlock();
+		std::vector<u8> data;
+		bool success = ReadFromVolume(request, &data);
+		lk.lock();
+
+		s_result.swap(data);
+		s_result_success = success;
+		s_result_ready = true;
+		s_done_cv.notify_all();
+
+		lk.unlock();
+		ReadAhead(request);
+		lk.lock();
+
+		s_busy = false;
+		s_done_cv.notify_all();
+	}
+}
+
+void Start()
+{
+	s_quit = false;
+	s_request_queued = false;
+	s_busy = false;
+	s_result_ready = false;
+	s_read_pending = false;
+	s_read_ahead.clear();
+	s_next_sequential_offset = UINT64_MAX;
+	s_thread = std::thread(DVDThread);
+}
+
+void Stop()
+{
+	if (!s_thread.joinable())
+		return;
+
+	{
+		std::lock_guard<std::mutex> lk(s_mutex);
+		s_quit = true;
+		s_request_cv.notify_one();
+	}
+	s_thread.join();
+
+	s_result.clear();
+	s_read_ahead.clear();
+	s_read_pending = false;
+}
+
+void DoState(PointerWrap& p)
+{
+	// The data being read isn't part of the state; a read that is pending
+	// after loading is redone synchronously by DVDInterface.
+	if (p.GetMode() == PointerWrap::MODE_READ)
+	{
+		Flush();
+		std::lock_guard<std::mutex> lk(s_mutex);
+		s_result_ready = false;
+		s_read_pending = false;
+	}
+}
+
+void WaitUntilIdle()
+{
+	std::unique_lock<std::mutex> lk(s_mutex);
+	s_done_cv.wait(lk, [] { return !s_request_queued && !s_busy; });
+}
+
+void Flush()
+{
+	WaitUntilIdle();
+	s_read_ahead.clear();
+	s_next_sequential_offset = UINT64_MAX;
+}
+
+void StartRead(const DiscIO::IVolume& volume, u64 dvd_offset, u32 length, bool decrypt)
+{
+	_assert_msg_(DVDINTERFACE, !s_read_pending, "DVDThread: a read is already pending");
+
+	std::lock_guard<std::mutex> lk(s_mutex);
+	s_request.volume = &volume;
+	s_request.dvd_offset = dvd_offset;
+	s_request.length = length;
+	s_request.decrypt = decrypt;
+	s_request_queued = true;
+	s_result_ready = false;
+	s_read_pending = true;
+	s_request_cv.notify_one();
+}
+
+bool IsReadPending()
+{
+	return s_read_pending;
+}
+
+bool FinishRead(u32 output_address)
+{
+	std::unique_lock<std::mutex> lk(s_mutex);
+	s_done_cv.wait(lk, [] { return s_result_ready; });
+	s_result_ready = false;
+	s_read_pending = false;
+
+	if (!s_result_success)
+		return false;
+
+	u8* ptr = Memory::GetPointer(output_address);
+	if (!ptr)
+		return false;
+
+	memcpy(ptr, s_result.data(), s_result.size());
+	return true;
+}
+
+}
@@ -0,0 +1,41 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "Common/CommonTypes.h"
+
+class PointerWrap;
+namespace DiscIO { class IVolume; }
+
+// Performs the disc reads requested by DVDInterface on a separate thread, so
+// that slow blob formats don't stall the CPU thread. The data is only copied
+// to emulated memory by FinishRead, at the same point in emulated time as
+// before, so timing and determinism are unaffected.
+//
+// Sequential reads are followed by a speculative read of the data after them,
+// which the next read is served from if it hits.
+namespace DVDThread
+{
+
+void Start();
+void Stop();
+void DoState(PointerWrap& p);
+
+// Waits for the thread to stop touching the volume. Must be called before
+// anything else uses the volume.
+void WaitUntilIdle();
+// Like WaitUntilIdle, but also throws away read-ahead data. Must be called
+// when the volume or the partition changes.
+void Flush();
+
+void StartRead(const DiscIO::IVolume& volume, u64 dvd_offset, u32 length, bool decrypt);
+// False if there was no StartRead since the last FinishRead, or if a
+// savestate has been loaded since.
+bool IsReadPending();
+// Copies the data of the last StartRead to emulated memory, waiting for it if
+// necessary. Returns false if the read failed.
+bool FinishRead(u32 output_address);
+
+}
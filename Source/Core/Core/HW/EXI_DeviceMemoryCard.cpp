@@ -23,6 +23,7 @@
 #include "Core/HW/Sram.h"
 #include "Core/HW/SystemTimers.h"
 #include "DiscIO/NANDContentLoader.h"
+#include "DiscIO/VolumeCreator.h"
 
 #define MC_STATUS_BUSY              0x80
 #define MC_STATUS_UNLOCKED          0x40
@@ -202,6 +203,11 @@ void CEXIMemoryCard::SetupGciFolder(u16 sizeMb)
 	}
 	strDirectoryName += StringFromFormat("Card %c", 'A' + card_index);
 
+	// The host's folder, synced before the game started.
+	std::string netplay_directory = NetPlay_GetMemcardPath(card_index);
+	if (!netplay_directory.empty())
+		strDirectoryName = netplay_directory;
+
 	if (!File::Exists(strDirectoryName)) // first use of memcard folder, migrate automatically
 	{
 		MigrateFromMemcardFile(strDirectoryName + DIR_SEP, card_index);
@@ -227,6 +233,43 @@ void CEXIMemoryCard::SetupGciFolder(u16 sizeMb)
 													  country_code, CurrentGameId);
 }
 
+// Games that need a 251 block card get a file of their own.
+static void AddMC251Suffix(std::string& filename)
+{
+	filename.insert(filename.find_last_of("."), ".251");
+}
+
+std::string CEXIMemoryCard::GetRawMemcardPathForGame(int card_index, const std::string& game_path)
+{
+	std::string filename =
+		(card_index == 0) ? SConfig::GetInstance().m_strMemoryCardA : SConfig::GetInstance().m_strMemoryCardB;
+
+	std::unique_ptr<DiscIO::IVolume> volume(DiscIO::CreateVolumeFromFilename(game_path));
+	if (!volume)
+		return filename;
+
+	const char* region = SCoreStartupParameter::GetRegionOfCountry(volume->GetCountry());
+	if (region)
+		filename = SCoreStartupParameter::GetMemcardPathForRegion(filename, region, card_index == 0);
+
+	bool useMC251;
+	IniFile gameIni = SCoreStartupParameter::LoadGameIni(volume->GetUniqueID(), volume->GetRevision());
+	gameIni.GetOrCreateSection("Core")->Get("MemoryCard251", &useMC251, false);
+	if (useMC251)
+		AddMC251Suffix(filename);
+
+	return filename;
+}
+
+std::string CEXIMemoryCard::GetGciFolderPathForGame(int card_index, const std::string& game_path)
+{
+	std::unique_ptr<DiscIO::IVolume> volume(DiscIO::CreateVolumeFromFilename(game_path));
+	const char* region = volume ? SCoreStartupParameter::GetRegionOfCountry(volume->GetCountry()) : nullptr;
+
+	return File::GetUserPath(D_GCUSER_IDX) + (region ? region : EUR_DIR) + DIR_SEP +
+	       StringFromFormat("Card %c", 'A' + card_index);
+}
+
 void CEXIMemoryCard::SetupRawMemcard(u16 sizeMb)
 {
 	std::string filename =
@@ -237,8 +280,14 @@ void CEXIMemoryCard::SetupRawMemcard(u16 sizeMb)
 
 	if (sizeMb == MemCard251Mb)
 	{
-		filename.insert(filename.find_last_of("."), ".251");
+		AddMC251Suffix(filename);
 	}
+
+	// The host's card, synced before the game started.
+	std::string netplay_filename = NetPlay_GetMemcardPath(card_index);
+	if (!netplay_filename.empty())
+		filename = netplay_filename;
+
 	memorycard = std::make_unique<MemoryCard>(filename, card_index, sizeMb);
 }
 
@@ -6,6 +6,7 @@
 
 #include <functional>
 #include <memory>
+#include <string>
 
 #include "Core/HW/EXI_Device.h"
 
@@ -26,9 +27,16 @@ public:
 	void DMARead(u32 _uAddr, u32 _uSize) override;
 	void DMAWrite(u32 _uAddr, u32 _uSize) override;
 
+	// The raw card the game at game_path uses in the slot, as booting it sets
+	// up the path. For the netplay host, which syncs it before the game boots.
+	static std::string GetRawMemcardPathForGame(int card_index, const std::string& game_path);
+	// The same for the GCI folder the game uses in the slot.
+	static std::string GetGciFolderPathForGame(int card_index, const std::string& game_path);
+
 private:
 	void SetupGciFolder(u16 sizeMb);
 	void SetupRawMemcard(u16 sizeMb);
+	static std::string NetPlay_GetMemcardPath(int card_index);
 	static void EventCompleteFindInstance(u64 userdata, std::function<void(CEXIMemoryCard*)> callback);
 
 	// Scheduled when a command that required delayed end signaling is done.
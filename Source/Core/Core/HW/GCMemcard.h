@@ -316,7 +316,29 @@ public:
 	std::vector<GCMBlock> m_save_data;
 	std::vector<u16> m_used_blocks;
 	int UsesBlock(u16 blocknum);
+
+	void MarkBlockDirty(int index)
+	{
+		if (m_dirty_blocks.size() <= (size_t)index)
+			m_dirty_blocks.resize(index + 1);
+		if (!m_dirty_blocks[index])
+			++m_num_dirty_blocks;
+		m_dirty_blocks[index] = true;
+		m_dirty = true;
+	}
+	void ClearDirty()
+	{
+		m_dirty = false;
+		m_dirty_blocks.clear();
+		m_num_dirty_blocks = 0;
+	}
+
+	// Set when the save has to be written back, either because its header
+	// changed or because some of its blocks did.
 	bool m_dirty;
+	// Blocks of m_save_data whose contents changed since the last flush
+	std::vector<bool> m_dirty_blocks;
+	int m_num_dirty_blocks = 0;
 	std::string m_filename;
 };
 
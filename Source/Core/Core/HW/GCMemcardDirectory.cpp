@@ -138,11 +138,15 @@ GCMemcardDirectory::GCMemcardDirectory(const std::string& directory, int slot, u
 	: MemoryCardBase(slot, sizeMb)
 	, m_GameId(gameId)
 	, m_LastBlock(-1)
+	, m_LastSave(-1)
+	, m_LastSaveBlock(-1)
 	, m_hdr(slot, sizeMb, ascii)
 	, m_bat1(sizeMb)
 	, m_saves(0)
 	, m_SaveDirectory(directory)
 	, m_exiting(false)
+	, m_saves_flushed(0)
+	, m_bytes_flushed(0)
 {
 	// Use existing header data if available
 	if (File::Exists(m_SaveDirectory + MC_HDR))
@@ -353,7 +357,12 @@ s32 GCMemcardDirectory::Write(u32 destaddress, s32 length, u8 *srcaddress)
 		}
 	}
 
-	memcpy(m_LastBlockAddress + offset, srcaddress, length);
+	u8* dest = m_LastBlockAddress + offset;
+	// Games often rewrite whole saves with mostly unchanged data; only the
+	// blocks that really change make the save get written back.
+	if (block >= MC_FST_BLOCKS && memcmp(dest, srcaddress, length) != 0)
+		m_saves[m_LastSave].MarkBlockDirty(m_LastSaveBlock);
+	memcpy(dest, srcaddress, length);
 
 	l.unlock();
 	if (extra)
@@ -399,6 +408,7 @@ void GCMemcardDirectory::ClearBlock(u32 address)
 		m_LastBlock = SaveAreaRW(block, true);
 		if (m_LastBlock == -1)
 			return;
+		m_saves[m_LastSave].MarkBlockDirty(m_LastSaveBlock);
 	}
 	((GCMBlock *)m_LastBlockAddress)->Erase();
 }
@@ -487,13 +497,10 @@ inline s32 GCMemcardDirectory::SaveAreaRW(u32 block, bool writing)
 					}
 				}
 
-				if (writing)
-				{
-					m_saves[i].m_dirty = true;
-				}
-
 				m_LastBlock = block;
 				m_LastBlockAddress = m_saves[i].m_save_data[idx].block;
+				m_LastSave = i;
+				m_LastSaveBlock = idx;
 				return m_LastBlock;
 			}
 		}
@@ -554,76 +561,112 @@ bool GCMemcardDirectory::SetUsedBlocks(int saveIndex)
 
 void GCMemcardDirectory::FlushToFile()
 {
-	std::unique_lock<std::mutex> l(m_write_mutex);
-	int errors = 0;
-	DEntry invalid;
-	for (u16 i = 0; i < m_saves.size(); ++i)
+	struct PendingWrite
+	{
+		std::string filename;
+		std::vector<u8> contents;
+		int changed_blocks;
+	};
+	std::vector<PendingWrite> writes;
+	std::vector<std::string> deletions;
+
+	// Only copy the changed saves while holding the lock, so that the game
+	// doesn't have to wait for the disk.
 	{
-		if (m_saves[i].m_dirty)
+		std::unique_lock<std::mutex> l(m_write_mutex);
+		for (u16 i = 0; i < m_saves.size(); ++i)
 		{
-			if (BE32(m_saves[i].m_gci_header.Gamecode) != 0xFFFFFFFF)
+			if (m_saves[i].m_dirty)
 			{
-				m_saves[i].m_dirty = false;
-				if (m_saves[i].m_filename.empty())
+				if (BE32(m_saves[i].m_gci_header.Gamecode) != 0xFFFFFFFF)
 				{
-					std::string defaultSaveName = m_SaveDirectory + m_saves[i].m_gci_header.GCI_FileName();
-
-					// Check to see if another file is using the same name
-					// This seems unlikely except in the case of file corruption
-					// otherwise what user would name another file this way?
-					for (int j = 0; File::Exists(defaultSaveName) && j < 10; ++j)
+					if (m_saves[i].m_filename.empty())
 					{
-						defaultSaveName.insert(defaultSaveName.end() - 4, '0');
+						std::string defaultSaveName = m_SaveDirectory + m_saves[i].m_gci_header.GCI_FileName();
+
+						// Check to see if another file is using the same name
+						// This seems unlikely except in the case of file corruption
+						// otherwise what user would name another file this way?
+						for (int j = 0; File::Exists(defaultSaveName) && j < 10; ++j)
+						{
+							defaultSaveName.insert(defaultSaveName.end() - 4, '0');
+						}
+						if (File::Exists(defaultSaveName))
+							PanicAlertT("Failed to find new filename\n %s\n will be overwritten", defaultSaveName.c_str());
+						m_saves[i].m_filename = defaultSaveName;
 					}
-					if (File::Exists(defaultSaveName))
-						PanicAlertT("Failed to find new filename\n %s\n will be overwritten", defaultSaveName.c_str());
-					m_saves[i].m_filename = defaultSaveName;
+
+					PendingWrite write;
+					write.filename = m_saves[i].m_filename;
+					write.changed_blocks = m_saves[i].m_num_dirty_blocks;
+					size_t data_size = BLOCK_SIZE * m_saves[i].m_save_data.size();
+					write.contents.resize(DENTRY_SIZE + data_size);
+					memcpy(write.contents.data(), &m_saves[i].m_gci_header, DENTRY_SIZE);
+					memcpy(write.contents.data() + DENTRY_SIZE, m_saves[i].m_save_data.data(), data_size);
+					writes.push_back(std::move(write));
+					m_saves[i].ClearDirty();
 				}
-				File::IOFile GCI(m_saves[i].m_filename, "wb");
-				if (GCI)
+				else if (m_saves[i].m_filename.length() != 0)
 				{
-					GCI.WriteBytes(&m_saves[i].m_gci_header, DENTRY_SIZE);
-					GCI.WriteBytes(m_saves[i].m_save_data.data(), BLOCK_SIZE * m_saves[i].m_save_data.size());
-
-					if (GCI.IsGood())
-					{
-						Core::DisplayMessage(
-							StringFromFormat("Wrote save contents to %s", m_saves[i].m_filename.c_str()), 4000);
-					}
-					else
-					{
-						++errors;
-						Core::DisplayMessage(
-							StringFromFormat("Failed to write save contents to %s", m_saves[i].m_filename.c_str()),
-							4000);
-						ERROR_LOG(EXPANSIONINTERFACE, "Failed to save data to %s", m_saves[i].m_filename.c_str());
-					}
+					deletions.push_back(m_saves[i].m_filename);
+					m_saves[i].ClearDirty();
+					m_saves[i].m_filename.clear();
+					m_saves[i].m_save_data.clear();
+					m_saves[i].m_used_blocks.clear();
 				}
 			}
-			else if (m_saves[i].m_filename.length() != 0)
+
+			// Unload the save data for any game that is not running
+			// we could use !m_dirty, but some games have multiple gci files and may not write to them simultaneously
+			// this ensures that the save data for all of the current games gci files are stored in the savestate
+			u32 gamecode = BE32(m_saves[i].m_gci_header.Gamecode);
+			if (gamecode != m_GameId && gamecode != 0xFFFFFFFF && m_saves[i].m_save_data.size())
 			{
-				m_saves[i].m_dirty = false;
-				std::string &oldname = m_saves[i].m_filename;
-				std::string deletedname = oldname + ".deleted";
-				if (File::Exists(deletedname))
-					File::Delete(deletedname);
-				File::Rename(oldname, deletedname);
-				m_saves[i].m_filename.clear();
+				INFO_LOG(EXPANSIONINTERFACE, "Flushing savedata to disk for %s", m_saves[i].m_filename.c_str());
 				m_saves[i].m_save_data.clear();
-				m_saves[i].m_used_blocks.clear();
 			}
 		}
+	}
 
-		// Unload the save data for any game that is not running
-		// we could use !m_dirty, but some games have multiple gci files and may not write to them simultaneously
-		// this ensures that the save data for all of the current games gci files are stored in the savestate
-		u32 gamecode = BE32(m_saves[i].m_gci_header.Gamecode);
-		if (gamecode != m_GameId && gamecode != 0xFFFFFFFF && m_saves[i].m_save_data.size())
+	// Each save is written in one go to a temporary file that then replaces
+	// the old one, so a crash in the middle of a flush can't leave a torn save.
+	for (const PendingWrite& write : writes)
+	{
+		std::string temp_filename = File::GetTempFilenameForAtomicWrite(write.filename);
+		bool success;
 		{
-			INFO_LOG(EXPANSIONINTERFACE, "Flushing savedata to disk for %s", m_saves[i].m_filename.c_str());
-			m_saves[i].m_save_data.clear();
+			File::IOFile GCI(temp_filename, "wb");
+			success = GCI && GCI.WriteBytes(write.contents.data(), write.contents.size());
+		}
+		success = success && File::RenameSync(temp_filename, write.filename);
+
+		if (success)
+		{
+			++m_saves_flushed;
+			m_bytes_flushed += write.contents.size();
+			INFO_LOG(EXPANSIONINTERFACE, "Wrote %d changed blocks of %s (%u bytes, %" PRIu64 " bytes in total)",
+			         write.changed_blocks, write.filename.c_str(), (u32)write.contents.size(), (u64)m_bytes_flushed);
+			Core::DisplayMessage(
+				StringFromFormat("Wrote save contents to %s", write.filename.c_str()), 4000);
+		}
+		else
+		{
+			File::Delete(temp_filename);
+			Core::DisplayMessage(
+				StringFromFormat("Failed to write save contents to %s", write.filename.c_str()),
+				4000);
+			ERROR_LOG(EXPANSIONINTERFACE, "Failed to save data to %s", write.filename.c_str());
 		}
 	}
+
+	for (const std::string& oldname : deletions)
+	{
+		std::string deletedname = oldname + ".deleted";
+		if (File::Exists(deletedname))
+			File::Delete(deletedname);
+		File::Rename(oldname, deletedname);
+	}
+
 #if _WRITE_MC_HEADER
 	u8 mc[BLOCK_SIZE * MC_FST_BLOCKS];
 	Read(0, BLOCK_SIZE * MC_FST_BLOCKS, mc);
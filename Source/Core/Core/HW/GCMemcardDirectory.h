@@ -33,6 +33,10 @@ public:
 	void ClearAll() override {}
 	void DoState(PointerWrap &p) override;
 
+	// Totals since the card was created, for keeping an eye on memory card I/O.
+	u32 GetSavesFlushed() const { return m_saves_flushed; }
+	u64 GetBytesFlushed() const { return m_bytes_flushed; }
+
 private:
 	int LoadGCI(const std::string& fileName, DiscIO::IVolume::ECountry card_region, bool currentGameOnly);
 	inline s32 SaveAreaRW(u32 block, bool writing = false);
@@ -44,6 +48,10 @@ private:
 	u32 m_GameId;
 	s32 m_LastBlock;
 	u8 *m_LastBlockAddress;
+	// The save and the index of its block m_LastBlockAddress points to, when
+	// m_LastBlock is in the save area.
+	int m_LastSave;
+	int m_LastSaveBlock;
 
 	Header m_hdr;
 	Directory m_dir1, m_dir2;
@@ -56,5 +64,7 @@ private:
 	Common::Event m_flush_trigger;
 	std::mutex m_write_mutex;
 	std::atomic<bool> m_exiting;
+	std::atomic<u32> m_saves_flushed;
+	std::atomic<u64> m_bytes_flushed;
 	std::thread m_flush_thread;
 };
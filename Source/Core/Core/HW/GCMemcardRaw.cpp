@@ -2,6 +2,7 @@
 // Licensed under GPLv2
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <chrono>
 #include "Common/ChunkFile.h"
 #include "Common/FileUtil.h"
@@ -18,6 +19,9 @@
 MemoryCard::MemoryCard(std::string filename, int _card_index, u16 sizeMb)
 	: MemoryCardBase(_card_index, sizeMb)
 	, m_filename(filename)
+	, m_memcard_data(nullptr)
+	, m_dirty_start(0)
+	, m_dirty_end(0)
 {
 	File::IOFile pFile(m_filename, "rb");
 	if (pFile)
@@ -25,11 +29,27 @@ MemoryCard::MemoryCard(std::string filename, int _card_index, u16 sizeMb)
 		// Measure size of the existing memcard file.
 		memory_card_size = (u32)pFile.GetSize();
 		nintendo_card_id = memory_card_size / SIZE_TO_Mb;
-		m_memcard_data = std::make_unique<u8[]>(memory_card_size);
-		memset(&m_memcard_data[0], 0xFF, memory_card_size);
+		pFile.Close();
 
-		INFO_LOG(EXPANSIONINTERFACE, "Reading memory card %s", m_filename.c_str());
-		pFile.ReadBytes(&m_memcard_data[0], memory_card_size);
+		// A mapped card is written to the file as the game writes to it, so
+		// it's only used when the changes are going to be saved anyway.
+		if (SConfig::GetInstance().m_MapMemcards &&
+		    SConfig::GetInstance().m_LocalCoreStartupParameter.bEnableMemcardSaving &&
+		    memory_card_size != 0 && m_mapped_file.Open(m_filename, true))
+		{
+			INFO_LOG(EXPANSIONINTERFACE, "Mapping memory card %s", m_filename.c_str());
+			m_memcard_data = m_mapped_file.GetData();
+		}
+		else
+		{
+			m_memcard_buffer = std::make_unique<u8[]>(memory_card_size);
+			m_memcard_data = &m_memcard_buffer[0];
+			memset(&m_memcard_data[0], 0xFF, memory_card_size);
+
+			INFO_LOG(EXPANSIONINTERFACE, "Reading memory card %s", m_filename.c_str());
+			pFile.Open(m_filename, "rb");
+			pFile.ReadBytes(&m_memcard_data[0], memory_card_size);
+		}
 	}
 	else
 	{
@@ -37,7 +57,8 @@ MemoryCard::MemoryCard(std::string filename, int _card_index, u16 sizeMb)
 		nintendo_card_id = sizeMb;
 		memory_card_size = sizeMb * SIZE_TO_Mb;
 
-		m_memcard_data = std::make_unique<u8[]>(memory_card_size);
+		m_memcard_buffer = std::make_unique<u8[]>(memory_card_size);
+		m_memcard_data = &m_memcard_buffer[0];
 		// Fills in MC_HDR_SIZE bytes
 		GCMemcard::Format(&m_memcard_data[0], m_filename.find(".JAP.raw") != std::string::npos, sizeMb);
 		memset(&m_memcard_data[MC_HDR_SIZE], 0xFF, memory_card_size - MC_HDR_SIZE);
@@ -47,7 +68,8 @@ MemoryCard::MemoryCard(std::string filename, int _card_index, u16 sizeMb)
 
 	// Class members (including inherited ones) have now been initialized, so
 	// it's safe to startup the flush thread (which reads them).
-	m_flush_buffer = std::make_unique<u8[]>(memory_card_size);
+	if (!m_mapped_file.IsOpen())
+		m_flush_buffer = std::make_unique<u8[]>(memory_card_size);
 	m_flush_thread = std::thread(&MemoryCard::FlushThread, this);
 }
 
@@ -61,6 +83,52 @@ MemoryCard::~MemoryCard()
 	}
 }
 
+// Writes [start, end) of the card back to the file. A mapped card only has
+// to tell the OS to write the pages back; otherwise just the range is copied
+// and written.
+bool MemoryCard::FlushRange(u32 start, u32 end)
+{
+	if (m_mapped_file.IsOpen())
+		return m_mapped_file.Flush(start, end - start);
+
+	// Opening the file is purposefully done each iteration to ensure the
+	// file doesn't disappear out from under us after the first check.
+	File::IOFile pFile(m_filename, "r+b");
+
+	if (!pFile || pFile.GetSize() != memory_card_size)
+	{
+		std::string dir;
+		SplitPath(m_filename, &dir, nullptr, nullptr);
+		if (!File::IsDirectory(dir))
+		{
+			File::CreateFullPath(dir);
+		}
+		pFile.Open(m_filename, "wb");
+		// The file has to be written completely.
+		start = 0;
+		end = memory_card_size;
+	}
+
+	// Note - pFile may have changed above, after ctor
+	if (!pFile)
+	{
+		PanicAlertT(
+			"Could not write memory card file %s.\n\n"
+			"Are you running Dolphin from a CD/DVD, or is the save file maybe write protected?\n\n"
+			"Are you receiving this after moving the emulator directory?\nIf so, then you may "
+			"need to re-specify your memory card location in the options.",
+			m_filename.c_str());
+		return false;
+	}
+
+	{
+		std::unique_lock<std::mutex> l(m_flush_mutex);
+		memcpy(&m_flush_buffer[start], &m_memcard_data[start], end - start);
+	}
+	pFile.Seek(start, SEEK_SET);
+	return pFile.WriteBytes(&m_flush_buffer[start], end - start);
+}
+
 void MemoryCard::FlushThread()
 {
 	if (!SConfig::GetInstance().m_LocalCoreStartupParameter.bEnableMemcardSaving)
@@ -71,58 +139,43 @@ void MemoryCard::FlushThread()
 	Common::SetCurrentThreadName(
 		StringFromFormat("Memcard%x-Flush", card_index).c_str());
 
+	// Flush once the game has stopped writing for a moment, as saving
+	// usually consists of many writes in quick succession, but don't hold
+	// back changes for longer than flush_interval.
+	const auto quiet_time = std::chrono::seconds(1);
 	const auto flush_interval = std::chrono::seconds(15);
 
 	while (true)
 	{
 		// If triggered, we're exiting.
 		// If timed out, check if we need to flush.
-		bool do_exit = m_flush_trigger.WaitFor(flush_interval);
-		if (!do_exit)
+		bool do_exit = m_flush_trigger.WaitFor(quiet_time);
+
+		u32 start, end;
 		{
-			bool is_dirty = m_dirty.TestAndClear();
-			if (!is_dirty)
+			std::unique_lock<std::mutex> l(m_flush_mutex);
+			auto now = std::chrono::steady_clock::now();
+			bool flush = m_dirty_start != m_dirty_end &&
+			             (do_exit || now - m_last_write >= quiet_time || now - m_first_write >= flush_interval);
+			if (!flush)
 			{
+				if (do_exit)
+					return;
 				continue;
 			}
-		}
-
-		// Opening the file is purposefully done each iteration to ensure the
-		// file doesn't disappear out from under us after the first check.
-		File::IOFile pFile(m_filename, "r+b");
 
-		if (!pFile)
-		{
-			std::string dir;
-			SplitPath(m_filename, &dir, nullptr, nullptr);
-			if (!File::IsDirectory(dir))
-			{
-				File::CreateFullPath(dir);
-			}
-			pFile.Open(m_filename, "wb");
+			start = m_dirty_start;
+			end = m_dirty_end;
+			m_dirty_start = m_dirty_end = 0;
 		}
 
-		// Note - pFile may have changed above, after ctor
-		if (!pFile)
+		if (!FlushRange(start, end))
 		{
-			PanicAlertT(
-				"Could not write memory card file %s.\n\n"
-				"Are you running Dolphin from a CD/DVD, or is the save file maybe write protected?\n\n"
-				"Are you receiving this after moving the emulator directory?\nIf so, then you may "
-				"need to re-specify your memory card location in the options.",
-				m_filename.c_str());
-
 			// Exit the flushing thread - further flushes will be ignored unless
 			// the thread is recreated.
 			return;
 		}
 
-		{
-			std::unique_lock<std::mutex> l(m_flush_mutex);
-			memcpy(&m_flush_buffer[0], &m_memcard_data[0], memory_card_size);
-		}
-		pFile.WriteBytes(&m_flush_buffer[0], memory_card_size);
-
 		if (!do_exit)
 		{
 			Core::DisplayMessage(
@@ -137,9 +190,21 @@ void MemoryCard::FlushThread()
 	}
 }
 
-void MemoryCard::MakeDirty()
+void MemoryCard::MakeDirty(u32 address, u32 length)
 {
-	m_dirty.Set();
+	auto now = std::chrono::steady_clock::now();
+	if (m_dirty_start == m_dirty_end)
+	{
+		m_dirty_start = address;
+		m_dirty_end = address + length;
+		m_first_write = now;
+	}
+	else
+	{
+		m_dirty_start = std::min(m_dirty_start, address);
+		m_dirty_end = std::max(m_dirty_end, address + length);
+	}
+	m_last_write = now;
 }
 
 s32 MemoryCard::Read(u32 srcaddress, s32 length, u8 *destaddress)
@@ -167,8 +232,8 @@ s32 MemoryCard::Write(u32 destaddress, s32 length, u8 *srcaddress)
 	{
 		std::unique_lock<std::mutex> l(m_flush_mutex);
 		memcpy(&m_memcard_data[destaddress], srcaddress, length);
+		MakeDirty(destaddress, length);
 	}
-	MakeDirty();
 	return length;
 }
 
@@ -184,22 +249,23 @@ void MemoryCard::ClearBlock(u32 address)
 	{
 		std::unique_lock<std::mutex> l(m_flush_mutex);
 		memset(&m_memcard_data[address], 0xFF, BLOCK_SIZE);
+		MakeDirty(address, BLOCK_SIZE);
 	}
-	MakeDirty();
 }
 
 void MemoryCard::ClearAll()
 {
-	{
-		std::unique_lock<std::mutex> l(m_flush_mutex);
-		memset(&m_memcard_data[0], 0xFF, memory_card_size);
-	}
-	MakeDirty();
+	std::unique_lock<std::mutex> l(m_flush_mutex);
+	memset(&m_memcard_data[0], 0xFF, memory_card_size);
+	MakeDirty(0, memory_card_size);
 }
 
 void MemoryCard::DoState(PointerWrap &p)
 {
 	p.Do(card_index);
 	p.Do(memory_card_size);
+	std::unique_lock<std::mutex> l(m_flush_mutex);
 	p.DoArray(&m_memcard_data[0], memory_card_size);
+	if (p.GetMode() == PointerWrap::MODE_READ)
+		MakeDirty(0, memory_card_size);
 }
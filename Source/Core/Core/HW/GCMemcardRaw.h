@@ -4,12 +4,13 @@
 
 #pragma once
 
+#include <chrono>
 #include <memory>
 #include <mutex>
 #include <string>
 #include <thread>
 #include "Common/Event.h"
-#include "Common/Flag.h"
+#include "Common/MappedFile.h"
 #include "Core/HW/GCMemcard.h"
 
 class PointerWrap;
@@ -20,7 +21,6 @@ public:
 	MemoryCard(std::string filename, int _card_index, u16 sizeMb = MemCard2043Mb);
 	~MemoryCard();
 	void FlushThread();
-	void MakeDirty();
 
 	s32 Read(u32 address, s32 length, u8 *destaddress) override;
 	s32 Write(u32 destaddress, s32 length, u8 *srcaddress) override;
@@ -29,11 +29,24 @@ public:
 	void DoState(PointerWrap &p) override;
 
 private:
+	// Must be called with m_flush_mutex held.
+	void MakeDirty(u32 address, u32 length);
+	bool FlushRange(u32 start, u32 end);
+
 	std::string m_filename;
-	std::unique_ptr<u8[]> m_memcard_data;
+	// Either m_memcard_buffer or the mapping of the file
+	u8* m_memcard_data;
+	std::unique_ptr<u8[]> m_memcard_buffer;
+	MappedFile m_mapped_file;
 	std::unique_ptr<u8[]> m_flush_buffer;
 	std::thread m_flush_thread;
-	std::mutex m_flush_mutex;
 	Common::Event m_flush_trigger;
-	Common::Flag m_dirty;
+
+	// Protected by m_flush_mutex. The dirty range is empty when the card is
+	// in sync with the file.
+	std::mutex m_flush_mutex;
+	u32 m_dirty_start;
+	u32 m_dirty_end;
+	std::chrono::steady_clock::time_point m_first_write;
+	std::chrono::steady_clock::time_point m_last_write;
 };
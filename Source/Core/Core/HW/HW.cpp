@@ -57,6 +57,9 @@ namespace HW
 
 	void Shutdown()
 	{
+		// A save in progress still has to copy guest memory.
+		State::Flush();
+
 		SystemTimers::Shutdown();
 		CCPU::Shutdown();
 		ExpansionInterface::Shutdown();
@@ -8,10 +8,16 @@
 // However, if a JITed instruction (for example lwz) wants to access a bad memory area that call
 // may be redirected here (for example to Read_U32()).
 
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+
 #include "Common/ChunkFile.h"
 #include "Common/CommonTypes.h"
 #include "Common/MemArena.h"
 #include "Common/MemoryUtil.h"
+#include "Common/Thread.h"
 
 #include "Core/ConfigManager.h"
 #include "Core/Core.h"
@@ -30,6 +36,7 @@
 #include "Core/HW/SI.h"
 #include "Core/HW/VideoInterface.h"
 #include "Core/HW/WII_IPC.h"
+#include "Core/MemTools.h"
 #include "Core/PowerPC/PowerPC.h"
 #include "Core/PowerPC/JitCommon/JitBase.h"
 
@@ -165,6 +172,235 @@ static MemoryView views[] =
 };
 static const int num_views = sizeof(views) / sizeof(MemoryView);
 
+// Copy-on-write snapshots.
+//
+// Each region (RAM, L1 cache, fake VMEM, EXRAM) is split in chunks, which are
+// write-protected in every view of the region when the snapshot is taken.
+// A chunk is claimed exactly once, either by the fault handler when something
+// writes to it (its contents are then copied aside) or by FinishSnapshot
+// (which copies it straight to the state buffer). Chunks are large so that
+// unprotecting them one at a time doesn't fragment the mappings too much.
+enum
+{
+	SNAPSHOT_CHUNK_SIZE = 0x10000,
+	MAX_SNAPSHOT_REGIONS = 4,
+	MAX_REGION_MIRRORS = 4,
+};
+
+enum ChunkState : u8
+{
+	CHUNK_PROTECTED, // unchanged since the snapshot, still write-protected
+	CHUNK_COPYING,   // being claimed by some thread
+	CHUNK_COPIED,    // contents at snapshot time are in SnapshotRegion::copy
+	CHUNK_RELEASED,  // not part of a snapshot (anymore)
+};
+
+struct SnapshotRegion
+{
+	u8* mirrors[MAX_REGION_MIRRORS];
+	int num_mirrors;
+	u32 size;
+	u8* copy;
+	std::unique_ptr<std::atomic<u8>[]> chunks;
+	size_t state_offset;
+	bool deferred;
+};
+
+static SnapshotRegion s_snapshot_regions[MAX_SNAPSHOT_REGIONS];
+static int s_num_snapshot_regions = 0;
+static bool s_snapshot_on_save = false;
+static std::atomic<bool> s_snapshot_active(false);
+// Held while a snapshot is being filled in, so that the next one can't start
+// and Shutdown doesn't unmap memory under the save thread.
+static std::mutex s_snapshot_mutex;
+
+static void SetupSnapshotRegions()
+{
+	s_num_snapshot_regions = 0;
+	for (const MemoryView& view : views)
+	{
+		if (!view.out_ptr || !view.mapped_ptr)
+			continue;
+
+		SnapshotRegion& region = s_snapshot_regions[s_num_snapshot_regions++];
+		region.num_mirrors = 0;
+		for (const MemoryView& mirror : views)
+		{
+			if (mirror.mapped_ptr && mirror.shm_position == view.shm_position)
+				region.mirrors[region.num_mirrors++] = (u8*)mirror.mapped_ptr;
+		}
+		region.size = view.size;
+		region.copy = nullptr;
+		region.chunks.reset(new std::atomic<u8>[view.size / SNAPSHOT_CHUNK_SIZE]);
+		for (u32 i = 0; i < view.size / SNAPSHOT_CHUNK_SIZE; ++i)
+			region.chunks[i].store(CHUNK_RELEASED);
+		region.deferred = false;
+	}
+}
+
+static void ShutdownSnapshotRegions()
+{
+	for (int i = 0; i < s_num_snapshot_regions; ++i)
+	{
+		if (s_snapshot_regions[i].copy)
+			FreeMemoryPages(s_snapshot_regions[i].copy, s_snapshot_regions[i].size);
+		s_snapshot_regions[i].chunks.reset();
+	}
+	s_num_snapshot_regions = 0;
+}
+
+static void UnprotectChunk(SnapshotRegion& region, u32 offset)
+{
+	for (int i = 0; i < region.num_mirrors; ++i)
+		UnWriteProtectMemory(region.mirrors[i] + offset, SNAPSHOT_CHUNK_SIZE);
+}
+
+// Returns true if the chunk was claimed by this call, false if another
+// thread had already claimed it (in which case it has been copied aside).
+static bool ClaimChunk(SnapshotRegion& region, u32 chunk, u8* dest)
+{
+	std::atomic<u8>& state = region.chunks[chunk];
+	u8 expected = CHUNK_PROTECTED;
+	if (!state.compare_exchange_strong(expected, CHUNK_COPYING))
+	{
+		while (state.load() == CHUNK_COPYING)
+			Common::YieldCPU();
+		return false;
+	}
+
+	u32 offset = chunk * SNAPSHOT_CHUNK_SIZE;
+	if (dest)
+		memcpy(dest, region.mirrors[0] + offset, SNAPSHOT_CHUNK_SIZE);
+	UnprotectChunk(region, offset);
+	return true;
+}
+
+static void BeginSnapshot()
+{
+	for (int i = 0; i < s_num_snapshot_regions; ++i)
+	{
+		SnapshotRegion& region = s_snapshot_regions[i];
+		// Allocated on first use; only chunks written to during a save are
+		// ever touched.
+		if (!region.copy)
+			region.copy = (u8*)AllocateMemoryPages(region.size);
+		region.deferred = false;
+		for (u32 c = 0; c < region.size / SNAPSHOT_CHUNK_SIZE; ++c)
+			region.chunks[c].store(CHUNK_PROTECTED);
+		for (int m = 0; m < region.num_mirrors; ++m)
+			WriteProtectMemory(region.mirrors[m], region.size);
+	}
+	s_snapshot_active.store(true);
+}
+
+void SetSnapshotOnSave(bool enable)
+{
+	s_snapshot_on_save = enable;
+}
+
+bool IsSnapshotPending()
+{
+	return s_snapshot_active.load();
+}
+
+void FinishSnapshot(u8* state)
+{
+	std::lock_guard<std::mutex> lk(s_snapshot_mutex);
+	if (!s_snapshot_active.load())
+		return;
+
+	for (int i = 0; i < s_num_snapshot_regions; ++i)
+	{
+		SnapshotRegion& region = s_snapshot_regions[i];
+		u8* dest = (state && region.deferred) ? state + region.state_offset : nullptr;
+		for (u32 c = 0; c < region.size / SNAPSHOT_CHUNK_SIZE; ++c)
+		{
+			u32 offset = c * SNAPSHOT_CHUNK_SIZE;
+			if (!ClaimChunk(region, c, dest ? dest + offset : nullptr) && dest)
+				memcpy(dest + offset, region.copy + offset, SNAPSHOT_CHUNK_SIZE);
+			region.chunks[c].store(CHUNK_RELEASED);
+		}
+		region.deferred = false;
+	}
+
+	s_snapshot_active.store(false);
+}
+
+// Copies a chunk aside before it's written to and makes it writable.
+static void CopyChunkAside(SnapshotRegion& region, u32 chunk)
+{
+	// The chunk may have been released in the meantime.
+	if (region.chunks[chunk].load() == CHUNK_RELEASED)
+		return;
+
+	u32 offset = chunk * SNAPSHOT_CHUNK_SIZE;
+	if (ClaimChunk(region, chunk, region.copy + offset))
+		region.chunks[chunk].store(CHUNK_COPIED);
+}
+
+// Finds the region the host address is in, in any of its mirrors.
+static SnapshotRegion* FindSnapshotRegion(uintptr_t address, u32* offset)
+{
+	for (int i = 0; i < s_num_snapshot_regions; ++i)
+	{
+		SnapshotRegion& region = s_snapshot_regions[i];
+		for (int m = 0; m < region.num_mirrors; ++m)
+		{
+			uintptr_t base = (uintptr_t)region.mirrors[m];
+			if (address >= base && address < base + region.size)
+			{
+				*offset = (u32)(address - base);
+				return &region;
+			}
+		}
+	}
+	return nullptr;
+}
+
+bool HandleSnapshotFault(uintptr_t address)
+{
+	u32 offset;
+	SnapshotRegion* region = FindSnapshotRegion(address, &offset);
+	if (!region)
+		return false;
+
+	CopyChunkAside(*region, offset / SNAPSHOT_CHUNK_SIZE);
+	return true;
+}
+
+void PrepareHostWrite(const u8* ptr, size_t size)
+{
+	if (!s_snapshot_active.load() || !ptr || !size)
+		return;
+
+	u32 offset;
+	SnapshotRegion* region = FindSnapshotRegion((uintptr_t)ptr, &offset);
+	if (!region)
+		return;
+
+	u32 last = (u32)std::min<u64>((u64)offset + size, region->size) - 1;
+	for (u32 chunk = offset / SNAPSHOT_CHUNK_SIZE; chunk <= last / SNAPSHOT_CHUNK_SIZE; ++chunk)
+		CopyChunkAside(*region, chunk);
+}
+
+static void DoRegion(PointerWrap& p, u8* data, u32 size, bool defer)
+{
+	if (defer)
+	{
+		for (int i = 0; i < s_num_snapshot_regions; ++i)
+		{
+			SnapshotRegion& region = s_snapshot_regions[i];
+			if (region.mirrors[0] == data && region.size == size)
+			{
+				region.state_offset = p.DoDeferred(size);
+				region.deferred = true;
+				return;
+			}
+		}
+	}
+	p.DoArray(data, size);
+}
+
 void Init()
 {
 	bool wii = SConfig::GetInstance().m_LocalCoreStartupParameter.bWii;
@@ -184,6 +420,8 @@ void Init()
 	logical_base = physical_base + 0x200000000;
 #endif
 
+	SetupSnapshotRegions();
+
 	mmio_mapping = new MMIO::Mapping();
 
 	if (wii)
@@ -198,19 +436,33 @@ void Init()
 void DoState(PointerWrap &p)
 {
 	bool wii = SConfig::GetInstance().m_LocalCoreStartupParameter.bWii;
-	p.DoArray(m_pRAM, RAM_SIZE);
-	p.DoArray(m_pL1Cache, L1_CACHE_SIZE);
+
+	bool snapshot = s_snapshot_on_save && p.IsGrowableWriter() && EMM::IsProcessWideHandlerInstalled();
+	if (snapshot)
+	{
+		// Waits for the previous snapshot to be written out.
+		std::lock_guard<std::mutex> lk(s_snapshot_mutex);
+		BeginSnapshot();
+	}
+
+	DoRegion(p, m_pRAM, RAM_SIZE, snapshot);
+	DoRegion(p, m_pL1Cache, L1_CACHE_SIZE, snapshot);
 	p.DoMarker("Memory RAM");
 	if (bFakeVMEM)
-		p.DoArray(m_pFakeVMEM, FAKEVMEM_SIZE);
+		DoRegion(p, m_pFakeVMEM, FAKEVMEM_SIZE, snapshot);
 	p.DoMarker("Memory FakeVMEM");
 	if (wii)
-		p.DoArray(m_pEXRAM, EXRAM_SIZE);
+		DoRegion(p, m_pEXRAM, EXRAM_SIZE, snapshot);
 	p.DoMarker("Memory EXRAM");
 }
 
 void Shutdown()
 {
+	// The save thread has been flushed by now, so this only ends a snapshot
+	// whose save was aborted.
+	FinishSnapshot(nullptr);
+	ShutdownSnapshotRegions();
+
 	m_IsInitialized = false;
 	u32 flags = 0;
 	if (SConfig::GetInstance().m_LocalCoreStartupParameter.bWii) flags |= MV_WII_ONLY;
@@ -74,6 +74,25 @@ void DoState(PointerWrap &p);
 void Clear();
 bool AreMemoryBreakpointsActivated();
 
+// Copy-on-write snapshots of guest memory for savestates. While enabled, a
+// DoState with a growable writer write-protects guest memory and leaves holes
+// for it in the state buffer instead of copying it. The emulator can then be
+// resumed right away: chunks written to before FinishSnapshot() gets to them
+// are copied aside by the fault handler. Only supported when the exception
+// handler catches faults from all threads.
+void SetSnapshotOnSave(bool enable);
+bool IsSnapshotPending();
+// Fills the holes in <state> (the start of the state buffer) from any thread
+// and ends the snapshot. Passing nullptr just ends it.
+void FinishSnapshot(u8* state);
+// Called by the exception handler. Returns true if the fault was a write to
+// snapshotted memory, in which case the access can be retried.
+bool HandleSnapshotFault(uintptr_t address);
+// Host code writing to guest memory through a syscall (read(), recv(), ...)
+// has to call this first: the kernel fails such writes to write-protected
+// memory with EFAULT instead of raising a fault.
+void PrepareHostWrite(const u8* ptr, size_t size);
+
 // Routines to access physically addressed memory, designed for use by
 // emulated hardware outside the CPU. Use "Device_" prefix.
 std::string GetString(u32 em_address, size_t size = 0);
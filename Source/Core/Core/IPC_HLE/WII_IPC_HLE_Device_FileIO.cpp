@@ -3,6 +3,19 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <vector>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
 
 #include "Common/ChunkFile.h"
 #include "Common/CommonTypes.h"
@@ -12,10 +25,169 @@
 
 #include "Core/IPC_HLE/WII_IPC_HLE_Device_FileIO.h"
 #include "Core/IPC_HLE/WII_IPC_HLE_Device_fs.h"
+#include "Core/NetPlayProto.h"
 
 
 static Common::replace_v replacements;
 
+// Reads smaller than this are served from a buffer of this size read from
+// where they start. Saves are mostly loaded with many small sequential reads.
+static const u32 READ_AHEAD_SIZE = 0x4000;
+
+struct CWII_IPC_HLE_Device_FileIO::HostFile
+{
+	File::IOFile file;
+	// Only opened for writing once an fd that can write uses it.
+	bool writable = false;
+	std::vector<u8> read_ahead;
+	u64 read_ahead_offset = 0;
+};
+
+// Opens an existing host file for a HostFile, for reading and writing or for
+// reading only.
+static bool OpenHostFile(File::IOFile& file, const std::string& path, bool writable)
+{
+#ifdef _WIN32
+	// fopen doesn't let other handles to the file be opened for writing, nor
+	// the file be deleted or renamed, while it is open. The handle is held for
+	// as long as any fd uses the file, and /dev/fs deletes and renames files
+	// that games still have open.
+	HANDLE handle = CreateFile(UTF8ToTStr(path).c_str(), writable ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ,
+		FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (handle == INVALID_HANDLE_VALUE)
+		return false;
+
+	int fd = _open_osfhandle((intptr_t)handle, writable ? 0 : _O_RDONLY);
+	if (fd == -1)
+	{
+		CloseHandle(handle);
+		return false;
+	}
+
+	std::FILE* f = _fdopen(fd, writable ? "r+b" : "rb");
+	if (!f)
+	{
+		_close(fd);
+		return false;
+	}
+
+	File::IOFile opened(f);
+	file.Swap(opened);
+	return true;
+#else
+	return file.Open(path, writable ? "r+b" : "rb");
+#endif
+}
+
+// Open host files by host path. An entry goes away when the last fd using
+// the file is closed.
+static std::map<std::string, std::weak_ptr<CWII_IPC_HLE_Device_FileIO::HostFile>> s_host_files;
+
+// Returns the number of bytes read, which is less than size at the end of the
+// file, or -1 on error. Reads straight into the destination instead of going
+// through the stdio buffer where that is possible.
+static s64 ReadAt(File::IOFile& file, u8* data, u32 size, u64 offset)
+{
+#ifdef _WIN32
+	if (!file.Seek(offset, SEEK_SET))
+	{
+		file.Clear();
+		return -1;
+	}
+	size_t read = fread(data, 1, size, file.GetHandle());
+	if (read != size && ferror(file.GetHandle()))
+	{
+		file.Clear();
+		return -1;
+	}
+	return read;
+#else
+	int fd = fileno(file.GetHandle());
+	u32 read = 0;
+	while (read < size)
+	{
+		ssize_t result = pread(fd, data + read, size - read, offset + read);
+		if (result < 0)
+			return -1;
+		if (result == 0)
+			break;
+		read += (u32)result;
+	}
+	return read;
+#endif
+}
+
+static bool WriteAt(File::IOFile& file, const u8* data, u32 size, u64 offset)
+{
+#ifdef _WIN32
+	if (!file.Seek(offset, SEEK_SET) || !file.WriteBytes(data, size))
+	{
+		file.Clear();
+		return false;
+	}
+	return true;
+#else
+	int fd = fileno(file.GetHandle());
+	u32 written = 0;
+	while (written < size)
+	{
+		ssize_t result = pwrite(fd, data + written, size - written, offset + written);
+		if (result <= 0)
+			return false;
+		written += (u32)result;
+	}
+	return true;
+#endif
+}
+
+static u64 GetHostFileSize(File::IOFile& file)
+{
+#ifdef _WIN32
+	return file.GetSize();
+#else
+	// Doesn't seek the FILE like IOFile::GetSize.
+	return File::GetSize(fileno(file.GetHandle()));
+#endif
+}
+
+static s64 ReadCached(CWII_IPC_HLE_Device_FileIO::HostFile& host, u8* data, u32 size, u64 offset)
+{
+	if (size >= READ_AHEAD_SIZE)
+		return ReadAt(host.file, data, size, offset);
+
+	if (offset < host.read_ahead_offset || offset + size > host.read_ahead_offset + host.read_ahead.size())
+	{
+		host.read_ahead.resize(READ_AHEAD_SIZE);
+		s64 read = ReadAt(host.file, host.read_ahead.data(), READ_AHEAD_SIZE, offset);
+		if (read < 0)
+		{
+			host.read_ahead.clear();
+			return -1;
+		}
+		host.read_ahead.resize((size_t)read);
+		host.read_ahead_offset = offset;
+	}
+
+	u32 read = (u32)std::min<u64>(size, host.read_ahead_offset + host.read_ahead.size() - offset);
+	if (read == 0)
+		return 0;
+	memcpy(data, &host.read_ahead[offset - host.read_ahead_offset], read);
+	return read;
+}
+
+void HLE_IPC_ForgetHostFiles(const std::string& host_path)
+{
+	// Fds that are still open keep using the file they opened.
+	const std::string dir_prefix = host_path + "/";
+	for (auto it = s_host_files.begin(); it != s_host_files.end();)
+	{
+		if (it->first == host_path || it->first.compare(0, dir_prefix.size(), dir_prefix) == 0)
+			it = s_host_files.erase(it);
+		else
+			++it;
+	}
+}
+
 // This is used by several of the FileIO and /dev/fs functions
 std::string HLE_IPC_BuildFilename(std::string path_wii)
 {
@@ -28,6 +200,15 @@ std::string HLE_IPC_BuildFilename(std::string path_wii)
 			path_wii.replace(j, 1, replacement.second);
 	}
 
+	// In netplay, the game's save is the copy of the host's.
+	std::string nand_path, host_path;
+	if (NetPlay::GetWiiSaveRedirect(&nand_path, &host_path) &&
+	    path_wii.compare(0, nand_path.size(), nand_path) == 0 &&
+	    (path_wii.size() == nand_path.size() || path_wii[nand_path.size()] == '/'))
+	{
+		return host_path + path_wii.substr(nand_path.size());
+	}
+
 	path_full += path_wii;
 
 	return path_full;
@@ -82,6 +263,7 @@ IPCCommandResult CWII_IPC_HLE_Device_FileIO::Close(u32 _CommandAddress, bool _bF
 {
 	INFO_LOG(WII_IPC_FILEIO, "FileIO: Close %s (DeviceID=%08x)", m_Name.c_str(), m_DeviceID);
 	m_Mode = 0;
+	m_file.reset();
 
 	// Close always return 0 for success
 	if (_CommandAddress && !_bForce)
@@ -104,6 +286,7 @@ IPCCommandResult CWII_IPC_HLE_Device_FileIO::Open(u32 _CommandAddress, u32 _Mode
 	};
 
 	m_filepath = HLE_IPC_BuildFilename(m_Name);
+	m_file.reset();
 
 	// The file must exist before we can open it
 	// It should be created by ISFS_CreateFile, not here
@@ -124,27 +307,67 @@ IPCCommandResult CWII_IPC_HLE_Device_FileIO::Open(u32 _CommandAddress, u32 _Mode
 	return IPC_DEFAULT_REPLY;
 }
 
-File::IOFile CWII_IPC_HLE_Device_FileIO::OpenFile()
+bool CWII_IPC_HLE_Device_FileIO::OpenFile()
 {
-	const char* open_mode = "";
+	if (m_file)
+		return true;
 
 	switch (m_Mode)
 	{
 	case ISFS_OPEN_READ:
-		open_mode = "rb";
-		break;
-
 	case ISFS_OPEN_WRITE:
 	case ISFS_OPEN_RW:
-		open_mode = "r+b";
 		break;
 
 	default:
 		PanicAlertT("FileIO: Unknown open mode : 0x%02x", m_Mode);
-		break;
+		return false;
 	}
 
-	return File::IOFile(m_filepath, open_mode);
+	// The handle is shared with every fd for this file. It is reopened for
+	// writing when the first fd that can write uses it; the mode of each fd is
+	// checked by Read and Write.
+	const bool writable = m_Mode != ISFS_OPEN_READ;
+
+	auto it = s_host_files.find(m_filepath);
+	if (it != s_host_files.end())
+		m_file = it->second.lock();
+	if (m_file)
+	{
+		if (writable && !m_file->writable)
+		{
+			File::IOFile file;
+			if (OpenHostFile(file, m_filepath, true))
+			{
+				m_file->file.Swap(file);
+				m_file->writable = true;
+			}
+			else
+			{
+				WARN_LOG(WII_IPC_FILEIO, "FileIO: Failed to reopen %s for writing", m_Name.c_str());
+			}
+		}
+		return true;
+	}
+
+	File::IOFile file;
+	bool opened_writable = writable && OpenHostFile(file, m_filepath, true);
+	if (!opened_writable && !OpenHostFile(file, m_filepath, false))
+		return false;
+
+	const std::string path = m_filepath;
+	m_file = std::shared_ptr<HostFile>(new HostFile, [path](HostFile* host)
+	{
+		// The path may have been forgotten and opened again since.
+		auto entry = s_host_files.find(path);
+		if (entry != s_host_files.end() && entry->second.expired())
+			s_host_files.erase(entry);
+		delete host;
+	});
+	m_file->file.Swap(file);
+	m_file->writable = opened_writable;
+	s_host_files[path] = m_file;
+	return true;
 }
 
 IPCCommandResult CWII_IPC_HLE_Device_FileIO::Seek(u32 _CommandAddress)
@@ -153,11 +376,11 @@ IPCCommandResult CWII_IPC_HLE_Device_FileIO::Seek(u32 _CommandAddress)
 	const s32 SeekPosition = Memory::Read_U32(_CommandAddress + 0xC);
 	const s32 Mode = Memory::Read_U32(_CommandAddress + 0x10);
 
-	if (auto file = OpenFile())
+	if (OpenFile())
 	{
 		ReturnValue = FS_RESULT_FATAL;
 
-		const s32 fileSize = (s32) file.GetSize();
+		const s32 fileSize = (s32)GetHostFileSize(m_file->file);
 		INFO_LOG(WII_IPC_FILEIO, "FileIO: Seek Pos: 0x%08x, Mode: %i (%s, Length=0x%08x)", SeekPosition, Mode, m_Name.c_str(), fileSize);
 
 		switch (Mode)
@@ -217,8 +440,7 @@ IPCCommandResult CWII_IPC_HLE_Device_FileIO::Read(u32 _CommandAddress)
 	const u32 Address = Memory::Read_U32(_CommandAddress + 0xC); // Read to this memory address
 	const u32 Size    = Memory::Read_U32(_CommandAddress + 0x10);
 
-
-	if (auto file = OpenFile())
+	if (OpenFile())
 	{
 		if (m_Mode == ISFS_OPEN_WRITE)
 		{
@@ -227,17 +449,18 @@ IPCCommandResult CWII_IPC_HLE_Device_FileIO::Read(u32 _CommandAddress)
 		else
 		{
 			INFO_LOG(WII_IPC_FILEIO, "FileIO: Read 0x%x bytes to 0x%08x from %s", Size, Address, m_Name.c_str());
-			file.Seek(m_SeekPos, SEEK_SET);
-			ReturnValue = (u32)fread(Memory::GetPointer(Address), 1, Size, file.GetHandle());
-			if (ReturnValue != Size && ferror(file.GetHandle()))
+			u8* data = Memory::GetPointer(Address);
+			Memory::PrepareHostWrite(data, Size);
+			const s64 read = ReadCached(*m_file, data, Size, m_SeekPos);
+			if (read < 0)
 			{
 				ReturnValue = FS_EACCESS;
 			}
 			else
 			{
+				ReturnValue = (u32)read;
 				m_SeekPos += Size;
 			}
-
 		}
 	}
 	else
@@ -256,7 +479,7 @@ IPCCommandResult CWII_IPC_HLE_Device_FileIO::Write(u32 _CommandAddress)
 	const u32 Address = Memory::Read_U32(_CommandAddress + 0xC); // Write data from this memory address
 	const u32 Size    = Memory::Read_U32(_CommandAddress + 0x10);
 
-	if (auto file = OpenFile())
+	if (OpenFile())
 	{
 		if (m_Mode == ISFS_OPEN_READ)
 		{
@@ -265,8 +488,8 @@ IPCCommandResult CWII_IPC_HLE_Device_FileIO::Write(u32 _CommandAddress)
 		else
 		{
 			INFO_LOG(WII_IPC_FILEIO, "FileIO: Write 0x%04x bytes from 0x%08x to %s", Size, Address, m_Name.c_str());
-			file.Seek(m_SeekPos, SEEK_SET);
-			if (file.WriteBytes(Memory::GetPointer(Address), Size))
+			m_file->read_ahead.clear();
+			if (WriteAt(m_file->file, Memory::GetPointer(Address), Size, m_SeekPos))
 			{
 				ReturnValue = Size;
 				m_SeekPos += Size;
@@ -296,9 +519,9 @@ IPCCommandResult CWII_IPC_HLE_Device_FileIO::IOCtl(u32 _CommandAddress)
 	{
 	case ISFS_IOCTL_GETFILESTATS:
 		{
-			if (auto file = OpenFile())
+			if (OpenFile())
 			{
-				u32 m_FileLength = (u32)file.GetSize();
+				u32 m_FileLength = (u32)GetHostFileSize(m_file->file);
 
 				const u32 BufferOut = Memory::Read_U32(_CommandAddress + 0x18);
 				INFO_LOG(WII_IPC_FILEIO, "  File: %s, Length: %i, Pos: %i", m_Name.c_str(), m_FileLength, m_SeekPos);
@@ -334,4 +557,12 @@ void CWII_IPC_HLE_Device_FileIO::DoState(PointerWrap &p)
 	p.Do(m_SeekPos);
 
 	m_filepath = HLE_IPC_BuildFilename(m_Name);
+
+	if (p.GetMode() == PointerWrap::MODE_READ)
+	{
+		// The file may have changed since the state was saved.
+		m_file.reset();
+		if (m_Mode && OpenFile())
+			m_file->read_ahead.clear();
+	}
 }
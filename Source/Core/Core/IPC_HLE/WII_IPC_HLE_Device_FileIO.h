@@ -4,14 +4,17 @@
 
 #pragma once
 
+#include <memory>
 #include <string>
 #include "Core/IPC_HLE/WII_IPC_HLE_Device.h"
 
 class PointerWrap;
-namespace File { class IOFile; }
 
 std::string HLE_IPC_BuildFilename(std::string _pFilename);
 void HLE_IPC_CreateVirtualFATFilesystem();
+// Called when a host file or directory is deleted or renamed, so that fds
+// opened afterwards don't share the handle of the file that was there before.
+void HLE_IPC_ForgetHostFiles(const std::string& host_path);
 
 class CWII_IPC_HLE_Device_FileIO : public IWII_IPC_HLE_Device
 {
@@ -28,9 +31,12 @@ public:
 	IPCCommandResult IOCtl(u32 _CommandAddress) override;
 	void DoState(PointerWrap &p) override;
 
-	File::IOFile OpenFile();
+	// The host file and its read-ahead buffer, shared by all fds for the same path.
+	struct HostFile;
 
 private:
+	bool OpenFile();
+
 	enum
 	{
 		ISFS_OPEN_READ  = 1,
@@ -75,4 +81,5 @@ private:
 	u32 m_SeekPos;
 
 	std::string m_filepath;
+	std::shared_ptr<HostFile> m_file;
 };
@@ -382,10 +382,12 @@ s32 CWII_IPC_HLE_Device_fs::ExecuteCommand(u32 _Parameter, u32 _BufferIn, u32 _B
 			if (File::Delete(Filename))
 			{
 				INFO_LOG(WII_IPC_FILEIO, "FS: DeleteFile %s", Filename.c_str());
+				HLE_IPC_ForgetHostFiles(Filename);
 			}
 			else if (File::DeleteDir(Filename))
 			{
 				INFO_LOG(WII_IPC_FILEIO, "FS: DeleteDir %s", Filename.c_str());
+				HLE_IPC_ForgetHostFiles(Filename);
 			}
 			else
 			{
@@ -420,6 +422,8 @@ s32 CWII_IPC_HLE_Device_fs::ExecuteCommand(u32 _Parameter, u32 _BufferIn, u32 _B
 			if (File::Rename(Filename, FilenameRename))
 			{
 				INFO_LOG(WII_IPC_FILEIO, "FS: Rename %s to %s", Filename.c_str(), FilenameRename.c_str());
+				HLE_IPC_ForgetHostFiles(Filename);
+				HLE_IPC_ForgetHostFiles(FilenameRename);
 			}
 			else
 			{
@@ -488,6 +488,7 @@ void WiiSocket::Update(bool read, bool write, bool except)
 					}
 #endif
 					socklen_t addrlen = sizeof(sockaddr_in);
+					Memory::PrepareHostWrite((u8*)data, data_len);
 					int ret = recvfrom(fd, data, data_len, flags,
 									BufferOutSize2 ? (struct sockaddr*) &local_name : nullptr,
 									BufferOutSize2 ? &addrlen : nullptr);
@@ -42,6 +42,11 @@ LONG NTAPI Handler(PEXCEPTION_POINTERS pPtrs)
 			uintptr_t badAddress = (uintptr_t)pPtrs->ExceptionRecord->ExceptionInformation[1];
 			CONTEXT *ctx = pPtrs->ContextRecord;
 
+			if (Memory::HandleSnapshotFault(badAddress))
+			{
+				return (DWORD)EXCEPTION_CONTINUE_EXECUTION;
+			}
+
 			if (JitInterface::HandleFault(badAddress, ctx))
 			{
 				return (DWORD)EXCEPTION_CONTINUE_EXECUTION;
@@ -78,20 +83,26 @@ LONG NTAPI Handler(PEXCEPTION_POINTERS pPtrs)
 	}
 }
 
+static bool s_handler_installed = false;
+
 void InstallExceptionHandler()
 {
 	// Make sure this is only called once per process execution
 	// Instead, could make a Uninstall function, but whatever..
-	static bool handlerInstalled = false;
-	if (handlerInstalled)
+	if (s_handler_installed)
 		return;
 
 	AddVectoredExceptionHandler(TRUE, Handler);
-	handlerInstalled = true;
+	s_handler_installed = true;
 }
 
 void UninstallExceptionHandler() {}
 
+bool IsProcessWideHandlerInstalled()
+{
+	return s_handler_installed;
+}
+
 #elif defined(__APPLE__) && !defined(USE_SIGACTION_ON_APPLE)
 
 const bool g_exception_handlers_supported = true;
@@ -214,10 +225,18 @@ void InstallExceptionHandler()
 
 void UninstallExceptionHandler() {}
 
+// Exception ports are set per thread.
+bool IsProcessWideHandlerInstalled()
+{
+	return false;
+}
+
 #elif defined(_POSIX_VERSION) && !defined(_M_GENERIC)
 
 const bool g_exception_handlers_supported = true;
 
+static bool s_handler_installed = false;
+
 static void sigsegv_handler(int sig, siginfo_t *info, void *raw_context)
 {
 	if (sig != SIGSEGV && sig != SIGBUS)
@@ -234,6 +253,9 @@ static void sigsegv_handler(int sig, siginfo_t *info, void *raw_context)
 	}
 	uintptr_t bad_address = (uintptr_t)info->si_addr;
 
+	if (Memory::HandleSnapshotFault(bad_address))
+		return;
+
 	// Get all the information we can out of the context.
 	mcontext_t *ctx = &context->uc_mcontext;
 	// assume it's not a write
@@ -270,6 +292,7 @@ void InstallExceptionHandler()
 #ifdef __APPLE__
 	sigaction(SIGBUS, &sa, nullptr);
 #endif
+	s_handler_installed = true;
 }
 
 void UninstallExceptionHandler()
@@ -282,11 +305,17 @@ void UninstallExceptionHandler()
 		free(old_stack.ss_sp);
 	}
 }
+
+bool IsProcessWideHandlerInstalled()
+{
+	return s_handler_installed;
+}
 #else // _M_GENERIC or unsupported platform
 
 const bool g_exception_handlers_supported = false;
 void InstallExceptionHandler() {}
 void UninstallExceptionHandler() {}
+bool IsProcessWideHandlerInstalled() { return false; }
 
 #endif
 
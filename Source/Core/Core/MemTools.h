@@ -12,4 +12,7 @@ namespace EMM
 	extern const bool g_exception_handlers_supported;
 	void InstallExceptionHandler();
 	void UninstallExceptionHandler();
+	// Whether the handler is installed and also sees faults from threads other
+	// than the one which installed it.
+	bool IsProcessWideHandlerInstalled();
 }
@@ -2,12 +2,14 @@
 // Licensed under GPLv2
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <polarssl/md5.h>
 
 #include "Common/ChunkFile.h"
 #include "Common/CommonPaths.h"
 #include "Common/FileUtil.h"
 #include "Common/Hash.h"
+#include "Common/MappedFile.h"
 #include "Common/NandPaths.h"
 #include "Common/StringUtil.h"
 #include "Common/Thread.h"
@@ -36,6 +38,8 @@
 
 // The chunk to allocate movie data in multiples of.
 #define DTM_BASE_LENGTH (1024)
+// Streamed input is written to disk, and hashed, in blocks of this size.
+#define DTM_STREAM_BLOCK_SIZE (64 * 1024)
 
 static std::mutex cs_frameSkip;
 
@@ -85,6 +89,20 @@ static std::string s_InputDisplay[8];
 static GCManipFunction gcmfunc = nullptr;
 static WiiManipFunction wiimfunc = nullptr;
 
+// Streaming mode: instead of being kept in tmpInput, the input is appended to
+// a DTM file in blocks and read back through a memory mapping. Savestates
+// then only store s_currentByte and a hash of the input up to it, instead of
+// a copy of the whole movie.
+static bool s_bStreaming = false;
+static std::string s_streamPath;           // DTM file the input is read from
+static MappedFile s_streamMap;             // mapping of s_streamPath, may be stale while recording
+static File::IOFile s_streamFile;          // s_streamPath opened for appending, while recording
+static std::vector<u8> s_streamBlock;      // recorded input not written to s_streamFile yet
+static u64 s_streamFlushedBytes = 0;       // amount of input in s_streamFile
+static std::vector<u64> s_streamHashes;    // hash of the first i blocks of input, see GetInputHash
+static std::vector<u8> s_streamReadBuffer; // input read from s_streamPath when it can't be mapped
+static u64 s_loadedInputHash = 0;          // from the last loaded savestate
+
 static void EnsureTmpInputSize(size_t bound)
 {
 	if (tmpInputAllocated >= bound)
@@ -106,6 +124,154 @@ static void EnsureTmpInputSize(size_t bound)
 	tmpInput = newTmpInput;
 }
 
+static std::string GetStreamWorkingPath()
+{
+	return File::GetUserPath(D_STATESAVES_IDX) + "stream.dtm";
+}
+
+static void CloseInputStream()
+{
+	s_streamMap.Close();
+	s_streamFile.Close();
+	s_streamBlock.clear();
+	s_streamReadBuffer.clear();
+	s_streamFlushedBytes = 0;
+	s_streamHashes.clear();
+}
+
+static void FlushInputStream()
+{
+	if (!s_streamFile.IsOpen() || s_streamBlock.empty())
+		return;
+
+	s_streamFile.WriteBytes(s_streamBlock.data(), s_streamBlock.size());
+	s_streamFile.Flush();
+	s_streamFlushedBytes += s_streamBlock.size();
+	s_streamBlock.clear();
+}
+
+// Returns a pointer to <size> bytes of input at <offset>, which must be
+// within s_totalBytes.
+static const u8* GetInput(u64 offset, u64 size)
+{
+	if (!s_bStreaming)
+		return &tmpInput[offset];
+
+	if (s_streamFile.IsOpen() && offset >= s_streamFlushedBytes)
+		return &s_streamBlock[(size_t)(offset - s_streamFlushedBytes)];
+
+	if (!s_streamMap.IsOpen() || sizeof(DTMHeader) + offset + size > s_streamMap.GetSize())
+	{
+		FlushInputStream();
+		if (!s_streamMap.Open(s_streamPath, false) || sizeof(DTMHeader) + offset + size > s_streamMap.GetSize())
+		{
+			// Fall back to a buffered read.
+			s_streamMap.Close();
+			s_streamReadBuffer.assign((size_t)size, 0);
+			File::IOFile file(s_streamPath, "rb");
+			if (!file.Seek(sizeof(DTMHeader) + offset, SEEK_SET) || !file.ReadBytes(s_streamReadBuffer.data(), (size_t)size))
+				PanicAlertT("Failed to read input from %s", s_streamPath.c_str());
+			return s_streamReadBuffer.data();
+		}
+	}
+	return s_streamMap.GetData() + sizeof(DTMHeader) + offset;
+}
+
+static bool HasInput()
+{
+	return s_bStreaming ? !s_streamPath.empty() : tmpInput != nullptr;
+}
+
+// Discards all input after <size> bytes and prepares for appending to it.
+// Playback of an existing movie is redirected to a copy in the user
+// directory, so that the original file is never modified.
+static void TruncateInputStream(u64 size)
+{
+	const std::string working_path = GetStreamWorkingPath();
+	if (s_streamPath != working_path)
+	{
+		File::IOFile working(working_path, "wb");
+		DTMHeader header = {};
+		working.WriteArray(&header, 1);
+		for (u64 offset = 0; offset < size; offset += DTM_STREAM_BLOCK_SIZE)
+		{
+			u64 chunk = std::min<u64>(DTM_STREAM_BLOCK_SIZE, size - offset);
+			working.WriteBytes(GetInput(offset, chunk), (size_t)chunk);
+		}
+		working.Close();
+
+		CloseInputStream();
+		s_streamPath = working_path;
+	}
+	else
+	{
+		FlushInputStream();
+		s_streamMap.Close();
+		s_streamFile.Close();
+	}
+
+	s_streamFile.Open(s_streamPath, "r+b");
+	s_streamFile.Resize(sizeof(DTMHeader) + size);
+	s_streamFile.Seek(0, SEEK_END);
+	s_streamFlushedBytes = size;
+	s_streamBlock.clear();
+
+	size_t valid_hashes = (size_t)(size / DTM_STREAM_BLOCK_SIZE) + 1;
+	if (s_streamHashes.size() > valid_hashes)
+		s_streamHashes.resize(valid_hashes);
+
+	s_totalBytes = size;
+}
+
+static void AppendInput(const u8* data, size_t size)
+{
+	if (!s_bStreaming)
+	{
+		EnsureTmpInputSize((size_t)(s_currentByte + size));
+		memcpy(&tmpInput[s_currentByte], data, size);
+	}
+	else
+	{
+		if (!s_streamFile.IsOpen() || s_currentByte != s_totalBytes)
+			TruncateInputStream(s_currentByte);
+
+		s_streamBlock.insert(s_streamBlock.end(), data, data + size);
+		if (s_streamBlock.size() >= DTM_STREAM_BLOCK_SIZE)
+			FlushInputStream();
+	}
+
+	s_currentByte += size;
+	s_totalBytes = s_currentByte;
+}
+
+static u64 HashInput(u64 hash, const u8* data, u64 size)
+{
+	// FNV-1a, which can be resumed from any point.
+	for (u64 i = 0; i < size; ++i)
+		hash = (hash ^ data[i]) * 0x100000001B3ULL;
+	return hash;
+}
+
+// Hash of the first <size> bytes of input. The hash at every block boundary
+// is kept, so only the input since the previous savestate is hashed.
+static u64 GetInputHash(u64 size)
+{
+	if (s_streamHashes.empty())
+		s_streamHashes.push_back(0xCBF29CE484222325ULL);
+
+	u64 block = size / DTM_STREAM_BLOCK_SIZE;
+	while (s_streamHashes.size() <= block)
+	{
+		u64 offset = (s_streamHashes.size() - 1) * DTM_STREAM_BLOCK_SIZE;
+		s_streamHashes.push_back(HashInput(s_streamHashes.back(), GetInput(offset, DTM_STREAM_BLOCK_SIZE), DTM_STREAM_BLOCK_SIZE));
+	}
+
+	u64 offset = block * DTM_STREAM_BLOCK_SIZE;
+	if (offset == size)
+		return s_streamHashes[(size_t)block];
+	return HashInput(s_streamHashes[(size_t)block], GetInput(offset, size - offset), size - offset);
+}
+
 static bool IsMovieHeader(u8 magic[4])
 {
 	return magic[0] == 'D' &&
@@ -490,9 +656,19 @@ bool BeginRecordingInput(int controllers)
 	}
 	s_playMode = MODE_RECORDING;
 	s_author = SConfig::GetInstance().m_strMovieAuthor;
-	EnsureTmpInputSize(1);
 
+	s_bStreaming = SConfig::GetInstance().m_StreamMovieInput;
 	s_currentByte = s_totalBytes = 0;
+	if (s_bStreaming)
+	{
+		CloseInputStream();
+		s_streamPath.clear();
+		TruncateInputStream(0);
+	}
+	else
+	{
+		EnsureTmpInputSize(1);
+	}
 
 	Core::UpdateWantDeterminism();
 
@@ -745,10 +921,7 @@ void RecordInput(GCPadStatus* PadStatus, int controllerID)
 
 	CheckPadStatus(PadStatus, controllerID);
 
-	EnsureTmpInputSize((size_t)(s_currentByte + 8));
-	memcpy(&(tmpInput[s_currentByte]), &s_padState, 8);
-	s_currentByte += 8;
-	s_totalBytes = s_currentByte;
+	AppendInput((const u8*)&s_padState, 8);
 }
 
 void CheckWiimoteStatus(int wiimote, u8 *data, const WiimoteEmu::ReportFeatures& rptf, int ext, const wiimote_key key)
@@ -765,11 +938,8 @@ void RecordWiimote(int wiimote, u8 *data, u8 size)
 		return;
 
 	InputUpdate();
-	EnsureTmpInputSize((size_t)(s_currentByte + size + 1));
-	tmpInput[s_currentByte++] = size;
-	memcpy(&(tmpInput[s_currentByte]), data, size);
-	s_currentByte += size;
-	s_totalBytes = s_currentByte;
+	AppendInput(&size, 1);
+	AppendInput(data, size);
 }
 
 void ReadHeader()
@@ -844,9 +1014,19 @@ bool PlayInput(const std::string& filename)
 	Core::UpdateWantDeterminism();
 
 	s_totalBytes = g_recordfd.GetSize() - 256;
-	EnsureTmpInputSize((size_t)s_totalBytes);
-	g_recordfd.ReadArray(tmpInput, (size_t)s_totalBytes);
 	s_currentByte = 0;
+	s_bStreaming = SConfig::GetInstance().m_StreamMovieInput;
+	if (s_bStreaming)
+	{
+		// The input is read straight from the movie file.
+		CloseInputStream();
+		s_streamPath = filename;
+	}
+	else
+	{
+		EnsureTmpInputSize((size_t)s_totalBytes);
+		g_recordfd.ReadArray(tmpInput, (size_t)s_totalBytes);
+	}
 	g_recordfd.Close();
 
 	// Load savestate (and skip to frame data)
@@ -856,7 +1036,15 @@ bool PlayInput(const std::string& filename)
 		if (File::Exists(stateFilename))
 			Core::SetStateFileName(stateFilename);
 		s_bRecordingFromSaveState = true;
-		Movie::LoadInput(filename);
+		if (s_bStreaming)
+		{
+			s_loadedInputHash = GetInputHash(0);
+			Movie::LoadStreamedInput();
+		}
+		else
+		{
+			Movie::LoadInput(filename);
+		}
 	}
 
 	return true;
@@ -873,6 +1061,69 @@ void DoState(PointerWrap &p)
 	p.Do(s_bPolled);
 	p.Do(s_tickCountAtLastInput);
 	// other variables (such as s_totalBytes and g_totalFrames) are set in LoadInput
+
+	// Only set for streamed movies, which are verified against it in LoadStreamedInput.
+	u64 input_hash = 0;
+	if (p.GetMode() != PointerWrap::MODE_READ && s_bStreaming && IsMovieActive())
+		input_hash = GetInputHash(s_currentByte);
+	p.Do(input_hash);
+	if (p.GetMode() == PointerWrap::MODE_READ)
+		s_loadedInputHash = input_hash;
+}
+
+bool IsStreamingInput()
+{
+	return s_bStreaming;
+}
+
+void LoadStreamedInput()
+{
+	bool afterEnd = false;
+	if (s_loadedInputHash == 0)
+	{
+		// The savestate wasn't made during a streamed movie.
+		afterEnd = true;
+	}
+	else if (s_currentByte > s_totalBytes)
+	{
+		afterEnd = true;
+		PanicAlertT("Warning: You loaded a save that's after the end of the current movie. (byte %u > %u) (frame %u > %u). You should load another save before continuing.", (u32)s_currentByte+256, (u32)s_totalBytes+256, (u32)g_currentFrame, (u32)g_totalFrames);
+	}
+	else if (GetInputHash(s_currentByte) != s_loadedInputHash)
+	{
+		PanicAlertT("Warning: You loaded a save whose movie input up to frame %u doesn't match the current movie. You should load another save before continuing. Otherwise you'll probably get a desync.", (u32)g_currentFrame);
+	}
+
+	if (afterEnd)
+	{
+		EndPlayInput(false);
+		return;
+	}
+
+	if (s_bReadOnly)
+	{
+		if (s_playMode != MODE_PLAYING)
+		{
+			s_playMode = MODE_PLAYING;
+			Core::DisplayMessage("Switched to playback", 2000);
+		}
+	}
+	else
+	{
+		// Continue recording from the savestate, dropping what came after it.
+		s_rerecords++;
+		TruncateInputStream(s_currentByte);
+		g_totalFrames = g_currentFrame;
+		s_totalLagCount = g_currentLagCount;
+		g_totalInputCount = g_currentInputCount;
+		s_totalTickCount = s_tickCountAtLastInput;
+
+		if (s_playMode != MODE_RECORDING)
+		{
+			s_playMode = MODE_RECORDING;
+			Core::DisplayMessage("Switched to recording", 2000);
+		}
+	}
 }
 
 void LoadInput(const std::string& filename)
@@ -1024,7 +1275,7 @@ void PlayController(GCPadStatus* PadStatus, int controllerID)
 {
 	// Correct playback is entirely dependent on the emulator polling the controllers
 	// in the same order done during recording
-	if (!IsPlayingInput() || !IsUsingPad(controllerID) || tmpInput == nullptr)
+	if (!IsPlayingInput() || !IsUsingPad(controllerID) || !HasInput())
 		return;
 
 	if (s_currentByte + 8 > s_totalBytes)
@@ -1040,7 +1291,7 @@ void PlayController(GCPadStatus* PadStatus, int controllerID)
 	PadStatus->err = e;
 
 
-	memcpy(&s_padState, &(tmpInput[s_currentByte]), 8);
+	memcpy(&s_padState, GetInput(s_currentByte, 8), 8);
 	s_currentByte += 8;
 
 	PadStatus->triggerLeft = s_padState.TriggerL;
@@ -1122,10 +1373,10 @@ void PlayController(GCPadStatus* PadStatus, int controllerID)
 
 bool PlayWiimote(int wiimote, u8 *data, const WiimoteEmu::ReportFeatures& rptf, int ext, const wiimote_key key)
 {
-	if (!IsPlayingInput() || !IsUsingWiimote(wiimote) || tmpInput == nullptr)
+	if (!IsPlayingInput() || !IsUsingWiimote(wiimote) || !HasInput())
 		return false;
 
-	if (s_currentByte > s_totalBytes)
+	if (s_currentByte >= s_totalBytes)
 	{
 		PanicAlertT("Premature movie end in PlayWiimote. %u > %u", (u32)s_currentByte, (u32)s_totalBytes);
 		EndPlayInput(!s_bReadOnly);
@@ -1134,7 +1385,7 @@ bool PlayWiimote(int wiimote, u8 *data, const WiimoteEmu::ReportFeatures& rptf,
 
 	u8 size = rptf.size;
 
-	u8 sizeInMovie = tmpInput[s_currentByte];
+	u8 sizeInMovie = *GetInput(s_currentByte, 1);
 
 	if (size != sizeInMovie)
 	{
@@ -1153,7 +1404,7 @@ bool PlayWiimote(int wiimote, u8 *data, const WiimoteEmu::ReportFeatures& rptf,
 		return false;
 	}
 
-	memcpy(data, &(tmpInput[s_currentByte]), size);
+	memcpy(data, GetInput(s_currentByte, size), size);
 	s_currentByte += size;
 
 	g_currentInputCount++;
@@ -1237,7 +1488,20 @@ void SaveRecording(const std::string& filename)
 
 	save_record.WriteArray(&header, 1);
 
-	bool success = save_record.WriteArray(tmpInput, (size_t)s_totalBytes);
+	bool success;
+	if (s_bStreaming)
+	{
+		success = true;
+		for (u64 offset = 0; success && offset < s_totalBytes; offset += DTM_STREAM_BLOCK_SIZE)
+		{
+			u64 chunk = std::min<u64>(DTM_STREAM_BLOCK_SIZE, s_totalBytes - offset);
+			success = save_record.WriteBytes(GetInput(offset, chunk), (size_t)chunk);
+		}
+	}
+	else
+	{
+		success = save_record.WriteArray(tmpInput, (size_t)s_totalBytes);
+	}
 
 	if (success && s_bRecordingFromSaveState)
 	{
@@ -1371,5 +1635,8 @@ void Shutdown()
 	delete [] tmpInput;
 	tmpInput = nullptr;
 	tmpInputAllocated = 0;
+	CloseInputStream();
+	s_streamPath.clear();
+	s_bStreaming = false;
 }
 };
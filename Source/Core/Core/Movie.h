@@ -161,6 +161,8 @@ void RecordWiimote(int wiimote, u8 *data, u8 size);
 
 bool PlayInput(const std::string& filename);
 void LoadInput(const std::string& filename);
+bool IsStreamingInput();
+void LoadStreamedInput();
 void ReadHeader();
 void PlayController(GCPadStatus* PadStatus, int controllerID);
 bool PlayWiimote(int wiimote, u8* data, const struct WiimoteEmu::ReportFeatures& rptf, int ext, const wiimote_key key);
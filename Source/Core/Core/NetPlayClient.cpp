@@ -2,13 +2,24 @@
 // Licensed under GPLv2
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <set>
+#include <zlib.h>
+
+#include "Common/CommonPaths.h"
 #include "Common/ENetUtil.h"
+#include "Common/FileUtil.h"
+#include "Common/Hash.h"
+#include "Common/StringUtil.h"
 #include "Common/Timer.h"
 #include "Core/ConfigManager.h"
 #include "Core/Core.h"
+#include "Core/CoreTiming.h"
 #include "Core/Movie.h"
 #include "Core/NetPlayClient.h"
+#include "Core/State.h"
 #include "Core/HW/EXI_DeviceIPL.h"
+#include "Core/HW/EXI_DeviceMemoryCard.h"
 #include "Core/HW/SI.h"
 #include "Core/HW/SI_DeviceDanceMat.h"
 #include "Core/HW/SI_DeviceGCController.h"
@@ -22,12 +33,115 @@ static std::mutex crit_netplay_client;
 static NetPlayClient * netplay_client = nullptr;
 NetSettings g_NetPlaySettings;
 
+// Where the copy of the host's save is kept: a file for a raw memory card, a
+// directory for the others.
+static std::string GetSyncedSavePath(int save_index, u8 type)
+{
+	if (save_index == SAVE_SYNC_WII)
+		return File::GetUserPath(D_USER_IDX) + "NetPlayWiiSave";
+	if (type == SAVE_TYPE_GCI_FOLDER)
+		return File::GetUserPath(D_GCUSER_IDX) + StringFromFormat("NetPlay Card %c", 'A' + save_index);
+	return File::GetUserPath(D_GCUSER_IDX) + StringFromFormat("NetPlay%s.raw", (save_index == 0) ? "A" : "B");
+}
+
+// The files of a save are named by their paths relative to its directory,
+// which must stay inside it.
+static bool IsValidSaveFileName(const std::string& name)
+{
+	if (name.empty() || name.find_first_of("\\:") != std::string::npos)
+		return false;
+
+	std::vector<std::string> components;
+	SplitString(name, '/', components);
+	for (const std::string& component : components)
+	{
+		if (component.empty() || component == "." || component == "..")
+			return false;
+	}
+	return true;
+}
+
+// Replaced in one go, so an interrupted transfer can't leave a torn file.
+static bool WriteSaveFile(const std::string& path, const std::vector<u8>& data)
+{
+	const std::string temp_path = File::GetTempFilenameForAtomicWrite(path);
+	{
+		File::IOFile file(temp_path, "wb");
+		if (!file || !file.WriteBytes(data.data(), data.size()))
+			return false;
+	}
+	return File::RenameSync(temp_path, path);
+}
+
+// Deletes the files in a directory of a synced save that the host doesn't have.
+static void DeleteOtherSaveFiles(const File::FSTEntry& directory, const std::string& prefix,
+                                 const std::set<std::string>& names)
+{
+	for (const File::FSTEntry& entry : directory.children)
+	{
+		const std::string name = prefix + entry.virtualName;
+		if (entry.isDirectory)
+			DeleteOtherSaveFiles(entry, name + "/", names);
+		else if (!names.count(name))
+			File::Delete(entry.physicalName);
+	}
+}
+
+void LatencyHistogram::Reset()
+{
+	std::fill(std::begin(buckets), std::end(buckets), 0);
+	count = 0;
+	total_us = 0;
+	max_us = 0;
+}
+
+void LatencyHistogram::Add(u32 latency_us)
+{
+	int bucket = 0;
+	for (u32 ms = latency_us / 1000; ms && bucket < NUM_BUCKETS - 1; ms >>= 1)
+		++bucket;
+
+	++buckets[bucket];
+	++count;
+	total_us += latency_us;
+	max_us = std::max(max_us, latency_us);
+}
+
+u32 LatencyHistogram::GetPercentileMs(u32 percent) const
+{
+	u64 needed = ((u64)count * percent + 99) / 100;
+	u64 seen = 0;
+	for (int i = 0; i < NUM_BUCKETS - 1; ++i)
+	{
+		seen += buckets[i];
+		if (seen >= needed)
+			return 1 << i;
+	}
+	return (max_us + 999) / 1000;
+}
+
+std::string LatencyHistogram::ToString() const
+{
+	std::ostringstream ss;
+	ss << count << " packets, " << GetAverageUs() << "us avg, " << max_us << "us max |";
+	for (int i = 0; i < NUM_BUCKETS; ++i)
+	{
+		if (i == NUM_BUCKETS - 1)
+			ss << " >=" << (1 << (i - 1));
+		else
+			ss << " <" << (1 << i);
+		ss << "ms: " << buckets[i];
+	}
+	return ss.str();
+}
+
 // called from ---GUI--- thread
 NetPlayClient::~NetPlayClient()
 {
 	// not perfect
 	if (m_is_running)
 		StopGame();
+	StopRollback();
 
 	if (is_connected)
 	{
@@ -65,16 +179,33 @@ NetPlayClient::NetPlayClient(const std::string& address, const u16 port, NetPlay
 	, m_is_running(false)
 	, m_do_loop(true)
 	, m_target_buffer_size()
+	, m_rollback_frames(0)
 	, m_local_player(nullptr)
 	, m_current_game(0)
 	, m_is_recording(false)
 	, m_pid(0)
 	, m_connecting(false)
 	, m_traversal_client(nullptr)
+	, m_pending_pad_time(0)
+	, m_server_time_offset(0)
+	, m_server_time_known(false)
+	, m_rollback_active(0)
+	, m_rollback_running(false)
+	, m_rollback_event_type(-1)
+	, m_start_game_deferred(false)
 {
 	m_target_buffer_size = 20;
 	ClearBuffers();
 
+	for (int i = 0; i < NUM_SAVE_SYNCS; ++i)
+	{
+		m_save_sync[i].type = SAVE_TYPE_NONE;
+		m_save_sync[i].title_id = 0;
+		m_save_sync[i].blocks_total = 0;
+		m_save_sync[i].blocks_left = 0;
+		m_save_synced[i] = false;
+	}
+
 	is_connected = false;
 
 	m_player_name = name;
@@ -321,33 +452,67 @@ unsigned int NetPlayClient::OnData(sf::Packet& packet)
 
 	case NP_MSG_PAD_DATA:
 	{
+		u32 timestamp;
+		packet >> timestamp;
+
+		PadMapping map = 0;
+		while (!packet.endOfPacket())
+		{
+			GCPadStatus pad;
+			packet >> map >> pad.button >> pad.analogA >> pad.analogB >> pad.stickX >> pad.stickY >> pad.substickX >> pad.substickY >> pad.triggerLeft >> pad.triggerRight;
+
+			// trusting server for good map value (>=0 && <4)
+			// add to pad buffer
+			m_pad_buffer[map].Push(pad);
+		}
+		m_input_event.Set();
+
+		AddInputLatency(m_pad_map[map], timestamp);
+	}
+	break;
+
+	case NP_MSG_ROLLBACK_PAD_DATA:
+	{
+		u32 timestamp, frame;
+		packet >> timestamp >> frame;
+
 		PadMapping map = 0;
-		GCPadStatus pad;
-		packet >> map >> pad.button >> pad.analogA >> pad.analogB >> pad.stickX >> pad.stickY >> pad.substickX >> pad.substickY >> pad.triggerLeft >> pad.triggerRight;
+		while (!packet.endOfPacket())
+		{
+			GCPadStatus pad;
+			packet >> map >> pad.button >> pad.analogA >> pad.analogB >> pad.stickX >> pad.stickY >> pad.substickX >> pad.substickY >> pad.triggerLeft >> pad.triggerRight;
+
+			// trusting server for good map value (>=0 && <4)
+			ConfirmInput(map, frame, pad);
+		}
+		m_input_event.Set();
 
-		// trusting server for good map value (>=0 && <4)
-		// add to pad buffer
-		m_pad_buffer[map].Push(pad);
+		AddInputLatency(m_pad_map[map], timestamp);
 	}
 	break;
 
 	case NP_MSG_WIIMOTE_DATA:
 	{
+		u32 timestamp;
 		PadMapping map = 0;
-		NetWiimote nw;
-		u8 size;
-		packet >> map >> size;
+		packet >> timestamp >> map;
+
+		while (!packet.endOfPacket())
+		{
+			u8 size;
+			packet >> size;
 
-		nw.resize(size);
-		u8* data = new u8[size];
-		for (unsigned int i = 0; i < size; ++i)
-			packet >> data[i];
-		nw.assign(data, data + size);
-		delete[] data;
+			NetWiimote nw(size);
+			for (u8& byte : nw)
+				packet >> byte;
 
-		// trusting server for good map value (>=0 && <4)
-		// add to Wiimote buffer
-		m_wiimote_buffer[(unsigned)map].Push(nw);
+			// trusting server for good map value (>=0 && <4)
+			// add to Wiimote buffer
+			m_wiimote_buffer[(unsigned)map].Push(nw);
+		}
+		m_input_event.Set();
+
+		AddInputLatency(m_wiimote_map[map], timestamp);
 	}
 	break;
 
@@ -361,6 +526,15 @@ unsigned int NetPlayClient::OnData(sf::Packet& packet)
 	}
 	break;
 
+	case NP_MSG_ROLLBACK:
+	{
+		u32 frames = 0;
+		packet >> frames;
+
+		m_rollback_frames = std::min<u32>(frames, MAX_ROLLBACK_FRAMES);
+	}
+	break;
+
 	case NP_MSG_CHANGE_GAME:
 	{
 		{
@@ -398,7 +572,146 @@ unsigned int NetPlayClient::OnData(sf::Packet& packet)
 			g_netplay_initial_gctime = x | ((u64)y >> 32);
 		}
 
-		m_dialog->OnMsgStartGame();
+		{
+			std::lock_guard<std::recursive_mutex> lkp(m_crit.players);
+			for (auto& player : m_players)
+				player.second.input_latency.Reset();
+		}
+
+		std::lock_guard<std::recursive_mutex> lkg(m_crit.game);
+		m_start_game_deferred = std::any_of(std::begin(m_save_sync), std::end(m_save_sync),
+		                                    [](const SaveSync& sync) { return sync.blocks_left != 0; });
+		if (!m_start_game_deferred)
+			m_dialog->OnMsgStartGame();
+	}
+	break;
+
+	case NP_MSG_SAVE_HASHES:
+	{
+		u8 save_index = 0;
+		PlayerId host_pid = 0;
+		u8 type = SAVE_TYPE_NONE;
+		u32 title_low = 0, title_high = 0, num_files = 0;
+		packet >> save_index >> host_pid >> type >> title_low >> title_high >> num_files;
+		if (!packet || save_index >= NUM_SAVE_SYNCS)
+			break;
+
+		std::lock_guard<std::recursive_mutex> lkg(m_crit.game);
+		SaveSync& sync = m_save_sync[save_index];
+		sync.type = type;
+		sync.title_id = (u64)title_high << 32 | title_low;
+		sync.files.clear();
+		sync.blocks_total = 0;
+		sync.blocks_left = 0;
+		// The host's own client keeps using the saves the others get a copy of.
+		m_save_synced[save_index] = type != SAVE_TYPE_NONE && host_pid != m_pid;
+		if (!m_save_synced[save_index])
+			break;
+
+		if (type == SAVE_TYPE_RAW_MEMCARD && num_files != 1)
+		{
+			ERROR_LOG(NETPLAY, "Received an invalid list of the files of save %u", save_index);
+			AbortSaveSync(save_index);
+			break;
+		}
+
+		const std::string path = GetSyncedSavePath(save_index, type);
+		std::vector<std::pair<u32, u32>> blocks;
+		u32 num_blocks_total = 0;
+		for (u32 i = 0; i < num_files; ++i)
+		{
+			SyncedFile file;
+			u32 size = 0;
+			packet >> file.name >> size;
+			if (!packet || (type != SAVE_TYPE_RAW_MEMCARD && !IsValidSaveFileName(file.name)))
+			{
+				ERROR_LOG(NETPLAY, "Received an invalid list of the files of save %u", save_index);
+				AbortSaveSync(save_index);
+				break;
+			}
+
+			File::IOFile local(type == SAVE_TYPE_RAW_MEMCARD ? path : path + DIR_SEP + file.name, "rb");
+			if (local)
+			{
+				file.data.resize((size_t)local.GetSize());
+				if (!local.ReadBytes(file.data.data(), file.data.size()))
+					file.data.clear();
+			}
+			file.modified = !local || file.data.size() != size;
+			file.data.resize(size, 0xFF);
+
+			const u32 num_blocks = (size + SAVE_SYNC_BLOCK_SIZE - 1) / SAVE_SYNC_BLOCK_SIZE;
+			for (u32 block = 0; block < num_blocks; ++block)
+			{
+				u32 low = 0, high = 0;
+				packet >> low >> high;
+				if (((u64)high << 32 | low) != NetPlay::HashSaveBlock(file.data, block))
+					blocks.emplace_back(i, block);
+			}
+			num_blocks_total += num_blocks;
+			sync.files.push_back(std::move(file));
+		}
+		if (!m_save_synced[save_index])
+			break;
+
+		sync.blocks_total = sync.blocks_left = (u32)blocks.size();
+		INFO_LOG(NETPLAY, "Save %u: %u of %u blocks in %u files differ from the host's",
+		         save_index, sync.blocks_total, num_blocks_total, num_files);
+
+		sf::Packet spac;
+		spac << (MessageId)NP_MSG_SAVE_REQUEST;
+		spac << save_index;
+		spac << (u32)blocks.size();
+		for (const auto& file_block : blocks)
+			spac << file_block.first << file_block.second;
+		Send(spac);
+
+		m_dialog->OnSaveSyncProgress(save_index, 0, sync.blocks_total);
+		if (!sync.blocks_left)
+			FinishSaveSync(save_index);
+	}
+	break;
+
+	case NP_MSG_SAVE_DATA:
+	{
+		u8 save_index = 0;
+		packet >> save_index;
+		if (save_index >= NUM_SAVE_SYNCS)
+			break;
+
+		std::lock_guard<std::recursive_mutex> lkg(m_crit.game);
+		SaveSync& sync = m_save_sync[save_index];
+		std::vector<u8> compressed;
+		while (!packet.endOfPacket() && sync.blocks_left)
+		{
+			u32 file_index = 0, block = 0, compressed_size = 0;
+			packet >> file_index >> block >> compressed_size;
+			compressed.resize(compressed_size);
+			for (u8& byte : compressed)
+				packet >> byte;
+
+			std::vector<u8>* data = packet && file_index < sync.files.size() ? &sync.files[file_index].data : nullptr;
+			const size_t offset = (size_t)block * SAVE_SYNC_BLOCK_SIZE;
+			const uLongf expected_size = data && offset < data->size() ?
+				(uLongf)std::min<size_t>(SAVE_SYNC_BLOCK_SIZE, data->size() - offset) : 0;
+			uLongf size = expected_size;
+			if (!expected_size || uncompress(&(*data)[offset], &size, compressed.data(), compressed_size) != Z_OK ||
+			    size != expected_size)
+			{
+				// The game can't start before all blocks are there, so give up on
+				// the host's save rather than waiting for it forever.
+				ERROR_LOG(NETPLAY, "Received a corrupted block %u of file %u of save %u", block, file_index, save_index);
+				AbortSaveSync(save_index);
+				break;
+			}
+
+			sync.files[file_index].modified = true;
+			--sync.blocks_left;
+		}
+
+		m_dialog->OnSaveSyncProgress(save_index, sync.blocks_total - sync.blocks_left, sync.blocks_total);
+		if (!sync.blocks_left)
+			FinishSaveSync(save_index);
 	}
 	break;
 
@@ -413,6 +726,7 @@ unsigned int NetPlayClient::OnData(sf::Packet& packet)
 		PanicAlertT("Other client disconnected while game is running!! NetPlay is disabled. You must manually stop the game.");
 		std::lock_guard<std::recursive_mutex> lkg(m_crit.game);
 		m_is_running = false;
+		StopWaitingForInput();
 		NetPlay_Disable();
 	}
 	break;
@@ -420,7 +734,17 @@ unsigned int NetPlayClient::OnData(sf::Packet& packet)
 	case NP_MSG_PING:
 	{
 		u32 ping_key = 0;
-		packet >> ping_key;
+		u32 server_time = 0;
+		packet >> ping_key >> server_time;
+
+		// The ping took half of our round trip to arrive.
+		u32 half_ping_us;
+		{
+			std::lock_guard<std::recursive_mutex> lkp(m_crit.players);
+			half_ping_us = m_local_player ? m_local_player->ping * 500 : 0;
+		}
+		m_server_time_offset = server_time + half_ping_us - (u32)Common::Timer::GetTimeUs();
+		m_server_time_known = true;
 
 		sf::Packet spac;
 		spac << (MessageId)NP_MSG_PONG;
@@ -454,6 +778,70 @@ unsigned int NetPlayClient::OnData(sf::Packet& packet)
 	return 0;
 }
 
+// called from ---NETPLAY--- thread
+// Writes the save once all differing blocks have arrived, and starts the game
+// if it was waiting for them.
+void NetPlayClient::FinishSaveSync(int save_index)
+{
+	SaveSync& sync = m_save_sync[save_index];
+	if (m_save_synced[save_index])
+	{
+		const std::string path = GetSyncedSavePath(save_index, sync.type);
+		bool success = true;
+		if (sync.type == SAVE_TYPE_RAW_MEMCARD)
+		{
+			if (sync.files[0].modified)
+				success = WriteSaveFile(path, sync.files[0].data);
+		}
+		else
+		{
+			// The directory holds exactly the host's files.
+			std::set<std::string> names;
+			success = File::CreateFullPath(path + DIR_SEP);
+			for (const SyncedFile& file : sync.files)
+			{
+				names.insert(file.name);
+				const std::string file_path = path + DIR_SEP + file.name;
+				if (success && file.modified)
+					success = File::CreateFullPath(file_path) && WriteSaveFile(file_path, file.data);
+			}
+
+			File::FSTEntry directory;
+			File::ScanDirectoryTree(path, directory);
+			DeleteOtherSaveFiles(directory, "", names);
+		}
+
+		if (!success)
+		{
+			PanicAlertT("Failed to write %s, the local save will be used instead.", path.c_str());
+			m_save_synced[save_index] = false;
+		}
+	}
+	sync.files.clear();
+	sync.files.shrink_to_fit();
+
+	if (m_start_game_deferred && std::none_of(std::begin(m_save_sync), std::end(m_save_sync),
+	                                          [](const SaveSync& s) { return s.blocks_left != 0; }))
+	{
+		m_start_game_deferred = false;
+		m_dialog->OnMsgStartGame();
+	}
+}
+
+// called from ---NETPLAY--- thread
+// Uses the local save if the host's can't be received.
+void NetPlayClient::AbortSaveSync(int save_index)
+{
+	if (save_index == SAVE_SYNC_WII)
+		PanicAlertT("Failed to receive the Wii save from the host, the local one will be used instead.");
+	else
+		PanicAlertT("Failed to receive memory card %c from the host, the local one will be used instead.", 'A' + save_index);
+
+	m_save_synced[save_index] = false;
+	m_save_sync[save_index].blocks_left = 0;
+	FinishSaveSync(save_index);
+}
+
 void NetPlayClient::Send(sf::Packet& packet)
 {
 	ENetPacket* epac = enet_packet_create(packet.getData(), packet.getDataSize(), ENET_PACKET_FLAG_RELIABLE);
@@ -526,6 +914,7 @@ void NetPlayClient::ThreadFunc()
 				break;
 			case ENET_EVENT_TYPE_DISCONNECT:
 				m_is_running = false;
+				StopWaitingForInput();
 				NetPlay_Disable();
 				m_dialog->AppendChat("< LOST CONNECTION TO SERVER >");
 				PanicAlertT("Lost connection to server!");
@@ -571,7 +960,13 @@ void NetPlayClient::GetPlayerList(std::string& list, std::vector<int>& pid_list)
 			else
 				ss << '-';
 		}
-		ss << " |\nPing: " << player->ping << "ms\n\n";
+		ss << " |\nPing: " << player->ping << "ms";
+		if (player->input_latency.count)
+		{
+			ss << ", input: " << (player->input_latency.GetAverageUs() + 500) / 1000 << "ms avg, "
+			   << player->input_latency.GetPercentileMs(95) << "ms 95%";
+		}
+		ss << "\n\n";
 		pid_list.push_back(player->pid);
 	}
 
@@ -603,30 +998,398 @@ void NetPlayClient::SendChatMessage(const std::string& msg)
 }
 
 // called from ---CPU--- thread
-void NetPlayClient::SendPadState(const PadMapping in_game_pad, const GCPadStatus& pad)
+void NetPlayClient::QueuePadState(const PadMapping in_game_pad, const GCPadStatus& pad)
 {
+	if (m_pending_pad_states.empty())
+		m_pending_pad_time = GetNetTimeUs();
+	m_pending_pad_states.emplace_back(in_game_pad, pad);
+}
+
+// called from ---CPU--- thread
+// Sends all the queued pad states in a single packet.
+void NetPlayClient::SendPadStates()
+{
+	if (m_pending_pad_states.empty())
+		return;
+
 	sf::Packet* spac = new sf::Packet;
-	*spac << (MessageId)NP_MSG_PAD_DATA;
-	*spac << in_game_pad;
-	*spac << pad.button << pad.analogA << pad.analogB << pad.stickX << pad.stickY << pad.substickX << pad.substickY << pad.triggerLeft << pad.triggerRight;
+	if (m_rollback_active)
+	{
+		// the states are all for the frame being polled
+		*spac << (MessageId)NP_MSG_ROLLBACK_PAD_DATA;
+		*spac << m_pending_pad_time;
+		*spac << m_frame;
+	}
+	else
+	{
+		*spac << (MessageId)NP_MSG_PAD_DATA;
+		*spac << m_pending_pad_time;
+	}
+	for (const auto& state : m_pending_pad_states)
+	{
+		const GCPadStatus& pad = state.second;
+		*spac << state.first;
+		*spac << pad.button << pad.analogA << pad.analogB << pad.stickX << pad.stickY << pad.substickX << pad.substickY << pad.triggerLeft << pad.triggerRight;
+	}
+	m_pending_pad_states.clear();
 
 	SendAsync(spac);
 }
 
 // called from ---CPU--- thread
-void NetPlayClient::SendWiimoteState(const PadMapping in_game_pad, const NetWiimote& nw)
+void NetPlayClient::SendWiimoteStates(const PadMapping in_game_pad, const std::vector<NetWiimote>& states)
 {
 	sf::Packet* spac = new sf::Packet;
 	*spac << (MessageId)NP_MSG_WIIMOTE_DATA;
+	*spac << GetNetTimeUs();
 	*spac << in_game_pad;
-	*spac << (u8)nw.size();
-	for (auto it : nw)
+	for (const NetWiimote& nw : states)
 	{
-		*spac << it;
+		*spac << (u8)nw.size();
+		for (auto it : nw)
+		{
+			*spac << it;
+		}
 	}
 	SendAsync(spac);
 }
 
+// Wakes up the CPU thread if it's waiting for input, after m_is_running has
+// been cleared.
+void NetPlayClient::StopWaitingForInput()
+{
+	m_input_event.Set();
+}
+
+// The time on the server's clock, which input packets are timestamped with.
+// 0 if we haven't been pinged yet.
+u32 NetPlayClient::GetNetTimeUs() const
+{
+	if (!m_server_time_known)
+		return 0;
+	return std::max<u32>((u32)Common::Timer::GetTimeUs() + m_server_time_offset, 1);
+}
+
+// called from ---NETPLAY--- thread
+void NetPlayClient::AddInputLatency(PlayerId pid, u32 timestamp)
+{
+	u32 now = GetNetTimeUs();
+	if (!now || !timestamp)
+		return;
+
+	// The clocks can be off by a bit, which may make the latency negative.
+	s32 latency = (s32)(now - timestamp);
+
+	std::lock_guard<std::recursive_mutex> lkp(m_crit.players);
+	auto it = m_players.find(pid);
+	if (it != m_players.end())
+		it->second.input_latency.Add(std::max(latency, 0));
+}
+
+static bool SamePadStatus(const GCPadStatus& a, const GCPadStatus& b)
+{
+	return a.button == b.button && a.analogA == b.analogA && a.analogB == b.analogB &&
+	       a.stickX == b.stickX && a.stickY == b.stickY && a.substickX == b.substickX &&
+	       a.substickY == b.substickY && a.triggerLeft == b.triggerLeft && a.triggerRight == b.triggerRight;
+}
+
+// called from ---GUI--- thread
+void NetPlayClient::StartRollback()
+{
+	std::lock_guard<std::recursive_mutex> lkr(m_crit.rollback);
+
+	m_rollback_active = m_rollback_frames;
+	if (m_rollback_active && SConfig::GetInstance().m_LocalCoreStartupParameter.bWii)
+	{
+		WARN_LOG(NETPLAY, "Rollback isn't supported for Wii games, using delay-based input");
+		m_rollback_active = 0;
+	}
+
+	for (auto& pad_inputs : m_rollback_inputs)
+	{
+		for (RollbackInput& input : pad_inputs)
+		{
+			input.frame = UINT32_MAX;
+			input.confirmed = false;
+			input.used = false;
+		}
+	}
+	// Until we hear from the other players, predict that they don't touch
+	// their controllers.
+	GCPadStatus neutral = {};
+	neutral.stickX = GCPadStatus::MAIN_STICK_CENTER_X;
+	neutral.stickY = GCPadStatus::MAIN_STICK_CENTER_Y;
+	neutral.substickX = GCPadStatus::C_STICK_CENTER_X;
+	neutral.substickY = GCPadStatus::C_STICK_CENTER_Y;
+	for (unsigned int i = 0; i < 4; ++i)
+	{
+		m_confirmed_frames[i] = 0;
+		m_last_confirmed[i] = neutral;
+	}
+	m_frame = 0;
+	m_polled_pads = 0;
+	m_rollback_to = UINT32_MAX;
+	m_resimulate_until = 0;
+	m_next_sequence = 0;
+	m_num_rollbacks = 0;
+	m_num_resimulated_frames = 0;
+
+	if (!m_rollback_active)
+	{
+		m_rollback_states.clear();
+		return;
+	}
+
+	// A state is saved once the pads of a frame have been polled, so rolling
+	// back to a frame needs the one from the frame before it.
+	m_rollback_states.resize(m_rollback_active + 1);
+	for (RollbackState& state : m_rollback_states)
+		state.sequence = 0;
+
+	// CoreTiming forgets the event types when the last game shut down.
+	m_rollback_event_type = -1;
+	m_rollback_running = true;
+
+	INFO_LOG(NETPLAY, "Rolling back up to %u frames", m_rollback_active);
+}
+
+// called from ---GUI--- thread
+void NetPlayClient::StopRollback()
+{
+	std::lock_guard<std::recursive_mutex> lkr(m_crit.rollback);
+	if (!m_rollback_running)
+		return;
+	m_rollback_running = false;
+
+	if (m_resimulate_until)
+		Core::SetIsFramelimiterTempDisabled(false);
+
+	std::ostringstream ss;
+	ss << " -- ROLLED BACK " << m_num_rollbacks << " TIMES, " << m_num_resimulated_frames << " FRAMES -- ";
+	m_dialog->AppendChat(ss.str());
+}
+
+// called from ---NETPLAY--- thread and ---CPU--- thread
+// Stores the input a player had in a frame, and checks it against what the
+// game was given if the frame has been run already.
+void NetPlayClient::ConfirmInput(const PadMapping in_game_pad, u32 frame, const GCPadStatus& pad)
+{
+	std::lock_guard<std::recursive_mutex> lkr(m_crit.rollback);
+
+	RollbackInput& input = m_rollback_inputs[in_game_pad][frame % ROLLBACK_HISTORY];
+	if (input.frame != frame)
+	{
+		input.frame = frame;
+		input.used = false;
+	}
+	input.confirmed = true;
+	input.status = pad;
+
+	m_confirmed_frames[in_game_pad] = frame + 1;
+	m_last_confirmed[in_game_pad] = pad;
+
+	if (input.used && !SamePadStatus(input.used_status, pad) && frame < m_rollback_to)
+		m_rollback_to = frame;
+}
+
+// called from ---CPU--- thread
+bool NetPlayClient::GetRollbackPads(const u8 pad_nb, const u8 in_game_num, GCPadStatus* pad_status)
+{
+	std::unique_lock<std::recursive_mutex> lkr(m_crit.rollback);
+
+	// A frame ends when the game polls a pad a second time.
+	if (m_polled_pads & (1 << pad_nb))
+	{
+		SendPadStates();
+		++m_frame;
+		m_polled_pads = 0;
+
+		if (m_resimulate_until && m_frame >= m_resimulate_until)
+		{
+			m_resimulate_until = 0;
+			Core::SetIsFramelimiterTempDisabled(false);
+		}
+
+		ScheduleRollbackEvent();
+	}
+	else if (m_frame == 0 && !m_polled_pads)
+	{
+		// keep the state of the first frame too, to roll the next one back to
+		ScheduleRollbackEvent();
+	}
+	m_polled_pads |= 1 << pad_nb;
+
+	// Our input for this frame, unless we are running it again after a
+	// rollback, in which case the other players have the original input.
+	if (in_game_num < 4)
+	{
+		if (m_confirmed_frames[in_game_num] <= m_frame)
+		{
+			ConfirmInput(in_game_num, m_frame, *pad_status);
+			QueuePadState(in_game_num, *pad_status);
+		}
+
+		// The local pads are polled in order, so the states of all of them
+		// go out together once the last one has been polled.
+		if (LocalPadToInGamePad(pad_nb + 1) >= 4)
+			SendPadStates();
+	}
+
+	// Don't get further ahead of the other players than we can roll back, and
+	// don't predict the first frame, as there's no state to roll back to.
+	while (m_frame >= m_confirmed_frames[pad_nb] + m_rollback_active ||
+	       (m_frame == 0 && !m_confirmed_frames[pad_nb]))
+	{
+		if (!m_is_running)
+			return false;
+
+		// Other clients may be waiting for our states too.
+		SendPadStates();
+
+		lkr.unlock();
+		m_input_event.Wait();
+		lkr.lock();
+	}
+
+	RollbackInput& input = m_rollback_inputs[pad_nb][m_frame % ROLLBACK_HISTORY];
+	if (input.frame != m_frame)
+	{
+		input.frame = m_frame;
+		input.confirmed = false;
+	}
+
+	// Predict that the input hasn't changed since the last one received.
+	*pad_status = input.confirmed ? input.status : m_last_confirmed[pad_nb];
+	input.used = true;
+	input.used_status = *pad_status;
+
+	return true;
+}
+
+// called from ---CPU--- thread
+void NetPlayClient::ScheduleRollbackEvent()
+{
+	if (m_rollback_event_type < 0)
+		m_rollback_event_type = CoreTiming::RegisterEvent("NetPlayRollback", RollbackCallback);
+
+	// Runs right after the SI event that is polling the pads, between two
+	// blocks, where the CPU state can be saved and loaded.
+	CoreTiming::ScheduleEvent(0, m_rollback_event_type);
+}
+
+// called from ---CPU--- thread
+void NetPlayClient::RollbackCallback(u64 userdata, int cycles_late)
+{
+	std::lock_guard<std::mutex> lk(crit_netplay_client);
+	if (netplay_client)
+		netplay_client->OnRollbackEvent();
+}
+
+// called from ---CPU--- thread
+// A frame has started and all of its pads have been polled. Either the game
+// goes back to before a wrong prediction, or the state is kept to be able to.
+void NetPlayClient::OnRollbackEvent()
+{
+	std::lock_guard<std::recursive_mutex> lkr(m_crit.rollback);
+	if (!m_rollback_active)
+		return;
+
+	if (m_rollback_to != UINT32_MAX)
+		LoadRollbackState();
+	else
+		SaveRollbackState();
+}
+
+u32 NetPlayClient::GetRollbackFrame()
+{
+	std::lock_guard<std::recursive_mutex> lkr(m_crit.rollback);
+	return m_frame;
+}
+
+// called from ---CPU--- thread
+void NetPlayClient::SaveRollbackBuffer(std::vector<u8>& buffer)
+{
+	::State::SaveToBufferOnCPUThread(buffer);
+}
+
+// called from ---CPU--- thread
+void NetPlayClient::LoadRollbackBuffer(std::vector<u8>& buffer)
+{
+	::State::LoadFromBufferOnCPUThread(buffer);
+}
+
+// called from ---CPU--- thread
+void NetPlayClient::SaveRollbackState()
+{
+	// Replace the oldest state.
+	RollbackState* oldest = &m_rollback_states[0];
+	for (RollbackState& state : m_rollback_states)
+	{
+		if (state.sequence < oldest->sequence)
+			oldest = &state;
+	}
+
+	SaveRollbackBuffer(oldest->buffer);
+	oldest->sequence = ++m_next_sequence;
+	oldest->frame = m_frame;
+	oldest->polled_pads = m_polled_pads;
+}
+
+// called from ---CPU--- thread
+void NetPlayClient::LoadRollbackState()
+{
+	const u32 target = m_rollback_to;
+	m_rollback_to = UINT32_MAX;
+
+	// The newest state from before the game was given the wrong input.
+	RollbackState* best = nullptr;
+	for (RollbackState& state : m_rollback_states)
+	{
+		if (!state.sequence)
+			continue;
+		if (state.frame >= target)
+			continue;
+		if (!best || state.sequence > best->sequence)
+			best = &state;
+	}
+
+	if (!best)
+	{
+		ERROR_LOG(NETPLAY, "No state to roll back to frame %u from frame %u, the game may desync", target, m_frame);
+		return;
+	}
+
+	LoadRollbackBuffer(best->buffer);
+
+	// The states saved after it are from the run with the wrong input.
+	for (RollbackState& state : m_rollback_states)
+	{
+		if (state.sequence > best->sequence)
+			state.sequence = 0;
+	}
+
+	// So are the predictions used after it. Input confirmed for those frames
+	// before they are run again mustn't roll the game back a second time.
+	for (auto& pad_inputs : m_rollback_inputs)
+	{
+		for (RollbackInput& input : pad_inputs)
+		{
+			if (input.frame > best->frame)
+				input.used = false;
+		}
+	}
+
+	DEBUG_LOG(NETPLAY, "Rolled back from frame %u to %u", m_frame, best->frame);
+	++m_num_rollbacks;
+	m_num_resimulated_frames += m_frame - best->frame;
+	m_resimulate_until = std::max(m_resimulate_until, m_frame);
+	m_frame = best->frame;
+	m_polled_pads = best->polled_pads;
+
+	// Catch up as fast as possible.
+	Core::SetIsFramelimiterTempDisabled(true);
+}
+
 // called from ---GUI--- thread
 bool NetPlayClient::StartGame(const std::string &path)
 {
@@ -650,6 +1413,9 @@ bool NetPlayClient::StartGame(const std::string &path)
 	NetPlay_Enable(this);
 
 	ClearBuffers();
+	m_pending_pad_states.clear();
+	m_input_event.Reset();
+	StartRollback();
 
 	if (m_dialog->IsRecording())
 	{
@@ -803,33 +1569,49 @@ bool NetPlayClient::GetNetPads(const u8 pad_nb, GCPadStatus* pad_status)
 
 	int in_game_num = LocalPadToInGamePad(pad_nb);
 
-	// If this in-game pad is one of ours, then update from the
-	// information given.
-	if (in_game_num < 4)
+	if (m_rollback_active)
 	{
-		// adjust the buffer either up or down
-		// inserting multiple padstates or dropping states
-		while (m_pad_buffer[in_game_num].Size() <= m_target_buffer_size)
+		if (!GetRollbackPads(pad_nb, in_game_num, pad_status))
+			return false;
+	}
+	else
+	{
+		// If this in-game pad is one of ours, then update from the
+		// information given.
+		if (in_game_num < 4)
 		{
-			// add to buffer
-			m_pad_buffer[in_game_num].Push(*pad_status);
+			// adjust the buffer either up or down
+			// inserting multiple padstates or dropping states
+			while (m_pad_buffer[in_game_num].Size() <= m_target_buffer_size)
+			{
+				// add to buffer
+				m_pad_buffer[in_game_num].Push(*pad_status);
+
+				// queue for sending
+				QueuePadState(in_game_num, *pad_status);
+			}
 
-			// send
-			SendPadState(in_game_num, *pad_status);
+			// The local pads are polled in order, so the states of all of them
+			// go out together once the last one has been polled.
+			if (LocalPadToInGamePad(pad_nb + 1) >= 4)
+				SendPadStates();
 		}
-	}
 
-	// Now, we need to swap out the local value with the values
-	// retrieved from NetPlay. This could be the value we pushed
-	// above if we're configured as P1 and the code is trying
-	// to retrieve data for slot 1.
-	while (!m_pad_buffer[pad_nb].Pop(*pad_status))
-	{
-		if (!m_is_running)
-			return false;
+		// Now, we need to swap out the local value with the values
+		// retrieved from NetPlay. This could be the value we pushed
+		// above if we're configured as P1 and the code is trying
+		// to retrieve data for slot 1.
+		while (!m_pad_buffer[pad_nb].Pop(*pad_status))
+		{
+			if (!m_is_running)
+				return false;
 
-		// TODO: use a condition instead of sleeping
-		Common::SleepCurrentThread(1);
+			// Other clients may be waiting for our states too.
+			SendPadStates();
+
+			// wait for the receiving thread to push some data
+			m_input_event.Wait();
+		}
 	}
 
 	if (Movie::IsRecordingInput())
@@ -862,13 +1644,16 @@ bool NetPlayClient::WiimoteUpdate(int _number, u8* data, const u8 size)
 			if (previousSize[in_game_num] == size)
 			{
 				nw.assign(data, data + size);
+				std::vector<NetWiimote> states;
 				do
 				{
 					// add to buffer
 					m_wiimote_buffer[in_game_num].Push(nw);
 
-					SendWiimoteState(in_game_num, nw);
+					states.push_back(nw);
 				} while (m_wiimote_buffer[in_game_num].Size() <= m_target_buffer_size * 200 / 120); // TODO: add a seperate setting for wiimote buffer?
+
+				SendWiimoteStates(in_game_num, states);
 			}
 			else
 			{
@@ -893,10 +1678,11 @@ bool NetPlayClient::WiimoteUpdate(int _number, u8* data, const u8 size)
 
 	while (previousSize[_number] == size && !m_wiimote_buffer[_number].Pop(nw))
 	{
-		// wait for receiving thread to push some data
-		Common::SleepCurrentThread(1);
 		if (false == m_is_running)
 			return false;
+
+		// wait for receiving thread to push some data
+		m_input_event.Wait();
 	}
 
 	// Use a blank input, since we may not have any valid input.
@@ -919,9 +1705,9 @@ bool NetPlayClient::WiimoteUpdate(int _number, u8* data, const u8 size)
 		{
 			while (!m_wiimote_buffer[_number].Pop(nw))
 			{
-				Common::SleepCurrentThread(1);
 				if (false == m_is_running)
 					return false;
+				m_input_event.Wait();
 			}
 			++tries;
 			if (tries > m_target_buffer_size * 200 / 120)
@@ -954,8 +1740,19 @@ bool NetPlayClient::StopGame()
 
 	m_dialog->AppendChat(" -- STOPPING GAME -- ");
 
+	{
+		std::lock_guard<std::recursive_mutex> lkp(m_crit.players);
+		for (const auto& player : m_players)
+		{
+			if (player.second.input_latency.count)
+				INFO_LOG(NETPLAY, "Input latency from %s: %s", player.second.name.c_str(), player.second.input_latency.ToString().c_str());
+		}
+	}
+
 	m_is_running = false;
+	StopWaitingForInput();
 	NetPlay_Disable();
+	StopRollback();
 
 	// stop game
 	m_dialog->StopGame();
@@ -1048,6 +1845,33 @@ u8 NetPlayClient::LocalWiimoteToInGameWiimote(u8 local_pad)
 	return ingame_pad;
 }
 
+PlayerId NetPlayClient::GetLocalPlayerId() const
+{
+	return m_pid;
+}
+
+// called from ---CPU--- thread
+std::string NetPlayClient::GetMemcardPath(int card_index)
+{
+	std::lock_guard<std::recursive_mutex> lkg(m_crit.game);
+	if (card_index < 0 || card_index >= 2 || !m_save_synced[card_index])
+		return "";
+	return GetSyncedSavePath(card_index, m_save_sync[card_index].type);
+}
+
+// called from ---CPU--- thread
+bool NetPlayClient::GetWiiSaveRedirect(std::string* nand_path, std::string* host_path)
+{
+	std::lock_guard<std::recursive_mutex> lkg(m_crit.game);
+	if (!m_save_synced[SAVE_SYNC_WII])
+		return false;
+
+	const u64 title_id = m_save_sync[SAVE_SYNC_WII].title_id;
+	*nand_path = StringFromFormat("/title/%08x/%08x/data", (u32)(title_id >> 32), (u32)title_id);
+	*host_path = GetSyncedSavePath(SAVE_SYNC_WII, SAVE_TYPE_WII);
+	return true;
+}
+
 // stuff hacked into dolphin
 
 // called from ---CPU--- thread
@@ -1096,11 +1920,41 @@ u8 CSIDevice_GCController::NetPlay_InGamePadToLocalPad(u8 numPAD)
 		return numPAD;
 }
 
+// called from ---CPU--- thread
+// so all players' games use the same memory card
+std::string CEXIMemoryCard::NetPlay_GetMemcardPath(int card_index)
+{
+	std::lock_guard<std::mutex> lk(crit_netplay_client);
+
+	if (netplay_client)
+		return netplay_client->GetMemcardPath(card_index);
+	else
+		return "";
+}
+
+// called from ---CPU--- thread
+// so all players' Wii games use the same save
+bool NetPlay::GetWiiSaveRedirect(std::string* nand_path, std::string* host_path)
+{
+	std::lock_guard<std::mutex> lk(crit_netplay_client);
+
+	return netplay_client && netplay_client->GetWiiSaveRedirect(nand_path, host_path);
+}
+
 bool NetPlay::IsNetPlayRunning()
 {
 	return netplay_client != nullptr;
 }
 
+u64 NetPlay::HashSaveBlock(const std::vector<u8>& file, u32 block)
+{
+	const size_t offset = (size_t)block * SAVE_SYNC_BLOCK_SIZE;
+	if (offset >= file.size())
+		return 0;
+	const u32 size = (u32)std::min<size_t>(SAVE_SYNC_BLOCK_SIZE, file.size() - offset);
+	return GetMurmurHash3(&file[offset], size, 0);
+}
+
 void NetPlay_Enable(NetPlayClient* const np)
 {
 	std::lock_guard<std::mutex> lk(crit_netplay_client);
@@ -4,11 +4,15 @@
 
 #pragma once
 
+#include <atomic>
 #include <map>
 #include <queue>
 #include <sstream>
+#include <utility>
+#include <vector>
 #include <SFML/Network/Packet.hpp>
 #include "Common/CommonTypes.h"
+#include "Common/Event.h"
 #include "Common/FifoQueue.h"
 #include "Common/Thread.h"
 #include "Common/TraversalClient.h"
@@ -31,15 +35,47 @@ public:
 	virtual void OnMsgStartGame() = 0;
 	virtual void OnMsgStopGame() = 0;
 	virtual bool IsRecording() = 0;
+
+	// Called as the blocks of a save that differ from the host's arrive.
+	virtual void OnSaveSyncProgress(int save_index, u32 blocks_done, u32 blocks_total) = 0;
+};
+
+// How long input took from being polled on one client to being received by
+// another. Bucket 0 counts latencies under 1ms, bucket i those from 2^(i-1) up
+// to 2^i ms, and the last one everything above.
+class LatencyHistogram
+{
+public:
+	enum { NUM_BUCKETS = 11 };
+
+	LatencyHistogram() { Reset(); }
+
+	void Reset();
+	void Add(u32 latency_us);
+
+	u32 GetAverageUs() const { return count ? (u32)(total_us / count) : 0; }
+	// The latency that the given percentage of inputs were received within,
+	// rounded up to the end of its bucket.
+	u32 GetPercentileMs(u32 percent) const;
+	std::string ToString() const;
+
+	u32 buckets[NUM_BUCKETS];
+	u32 count;
+	u64 total_us;
+	u32 max_us;
 };
 
 class Player
 {
 public:
+	Player() : pid(0), ping(0) {}
+
 	PlayerId    pid;
 	std::string name;
 	std::string revision;
 	u32         ping;
+	// latency of the inputs received from this player in the current game
+	LatencyHistogram input_latency;
 };
 
 class NetPlayClient : public TraversalClientClient
@@ -75,6 +111,15 @@ public:
 
 	u8 LocalWiimoteToInGameWiimote(u8 local_pad);
 
+	PlayerId GetLocalPlayerId() const;
+
+	// The copy of the host's memory card or GCI folder the game uses, empty to
+	// use the local one.
+	std::string GetMemcardPath(int card_index);
+	// The NAND path of the Wii game's data directory and the copy of the host's
+	// save that replaces it, false to use the local save.
+	bool GetWiiSaveRedirect(std::string* nand_path, std::string* host_path);
+
 	enum State
 	{
 		WaitingForTraversalClientConnection,
@@ -94,6 +139,7 @@ protected:
 		// lock order
 		std::recursive_mutex players;
 		std::recursive_mutex async_queue_write;
+		std::recursive_mutex rollback;
 	} m_crit;
 
 	Common::FifoQueue<std::unique_ptr<sf::Packet>, false> m_async_queue;
@@ -101,6 +147,10 @@ protected:
 	Common::FifoQueue<GCPadStatus> m_pad_buffer[4];
 	Common::FifoQueue<NetWiimote>  m_wiimote_buffer[4];
 
+	// Set when input is received or the game stops, so that the CPU thread
+	// doesn't need to poll the buffers.
+	Common::Event m_input_event;
+
 	NetPlayUI*   m_dialog;
 
 	ENetHost*    m_client;
@@ -112,6 +162,8 @@ protected:
 	volatile bool m_do_loop;
 
 	unsigned int  m_target_buffer_size;
+	// frames that can be rolled back in the next game, 0 for delay-based input
+	unsigned int  m_rollback_frames;
 
 	Player* m_local_player;
 
@@ -122,10 +174,33 @@ protected:
 
 	bool m_is_recording;
 
+	// Rollback states are saved and loaded on the CPU thread, in an event
+	// scheduled when a frame starts, which runs once SI has polled the pads.
+	// Virtual so that tests can drive the rollback without an emulated game.
+	virtual void ScheduleRollbackEvent();
+	virtual void SaveRollbackBuffer(std::vector<u8>& buffer);
+	virtual void LoadRollbackBuffer(std::vector<u8>& buffer);
+	void OnRollbackEvent();
+	// The frame the CPU thread is polling the pads for.
+	u32 GetRollbackFrame();
+
 private:
 	void UpdateDevices();
-	void SendPadState(const PadMapping in_game_pad, const GCPadStatus& np);
-	void SendWiimoteState(const PadMapping in_game_pad, const NetWiimote& nw);
+	void QueuePadState(const PadMapping in_game_pad, const GCPadStatus& np);
+	void SendPadStates();
+	void SendWiimoteStates(const PadMapping in_game_pad, const std::vector<NetWiimote>& states);
+	void StopWaitingForInput();
+	bool GetRollbackPads(const u8 pad_nb, const u8 in_game_num, GCPadStatus* pad_status);
+	void ConfirmInput(const PadMapping in_game_pad, u32 frame, const GCPadStatus& pad);
+	void StartRollback();
+	void StopRollback();
+	static void RollbackCallback(u64 userdata, int cycles_late);
+	void SaveRollbackState();
+	void LoadRollbackState();
+	void FinishSaveSync(int save_index);
+	void AbortSaveSync(int save_index);
+	u32 GetNetTimeUs() const;
+	void AddInputLatency(PlayerId pid, u32 timestamp);
 	unsigned int OnData(sf::Packet& packet);
 	void Send(sf::Packet& packet);
 	void Disconnect();
@@ -139,6 +214,85 @@ private:
 	std::string m_player_name;
 	bool m_connecting;
 	TraversalClient* m_traversal_client;
+
+	// Pad states polled on the CPU thread that haven't been sent yet, and the
+	// time the first of them was polled at.
+	std::vector<std::pair<PadMapping, GCPadStatus>> m_pending_pad_states;
+	u32 m_pending_pad_time;
+
+	// Difference between the server's clock and ours, so that timestamps in
+	// input packets from other clients can be compared with the local time.
+	// Wraps around like the timestamps themselves. Only known once the server
+	// has pinged us.
+	std::atomic<u32> m_server_time_offset;
+	std::atomic<bool> m_server_time_known;
+
+	// Rollback mode: the game gets the local input right away, and the last
+	// input received for the other players. A savestate is kept for each
+	// recent frame, and when a prediction turns out to be wrong, the state from
+	// before it is loaded and the frames since are run again with the input
+	// received in the meantime. Only used for GameCube games.
+	// Protected by m_crit.rollback.
+	enum { ROLLBACK_HISTORY = 4 * MAX_ROLLBACK_FRAMES };
+	struct RollbackInput
+	{
+		u32 frame;
+		bool confirmed;
+		bool used;
+		GCPadStatus status;
+		GCPadStatus used_status;
+	};
+	struct RollbackState
+	{
+		std::vector<u8> buffer;
+		u64 sequence;
+		u32 frame;
+		u8 polled_pads;
+	};
+	// frames that can be rolled back in the current game, 0 when not in rollback mode
+	unsigned int m_rollback_active;
+	RollbackInput m_rollback_inputs[4][ROLLBACK_HISTORY];
+	// frame after the last one with confirmed input, and its input
+	u32 m_confirmed_frames[4];
+	GCPadStatus m_last_confirmed[4];
+	// the frame the CPU thread is polling the pads for, and the in-game pads
+	// it has polled in it
+	u32 m_frame;
+	u8 m_polled_pads;
+	// the first frame that was run with a wrong prediction
+	u32 m_rollback_to;
+	// frames before this are being run again after a rollback
+	u32 m_resimulate_until;
+	u64 m_next_sequence;
+	std::vector<RollbackState> m_rollback_states;
+	u32 m_num_rollbacks;
+	u32 m_num_resimulated_frames;
+	// set from StartRollback until StopRollback has reported the statistics
+	bool m_rollback_running;
+	// CoreTiming event type, registered by the CPU thread in each game
+	int m_rollback_event_type;
+
+	// Memory cards and Wii saves are synced with the host's before each game.
+	// Only the blocks that differ are transferred, into a copy kept next to the
+	// local ones. Protected by m_crit.game.
+	struct SyncedFile
+	{
+		std::string name;
+		std::vector<u8> data;
+		bool modified;
+	};
+	struct SaveSync
+	{
+		u8 type;
+		u64 title_id;
+		std::vector<SyncedFile> files;
+		u32 blocks_total;
+		u32 blocks_left;
+	};
+	SaveSync m_save_sync[NUM_SAVE_SYNCS];
+	bool m_save_synced[NUM_SAVE_SYNCS];
+	// START_GAME arrived while blocks were still being transferred
+	bool m_start_game_deferred;
 };
 
 void NetPlay_Enable(NetPlayClient* const np);
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <string>
 #include <vector>
 #include "Common/CommonTypes.h"
 #include "Core/HW/EXI_Device.h"
@@ -29,7 +30,7 @@ struct Rpt : public std::vector<u8>
 
 typedef std::vector<u8> NetWiimote;
 
-#define NETPLAY_VERSION  "Dolphin NetPlay 2014-01-08"
+#define NETPLAY_VERSION  "Dolphin NetPlay 2015-10-24"
 
 extern u64 g_netplay_initial_gctime;
 
@@ -41,10 +42,17 @@ enum
 
 	NP_MSG_CHAT_MESSAGE = 0x30,
 
+	// u32 send time in server clock us (0 if unknown), then
+	// (PadMapping, GCPadStatus) pairs until the end of the packet
 	NP_MSG_PAD_DATA = 0x60,
 	NP_MSG_PAD_MAPPING = 0x61,
 	NP_MSG_PAD_BUFFER = 0x62,
+	// u32 number of frames that can be rolled back, 0 for delay-based input
+	NP_MSG_ROLLBACK = 0x63,
+	// u32 send time, u32 frame, then (PadMapping, GCPadStatus) pairs
+	NP_MSG_ROLLBACK_PAD_DATA = 0x64,
 
+	// u32 send time, PadMapping, then (u8 size, data) until the end
 	NP_MSG_WIIMOTE_DATA = 0x70,
 	NP_MSG_WIIMOTE_MAPPING = 0x71,
 
@@ -53,14 +61,59 @@ enum
 	NP_MSG_STOP_GAME = 0xA2,
 	NP_MSG_DISABLE_GAME = 0xA3,
 
+	// u8 save index, PlayerId of the host's own client (which keeps using its
+	// own saves), u8 save type, u64 title ID of a Wii save, u32 file count, then
+	// for each file its name, u32 size and the u64 hash of each block as two u32s
+	NP_MSG_SAVE_HASHES = 0xB0,
+	// u8 save index, u32 count, then the u32 file and u32 block index of each
+	// block that differs
+	NP_MSG_SAVE_REQUEST = 0xB1,
+	// u8 save index, then (u32 file index, u32 block index, u32 size, zlib data)
+	// until the end
+	NP_MSG_SAVE_DATA = 0xB2,
+
 	NP_MSG_READY = 0xD0,
 	NP_MSG_NOT_READY = 0xD1,
 
+	// u32 ping key, u32 server clock in us
 	NP_MSG_PING = 0xE0,
 	NP_MSG_PONG = 0xE1,
 	NP_MSG_PLAYER_PING_DATA = 0xE2,
 };
 
+// Each frame that can be rolled back keeps a savestate in memory.
+enum
+{
+	MAX_ROLLBACK_FRAMES = 10
+};
+
+// Memory cards and Wii saves are compared and transferred in blocks of this
+// size before a game starts.
+enum
+{
+	SAVE_SYNC_BLOCK_SIZE = 0x2000,
+	SAVE_SYNC_BLOCKS_PER_PACKET = 8
+};
+
+// The saves that are synced, the save index of NP_MSG_SAVE_* messages
+enum
+{
+	SAVE_SYNC_MEMCARD_A = 0,
+	SAVE_SYNC_MEMCARD_B = 1,
+	SAVE_SYNC_WII = 2,
+	NUM_SAVE_SYNCS
+};
+
+// What a synced save is made of: a raw memory card is a single file without
+// a name, a GCI folder and a Wii save are the files in a directory.
+enum
+{
+	SAVE_TYPE_NONE = 0,
+	SAVE_TYPE_RAW_MEMCARD = 1,
+	SAVE_TYPE_GCI_FOLDER = 2,
+	SAVE_TYPE_WII = 3
+};
+
 typedef u8  MessageId;
 typedef u8  PlayerId;
 typedef s8  PadMapping;
@@ -76,4 +129,10 @@ enum
 namespace NetPlay
 {
 	bool IsNetPlayRunning();
+	// Hash of a block of a save file for NP_MSG_SAVE_HASHES, the same on every host.
+	u64 HashSaveBlock(const std::vector<u8>& file, u32 block);
+	// The NAND path of the data directory of the Wii game a client is running
+	// and the copy of the host's save that replaces it, false if the local
+	// save is used.
+	bool GetWiiSaveRedirect(std::string* nand_path, std::string* host_path);
 }
@@ -2,15 +2,23 @@
 // Licensed under GPLv2
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <string>
 #include <vector>
+#include <zlib.h>
 #include "Common/ENetUtil.h"
+#include "Common/FileUtil.h"
 #include "Common/IniFile.h"
+#include "Common/NandPaths.h"
 #include "Common/StdMakeUnique.h"
 #include "Common/StringUtil.h"
+#include "Core/ConfigManager.h"
 #include "Core/NetPlayClient.h" //for NetPlayUI
 #include "Core/NetPlayServer.h"
 #include "Core/HW/EXI_DeviceIPL.h"
+#include "Core/HW/EXI_DeviceMemoryCard.h"
+#include "DiscIO/Volume.h"
+#include "DiscIO/VolumeCreator.h"
 #include "InputCommon/GCPadStatus.h"
 #if !defined(_WIN32)
 #include <sys/types.h>
@@ -60,6 +68,8 @@ NetPlayServer::NetPlayServer(const u16 port, bool traversal, std::string central
 	, m_update_pings(false)
 	, m_current_game(0)
 	, m_target_buffer_size(0)
+	, m_rollback_frames(0)
+	, m_host_pid(0)
 	, m_selected_game("")
 	, m_server(nullptr)
 	, m_traversal_client(nullptr)
@@ -118,6 +128,7 @@ void NetPlayServer::ThreadFunc()
 			sf::Packet spac;
 			spac << (MessageId)NP_MSG_PING;
 			spac << m_ping_key;
+			spac << (u32)Common::Timer::GetTimeUs();
 
 			m_ping_timer.Start();
 			SendToClients(spac);
@@ -304,6 +315,11 @@ unsigned int NetPlayServer::OnConnect(ENetPeer* socket)
 	spac << (u32)m_target_buffer_size;
 	Send(player.socket, spac);
 
+	spac.clear();
+	spac << (MessageId)NP_MSG_ROLLBACK;
+	spac << (u32)m_rollback_frames;
+	Send(player.socket, spac);
+
 	// sync values with new client
 	for (const auto& p : m_players)
 	{
@@ -451,6 +467,21 @@ void NetPlayServer::AdjustPadBufferSize(unsigned int size)
 	SendAsyncToClients(spac);
 }
 
+// called from ---GUI--- thread
+void NetPlayServer::SetRollbackFrames(unsigned int frames)
+{
+	std::lock_guard<std::recursive_mutex> lkg(m_crit.game);
+
+	m_rollback_frames = std::min<unsigned int>(frames, MAX_ROLLBACK_FRAMES);
+
+	// clients switch modes when the next game starts
+	sf::Packet* spac = new sf::Packet;
+	*spac << (MessageId)NP_MSG_ROLLBACK;
+	*spac << (u32)m_rollback_frames;
+
+	SendAsyncToClients(spac);
+}
+
 void NetPlayServer::SendAsyncToClients(sf::Packet* packet)
 {
 	{
@@ -487,26 +518,35 @@ unsigned int NetPlayServer::OnData(sf::Packet& packet, Client& player)
 	break;
 
 	case NP_MSG_PAD_DATA:
+	case NP_MSG_ROLLBACK_PAD_DATA:
 	{
 		// if this is pad data from the last game still being received, ignore it
 		if (player.current_game != m_current_game)
 			break;
 
-		PadMapping map = 0;
-		GCPadStatus pad;
-		packet >> map >> pad.button >> pad.analogA >> pad.analogB >> pad.stickX >> pad.stickY >> pad.substickX >> pad.substickY >> pad.triggerLeft >> pad.triggerRight;
+		u32 timestamp;
+		packet >> timestamp;
+		if (mid == NP_MSG_ROLLBACK_PAD_DATA)
+		{
+			u32 frame;
+			packet >> frame;
+		}
 
-		// If the data is not from the correct player,
-		// then disconnect them.
-		if (m_pad_map[map] != player.pid)
-			return 1;
+		// A packet holds several pad states, which may be for different pads.
+		while (!packet.endOfPacket())
+		{
+			PadMapping map = 0;
+			GCPadStatus pad;
+			packet >> map >> pad.button >> pad.analogA >> pad.analogB >> pad.stickX >> pad.stickY >> pad.substickX >> pad.substickY >> pad.triggerLeft >> pad.triggerRight;
+
+			// If the data is not from the correct player,
+			// then disconnect them.
+			if (!packet || map < 0 || map >= 4 || m_pad_map[map] != player.pid)
+				return 1;
+		}
 
 		// Relay to clients
-		sf::Packet spac;
-		spac << (MessageId)NP_MSG_PAD_DATA;
-		spac << map << pad.button << pad.analogA << pad.analogB << pad.stickX << pad.stickY << pad.substickX << pad.substickY << pad.triggerLeft << pad.triggerRight;
-
-		SendToClients(spac, player.pid);
+		SendToClients(packet, player.pid);
 	}
 	break;
 
@@ -516,29 +556,32 @@ unsigned int NetPlayServer::OnData(sf::Packet& packet, Client& player)
 		if (player.current_game != m_current_game)
 			break;
 
+		u32 timestamp;
 		PadMapping map = 0;
-		u8 size;
-		packet >> map >> size;
-		std::vector<u8> data(size);
-		for (size_t i = 0; i < data.size(); ++i)
-			packet >> data[i];
+		packet >> timestamp >> map;
 
 		// If the data is not from the correct player,
 		// then disconnect them.
-		if (m_wiimote_map[map] != player.pid)
+		if (!packet || map < 0 || map >= 4 || m_wiimote_map[map] != player.pid)
 		{
 			return 1;
 		}
 
-		// relay to clients
-		sf::Packet spac;
-		spac << (MessageId)NP_MSG_WIIMOTE_DATA;
-		spac << map;
-		spac << size;
-		for (const u8& byte : data)
-			spac << byte;
+		while (!packet.endOfPacket())
+		{
+			u8 size;
+			packet >> size;
+			for (unsigned int i = 0; i < size; ++i)
+			{
+				u8 byte;
+				packet >> byte;
+			}
+			if (!packet)
+				return 1;
+		}
 
-		SendToClients(spac, player.pid);
+		// relay to clients
+		SendToClients(packet, player.pid);
 	}
 	break;
 
@@ -568,6 +611,31 @@ unsigned int NetPlayServer::OnData(sf::Packet& packet, Client& player)
 	}
 	break;
 
+	case NP_MSG_SAVE_REQUEST:
+	{
+		u8 save_index = 0;
+		u32 count = 0;
+		packet >> save_index >> count;
+		if (!packet || save_index >= NUM_SAVE_SYNCS)
+			return 1;
+
+		std::lock_guard<std::recursive_mutex> lkg(m_crit.game);
+		const std::vector<SaveFile>& files = m_save_files[save_index];
+		std::vector<std::pair<u32, u32>> blocks;
+		for (u32 i = 0; i < count; ++i)
+		{
+			u32 file = 0, block = 0;
+			packet >> file >> block;
+			if (!packet || file >= files.size() ||
+			    block >= (files[file].data.size() + SAVE_SYNC_BLOCK_SIZE - 1) / SAVE_SYNC_BLOCK_SIZE)
+				return 1;
+			blocks.emplace_back(file, block);
+		}
+
+		SendSaveBlocks(player, save_index, blocks);
+	}
+	break;
+
 	case NP_MSG_STOP_GAME:
 	{
 		// tell clients to stop game
@@ -633,13 +701,15 @@ void NetPlayServer::SetNetSettings(const NetSettings &settings)
 }
 
 // called from ---GUI--- thread
-bool NetPlayServer::StartGame()
+bool NetPlayServer::StartGame(const std::string& game_path)
 {
 	std::lock_guard<std::recursive_mutex> lkg(m_crit.game);
 	m_current_game = Common::Timer::GetTimeMs();
 
 	// no change, just update with clients
 	AdjustPadBufferSize(m_target_buffer_size);
+	SetRollbackFrames(m_rollback_frames);
+	SendSaveHashes(game_path);
 
 	g_netplay_initial_gctime = Common::Timer::GetLocalTimeSinceJan1970();
 
@@ -666,6 +736,162 @@ bool NetPlayServer::StartGame()
 	return true;
 }
 
+// Lists the files in a directory of a save, and in its subdirectories, by
+// their names relative to the save's directory and their paths.
+static void ListSaveFiles(const File::FSTEntry& directory, const std::string& prefix, const std::string& extension,
+                          std::vector<std::pair<std::string, std::string>>& files)
+{
+	for (const File::FSTEntry& entry : directory.children)
+	{
+		if (entry.isDirectory)
+		{
+			ListSaveFiles(entry, prefix + entry.virtualName + "/", extension, files);
+			continue;
+		}
+
+		std::string entry_extension;
+		SplitPath(entry.virtualName, nullptr, nullptr, &entry_extension);
+		if (extension.empty() || !strcasecmp(entry_extension.c_str(), extension.c_str()))
+			files.emplace_back(prefix + entry.virtualName, entry.physicalName);
+	}
+}
+
+static bool ReadSaveFile(const std::string& path, std::vector<u8>& data)
+{
+	File::IOFile file(path, "rb");
+	if (!file)
+		return false;
+	data.resize((size_t)file.GetSize());
+	return file.ReadBytes(data.data(), data.size());
+}
+
+// called from ---GUI--- thread
+// Every client gets the hash of each block of each file of the host's saves
+// that the game can use, and requests the blocks that differ from its own copy
+// before starting the game.
+void NetPlayServer::SendSaveHashes(const std::string& game_path)
+{
+	std::unique_ptr<DiscIO::IVolume> volume(DiscIO::CreateVolumeFromFilename(game_path));
+
+	for (u8 i = 0; i < NUM_SAVE_SYNCS; ++i)
+	{
+		std::vector<SaveFile>& files = m_save_files[i];
+		files.clear();
+
+		u8 type = SAVE_TYPE_NONE;
+		u64 title_id = 0;
+		std::vector<std::pair<std::string, std::string>> paths;
+		if (i == SAVE_SYNC_WII)
+		{
+			if (volume && (volume->IsWiiDisc() || volume->IsWadFile()) && volume->GetTitleID((u8*)&title_id))
+			{
+				// A title without a save yet is synced too, as having none.
+				title_id = Common::swap64(title_id);
+				type = SAVE_TYPE_WII;
+				File::FSTEntry directory;
+				File::ScanDirectoryTree(Common::GetTitleDataPath(title_id), directory);
+				ListSaveFiles(directory, "", "", paths);
+			}
+		}
+		else if (m_settings.m_EXIDevice[i] == EXIDEVICE_MEMORYCARD)
+		{
+			const std::string path = CEXIMemoryCard::GetRawMemcardPathForGame(i, game_path);
+			if (File::Exists(path))
+			{
+				type = SAVE_TYPE_RAW_MEMCARD;
+				paths.emplace_back("", path);
+			}
+		}
+		else if (m_settings.m_EXIDevice[i] == EXIDEVICE_MEMORYCARDFOLDER)
+		{
+			type = SAVE_TYPE_GCI_FOLDER;
+			File::FSTEntry directory;
+			File::ScanDirectoryTree(CEXIMemoryCard::GetGciFolderPathForGame(i, game_path), directory);
+			ListSaveFiles(directory, "", ".gci", paths);
+		}
+
+		for (const auto& path : paths)
+		{
+			SaveFile file;
+			file.name = path.first;
+			if (ReadSaveFile(path.second, file.data))
+				files.push_back(std::move(file));
+			else
+				ERROR_LOG(NETPLAY, "Failed to read %s, it won't be synced", path.second.c_str());
+		}
+		// A raw card that can't be read isn't synced at all.
+		if (type == SAVE_TYPE_RAW_MEMCARD && files.empty())
+			type = SAVE_TYPE_NONE;
+
+		sf::Packet* spac = new sf::Packet;
+		*spac << (MessageId)NP_MSG_SAVE_HASHES;
+		*spac << i;
+		*spac << m_host_pid;
+		*spac << type;
+		*spac << (u32)title_id;
+		*spac << (u32)(title_id >> 32);
+		*spac << (u32)files.size();
+		for (const SaveFile& file : files)
+		{
+			*spac << file.name;
+			*spac << (u32)file.data.size();
+			const u32 num_blocks = (u32)((file.data.size() + SAVE_SYNC_BLOCK_SIZE - 1) / SAVE_SYNC_BLOCK_SIZE);
+			for (u32 block = 0; block < num_blocks; ++block)
+			{
+				const u64 hash = NetPlay::HashSaveBlock(file.data, block);
+				*spac << (u32)hash;
+				*spac << (u32)(hash >> 32);
+			}
+		}
+
+		SendAsyncToClients(spac);
+	}
+}
+
+// called from ---NETPLAY--- thread
+void NetPlayServer::SendSaveBlocks(Client& player, u8 save_index, const std::vector<std::pair<u32, u32>>& blocks)
+{
+	const std::vector<SaveFile>& files = m_save_files[save_index];
+	std::vector<u8> compressed(compressBound(SAVE_SYNC_BLOCK_SIZE));
+
+	sf::Packet spac;
+	u32 blocks_in_packet = 0;
+	for (const auto& file_block : blocks)
+	{
+		if (blocks_in_packet == 0)
+		{
+			spac << (MessageId)NP_MSG_SAVE_DATA;
+			spac << save_index;
+		}
+
+		const std::vector<u8>& data = files[file_block.first].data;
+		const u32 block = file_block.second;
+		const size_t offset = (size_t)block * SAVE_SYNC_BLOCK_SIZE;
+		const uLong size = (uLong)std::min<size_t>(SAVE_SYNC_BLOCK_SIZE, data.size() - offset);
+		uLongf compressed_size = (uLongf)compressed.size();
+		if (compress2(compressed.data(), &compressed_size, &data[offset], size, Z_BEST_SPEED) != Z_OK)
+		{
+			ERROR_LOG(NETPLAY, "Failed to compress block %u of %s", block, files[file_block.first].name.c_str());
+			compressed_size = 0;
+		}
+
+		spac << file_block.first;
+		spac << block;
+		spac << (u32)compressed_size;
+		spac.append(compressed.data(), compressed_size);
+
+		if (++blocks_in_packet == SAVE_SYNC_BLOCKS_PER_PACKET)
+		{
+			Send(player.socket, spac);
+			spac.clear();
+			blocks_in_packet = 0;
+		}
+	}
+
+	if (blocks_in_packet)
+		Send(player.socket, spac);
+}
+
 // called from multiple threads
 void NetPlayServer::SendToClients(sf::Packet& packet, const PlayerId skip_pid)
 {
@@ -696,6 +922,13 @@ void NetPlayServer::KickPlayer(PlayerId player)
 	}
 }
 
+// called from ---GUI--- thread
+void NetPlayServer::SetHostPlayer(PlayerId player)
+{
+	std::lock_guard<std::recursive_mutex> lkg(m_crit.game);
+	m_host_pid = player;
+}
+
 u16 NetPlayServer::GetPort()
 {
 	return m_server->address.port;
@@ -30,7 +30,8 @@ public:
 
 	void SetNetSettings(const NetSettings &settings);
 
-	bool StartGame();
+	// game_path is the host's copy of the game, which its memory cards depend on.
+	bool StartGame(const std::string& game_path);
 
 	void GetPadMapping(PadMapping map[]);
 	void SetPadMapping(const PadMapping map[]);
@@ -39,9 +40,14 @@ public:
 	void SetWiimoteMapping(const PadMapping map[]);
 
 	void AdjustPadBufferSize(unsigned int size);
+	// Switches to rollback mode for the next game, 0 for delay-based input.
+	void SetRollbackFrames(unsigned int frames);
 
 	void KickPlayer(PlayerId player);
 
+	// The host's own client, which keeps using the saves the others get a copy of.
+	void SetHostPlayer(PlayerId player);
+
 	u16 GetPort();
 
 	void SetNetPlayUI(NetPlayUI* dialog);
@@ -82,6 +88,8 @@ private:
 	virtual void OnConnectFailed(u8 reason) {}
 	void UpdatePadMapping();
 	void UpdateWiimoteMapping();
+	void SendSaveHashes(const std::string& game_path);
+	void SendSaveBlocks(Client& player, u8 save_index, const std::vector<std::pair<u32, u32>>& blocks);
 	std::vector<std::pair<std::string, std::string>> GetInterfaceListInternal();
 
 	NetSettings     m_settings;
@@ -93,11 +101,22 @@ private:
 	bool            m_update_pings;
 	u32             m_current_game;
 	unsigned int    m_target_buffer_size;
+	unsigned int    m_rollback_frames;
 	PadMapping      m_pad_map[4];
 	PadMapping      m_wiimote_map[4];
 
 	std::map<PlayerId, Client> m_players;
 
+	PlayerId        m_host_pid;
+
+	// the files of the host's saves as of the last StartGame, empty if not synced
+	struct SaveFile
+	{
+		std::string name;
+		std::vector<u8> data;
+	};
+	std::vector<SaveFile> m_save_files[NUM_SAVE_SYNCS];
+
 	struct
 	{
 		std::recursive_mutex game;
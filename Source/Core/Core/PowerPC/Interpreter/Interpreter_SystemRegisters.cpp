@@ -170,6 +170,7 @@ static void SetSR(int index, u32 value)
 {
 	DEBUG_LOG(POWERPC, "%08x: MMU: Segment register %i set to %08x", PowerPC::ppcState.pc, index, value);
 	PowerPC::ppcState.sr[index] = value;
+	PowerPC::InvalidateHostTLB();
 }
 
 void Interpreter::mtsr(UGeckoInstruction _inst)
@@ -349,6 +350,17 @@ void Interpreter::mtspr(UGeckoInstruction _inst)
 		PowerPC::SDRUpdated();
 		break;
 
+	case SPR_DBAT0U: case SPR_DBAT0L:
+	case SPR_DBAT1U: case SPR_DBAT1L:
+	case SPR_DBAT2U: case SPR_DBAT2L:
+	case SPR_DBAT3U: case SPR_DBAT3L:
+	case SPR_DBAT4U: case SPR_DBAT4L:
+	case SPR_DBAT5U: case SPR_DBAT5L:
+	case SPR_DBAT6U: case SPR_DBAT6L:
+	case SPR_DBAT7U: case SPR_DBAT7L:
+		PowerPC::InvalidateHostTLB();
+		break;
+
 	case SPR_XER:
 		SetXER(rSPR(iIndex));
 		break;
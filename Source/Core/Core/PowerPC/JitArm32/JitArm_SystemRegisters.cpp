@@ -5,6 +5,7 @@
 #include "Common/ArmEmitter.h"
 #include "Common/CommonTypes.h"
 
+#include "Core/ConfigManager.h"
 #include "Core/Core.h"
 #include "Core/CoreTiming.h"
 #include "Core/PowerPC/PowerPC.h"
@@ -162,6 +163,8 @@ void JitArm::mtsr(UGeckoInstruction inst)
 {
 	INSTRUCTION_START
 	JITDISABLE(bJITSystemRegistersOff);
+	// The interpreter keeps the host TLB coherent with the segment registers.
+	FALLBACK_IF(SConfig::GetInstance().m_LocalCoreStartupParameter.bMMU);
 
 	STR(gpr.R(inst.RS), R9, PPCSTATE_OFF(sr[inst.SR]));
 }
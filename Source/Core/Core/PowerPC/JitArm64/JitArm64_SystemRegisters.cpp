@@ -5,6 +5,7 @@
 #include "Common/Arm64Emitter.h"
 #include "Common/Common.h"
 
+#include "Core/ConfigManager.h"
 #include "Core/Core.h"
 #include "Core/CoreTiming.h"
 #include "Core/PowerPC/PowerPC.h"
@@ -97,6 +98,8 @@ void JitArm64::mtsr(UGeckoInstruction inst)
 {
 	INSTRUCTION_START
 	JITDISABLE(bJITSystemRegistersOff);
+	// The interpreter keeps the host TLB coherent with the segment registers.
+	FALLBACK_IF(SConfig::GetInstance().m_LocalCoreStartupParameter.bMMU);
 
 	gpr.BindToRegister(inst.RS, true);
 	STR(INDEX_UNSIGNED, gpr.R(inst.RS), X29, PPCSTATE_OFF(sr[inst.SR]));
@@ -125,6 +128,8 @@ void JitArm64::mtsrin(UGeckoInstruction inst)
 {
 	INSTRUCTION_START
 	JITDISABLE(bJITSystemRegistersOff);
+	// The interpreter keeps the host TLB coherent with the segment registers.
+	FALLBACK_IF(SConfig::GetInstance().m_LocalCoreStartupParameter.bMMU);
 
 	u32 b = inst.RB, d = inst.RD;
 	gpr.BindToRegister(d, d == b);
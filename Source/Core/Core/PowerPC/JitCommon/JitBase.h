@@ -63,7 +63,7 @@ protected:
 		bool accurateSinglePrecision;
 		bool fastmem;
 		bool memcheck;
-		bool alwaysUseMemFuncs;
+		bool checkWatchedPages;
 	};
 	struct JitState
 	{
@@ -239,38 +239,58 @@ FixupBranch EmuCodeBlock::CheckIfSafeAddress(OpArg reg_value, X64Reg reg_addr, B
 	if (reg_value.IsSimpleReg())
 		registers_in_use[reg_value.GetSimpleReg()] = true;
 
+	// On Gamecube games with MMU, do a little bit of extra work to make sure we're not accessing the
+	// 0x81800000 to 0x83FFFFFF range.
+	// It's okay to take a shortcut and not check this range on non-MMU games, since we're already
+	// assuming they'll never do an invalid memory access.
+	// The slightly more complex check needed for Wii games using the space just above MEM1 isn't
+	// implemented here yet, since there are no known working Wii MMU games to test it with.
+	bool check_mem1 = jit->jo.memcheck && !SConfig::GetInstance().m_LocalCoreStartupParameter.bWii;
+	bool check_pages = jit->jo.checkWatchedPages;
+	if (!check_mem1 && !check_pages)
+	{
+		TEST(32, R(reg_addr), Imm32(mem_mask));
+		return J_CC(CC_NZ, farcode.Enabled());
+	}
+
 	// Get ourselves a free register; try to pick one that doesn't involve pushing, if we can.
 	X64Reg scratch = RSCRATCH;
+	bool spill = false;
 	if (!registers_in_use[RSCRATCH])
 		scratch = RSCRATCH;
 	else if (!registers_in_use[RSCRATCH_EXTRA])
 		scratch = RSCRATCH_EXTRA;
 	else
-		scratch = reg_addr;
+	{
+		scratch = reg_addr == RSCRATCH ? RSCRATCH_EXTRA : RSCRATCH;
+		spill = true;
+	}
 
-	// On Gamecube games with MMU, do a little bit of extra work to make sure we're not accessing the
-	// 0x81800000 to 0x83FFFFFF range.
-	// It's okay to take a shortcut and not check this range on non-MMU games, since we're already
-	// assuming they'll never do an invalid memory access.
-	// The slightly more complex check needed for Wii games using the space just above MEM1 isn't
-	// implemented here yet, since there are no known working Wii MMU games to test it with.
-	if (jit->jo.memcheck && !SConfig::GetInstance().m_LocalCoreStartupParameter.bWii)
+	if (spill)
+		PUSH(scratch);
+	MOV(32, R(scratch), R(reg_addr));
+	if (check_pages)
+	{
+		// Only accesses to pages with memory checks on them have to go through
+		// the memory functions. Make the address all ones for those, which
+		// fails both checks below.
+		SHR(32, R(scratch), Imm8(MemChecks::PAGE_SHIFT));
+		BT(32, M(PowerPC::memchecks.GetWatchedPages()), R(scratch));
+		SBB(32, R(scratch), R(scratch));
+		OR(32, R(scratch), R(reg_addr));
+	}
+	if (check_mem1)
 	{
-		if (scratch == reg_addr)
-			PUSH(scratch);
-		else
-			MOV(32, R(scratch), R(reg_addr));
 		AND(32, R(scratch), Imm32(0x3FFFFFFF));
 		CMP(32, R(scratch), Imm32(0x01800000));
-		if (scratch == reg_addr)
-			POP(scratch);
-		return J_CC(CC_AE, farcode.Enabled());
 	}
 	else
 	{
-		TEST(32, R(reg_addr), Imm32(mem_mask));
-		return J_CC(CC_NZ, farcode.Enabled());
+		TEST(32, R(scratch), Imm32(mem_mask));
 	}
+	if (spill)
+		POP(scratch);
+	return J_CC(check_mem1 ? CC_AE : CC_NZ, farcode.Enabled());
 }
 
 void EmuCodeBlock::SafeLoadToReg(X64Reg reg_value, const Gen::OpArg & opAddress, int accessSize, s32 offset, BitSet32 registersInUse, bool signExtend, int flags)
@@ -346,16 +366,13 @@ void EmuCodeBlock::SafeLoadToReg(X64Reg reg_value, const Gen::OpArg & opAddress,
 	}
 
 	FixupBranch exit;
-	if (!jit->jo.alwaysUseMemFuncs)
-	{
-		FixupBranch slow = CheckIfSafeAddress(R(reg_value), reg_addr, registersInUse, mem_mask);
-		UnsafeLoadToReg(reg_value, R(reg_addr), accessSize, 0, signExtend);
-		if (farcode.Enabled())
-			SwitchToFarCode();
-		else
-			exit = J(true);
-		SetJumpTarget(slow);
-	}
+	FixupBranch slow = CheckIfSafeAddress(R(reg_value), reg_addr, registersInUse, mem_mask);
+	UnsafeLoadToReg(reg_value, R(reg_addr), accessSize, 0, signExtend);
+	if (farcode.Enabled())
+		SwitchToFarCode();
+	else
+		exit = J(true);
+	SetJumpTarget(slow);
 	size_t rsp_alignment = (flags & SAFE_LOADSTORE_NO_PROLOG) ? 8 : 0;
 	ABI_PushRegistersAndAdjustStack(registersInUse, rsp_alignment);
 	switch (accessSize)
@@ -386,15 +403,12 @@ void EmuCodeBlock::SafeLoadToReg(X64Reg reg_value, const Gen::OpArg & opAddress,
 		MOVZX(64, accessSize, reg_value, R(ABI_RETURN));
 	}
 
-	if (!jit->jo.alwaysUseMemFuncs)
+	if (farcode.Enabled())
 	{
-		if (farcode.Enabled())
-		{
-			exit = J(true);
-			SwitchToNearCode();
-		}
-		SetJumpTarget(exit);
+		exit = J(true);
+		SwitchToNearCode();
 	}
+	SetJumpTarget(exit);
 }
 
 static OpArg SwapImmediate(int accessSize, OpArg reg_value)
@@ -76,6 +76,42 @@ enum XCheckTLBFlag
 };
 template <const XCheckTLBFlag flag> static u32 TranslateAddress(const u32 address);
 
+// Host-side data TLB. A direct-mapped cache from effective page to a host pointer into
+// physical memory, consulted before the emulated TLB on the MMU path. Every valid entry
+// mirrors a page held in the emulated data TLB, so whenever that TLB drops a page the
+// host entry for it has to go as well (see UpdateTLBEntry/InvalidateTLBEntry).
+#define HOST_TLB_SIZE 256
+#define HOST_TLB_MASK (HOST_TLB_SIZE - 1)
+
+enum
+{
+	HOST_TLB_READ  = 1 << 0,
+	// Only set once the C bit of the PTE is known to be set, so stores that hit the
+	// host TLB never need to touch the page table.
+	HOST_TLB_WRITE = 1 << 1,
+};
+
+struct HostTLBEntry
+{
+	u32 tag;
+	u32 flags;
+	u8* page;
+};
+
+static HostTLBEntry s_host_tlb[HOST_TLB_SIZE];
+
+template <typename T>
+__forceinline static u8* LookupHostTLB(const u32 address, const u32 required_flags)
+{
+	const u32 tag = address >> HW_PAGE_INDEX_SHIFT;
+	const HostTLBEntry& entry = s_host_tlb[tag & HOST_TLB_MASK];
+	// Accesses that straddle a page boundary always take the slow path.
+	if (entry.tag != tag || (entry.flags & required_flags) != required_flags ||
+	    (address & (HW_PAGE_SIZE - 1)) > HW_PAGE_SIZE - sizeof(T))
+		return nullptr;
+	return entry.page + (address & (HW_PAGE_SIZE - 1));
+}
+
 // Nasty but necessary. Super Mario Galaxy pointer relies on this stuff.
 static u32 EFB_Read(const u32 addr)
 {
@@ -186,7 +222,13 @@ __forceinline static T ReadFromHardware(const u32 em_address)
 		return 0;
 	}
 
-	// MMU: Do page table translation
+	// MMU: Try the host TLB before doing the full page table translation
+	if (flag == FLAG_READ || flag == FLAG_NO_EXCEPTION)
+	{
+		if (const u8* host_ptr = LookupHostTLB<T>(em_address, HOST_TLB_READ))
+			return bswap(*(const T*)host_ptr);
+	}
+
 	u32 tlb_addr = TranslateAddress<flag>(em_address);
 	if (tlb_addr == 0)
 	{
@@ -337,7 +379,16 @@ __forceinline static void WriteToHardware(u32 em_address, const T data)
 		return;
 	}
 
-	// MMU: Do page table translation
+	// MMU: Try the host TLB before doing the full page table translation
+	if (flag == FLAG_WRITE || flag == FLAG_NO_EXCEPTION)
+	{
+		if (u8* host_ptr = LookupHostTLB<T>(em_address, HOST_TLB_WRITE))
+		{
+			*(T*)host_ptr = bswap(data);
+			return;
+		}
+	}
+
 	u32 tlb_addr = TranslateAddress<flag>(em_address);
 	if (tlb_addr == 0)
 	{
@@ -453,6 +504,9 @@ u32 HostRead_Instruction(const u32 address)
 static __forceinline void Memcheck(u32 address, u32 var, bool write, int size)
 {
 #ifdef ENABLE_MEM_CHECK
+	if (!PowerPC::memchecks.IsPageWatched(address))
+		return;
+
 	TMemCheck *mc = PowerPC::memchecks.GetMemCheck(address);
 	if (mc)
 	{
@@ -648,7 +702,8 @@ std::string HostGetString(u32 address, size_t size)
 bool IsOptimizableRAMAddress(const u32 address)
 {
 #ifdef ENABLE_MEM_CHECK
-	return false;
+	if (PowerPC::memchecks.IsPageWatched(address))
+		return false;
 #endif
 
 	if (!UReg_MSR(MSR).DR)
@@ -775,7 +830,8 @@ void ClearCacheLine(const u32 address)
 u32 IsOptimizableMMIOAccess(u32 address, u32 accessSize)
 {
 #ifdef ENABLE_MEM_CHECK
-	return 0;
+	if (PowerPC::memchecks.IsPageWatched(address))
+		return 0;
 #endif
 
 	if (!UReg_MSR(MSR).DR)
@@ -794,7 +850,8 @@ u32 IsOptimizableMMIOAccess(u32 address, u32 accessSize)
 bool IsOptimizableGatherPipeWrite(u32 address)
 {
 #ifdef ENABLE_MEM_CHECK
-	return false;
+	if (PowerPC::memchecks.IsPageWatched(address))
+		return false;
 #endif
 
 	if (!UReg_MSR(MSR).DR)
@@ -948,6 +1005,7 @@ void SDRUpdated()
 	}
 	PowerPC::ppcState.pagetable_base = htaborg<<16;
 	PowerPC::ppcState.pagetable_hashmask = ((xx<<10)|0x3ff);
+	InvalidateHostTLB();
 }
 
 enum TLBLookupResult
@@ -1008,6 +1066,31 @@ static __forceinline TLBLookupResult LookupTLBPageAddress(const XCheckTLBFlag fl
 	return TLB_NOTFOUND;
 }
 
+static void InvalidateHostTLBEntry(u32 tag)
+{
+	HostTLBEntry& entry = s_host_tlb[tag & HOST_TLB_MASK];
+	if (entry.tag == tag)
+		entry.tag = TLB_TAG_INVALID;
+}
+
+static __forceinline void UpdateHostTLBEntry(const XCheckTLBFlag flag, const u32 address, const u32 translated_address)
+{
+	if (flag != FLAG_READ && flag != FLAG_WRITE)
+		return;
+
+	u32 tag = address >> HW_PAGE_INDEX_SHIFT;
+	HostTLBEntry& entry = s_host_tlb[tag & HOST_TLB_MASK];
+	entry.tag = tag;
+	entry.flags = flag == FLAG_WRITE ? (HOST_TLB_READ | HOST_TLB_WRITE) : HOST_TLB_READ;
+	entry.page = &Memory::physical_base[translated_address & ~(HW_PAGE_SIZE - 1)];
+}
+
+void InvalidateHostTLB()
+{
+	for (HostTLBEntry& entry : s_host_tlb)
+		entry.tag = TLB_TAG_INVALID;
+}
+
 static __forceinline void UpdateTLBEntry(const XCheckTLBFlag flag, UPTE2 PTE2, const u32 address)
 {
 	if (flag == FLAG_NO_EXCEPTION)
@@ -1017,6 +1100,8 @@ static __forceinline void UpdateTLBEntry(const XCheckTLBFlag flag, UPTE2 PTE2, c
 	PowerPC::tlb_entry *tlbe = &PowerPC::ppcState.tlb[flag == FLAG_OPCODE][tag & HW_PAGE_INDEX_MASK];
 	int index = tlbe->recent == 0 && tlbe->tag[0] != TLB_TAG_INVALID;
 	tlbe->recent = index;
+	if (flag != FLAG_OPCODE && tlbe->tag[index] != TLB_TAG_INVALID)
+		InvalidateHostTLBEntry(tlbe->tag[index]);
 	tlbe->paddr[index] = PTE2.RPN << HW_PAGE_INDEX_SHIFT;
 	tlbe->pte[index] = PTE2.Hex;
 	tlbe->tag[index] = tag;
@@ -1025,6 +1110,11 @@ static __forceinline void UpdateTLBEntry(const XCheckTLBFlag flag, UPTE2 PTE2, c
 void InvalidateTLBEntry(u32 address)
 {
 	PowerPC::tlb_entry *tlbe = &PowerPC::ppcState.tlb[0][(address >> HW_PAGE_INDEX_SHIFT) & HW_PAGE_INDEX_MASK];
+	for (u32 tag : tlbe->tag)
+	{
+		if (tag != TLB_TAG_INVALID)
+			InvalidateHostTLBEntry(tag);
+	}
 	tlbe->tag[0] = TLB_TAG_INVALID;
 	tlbe->tag[1] = TLB_TAG_INVALID;
 	PowerPC::tlb_entry *tlbe_i = &PowerPC::ppcState.tlb[1][(address >> HW_PAGE_INDEX_SHIFT) & HW_PAGE_INDEX_MASK];
@@ -1041,7 +1131,10 @@ static __forceinline u32 TranslatePageAddress(const u32 address, const XCheckTLB
 	u32 translatedAddress = 0;
 	TLBLookupResult res = LookupTLBPageAddress(flag , address, &translatedAddress);
 	if (res == TLB_FOUND)
+	{
+		UpdateHostTLBEntry(flag, address, translatedAddress);
 		return translatedAddress;
+	}
 
 	u32 sr = PowerPC::ppcState.sr[EA_SR(address)];
 
@@ -1088,6 +1181,7 @@ static __forceinline u32 TranslatePageAddress(const u32 address, const XCheckTLB
 				if (res != TLB_UPDATE_C)
 					UpdateTLBEntry(flag, PTE2, address);
 
+				UpdateHostTLBEntry(flag, address, (PTE2.RPN << 12) | offset);
 				return (PTE2.RPN << 12) | offset;
 			}
 		}
@@ -5,6 +5,9 @@
 #include <algorithm>
 #include <queue>
 #include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
 
 #include "Common/StringUtil.h"
 
@@ -46,7 +49,6 @@ CodeBuffer::~CodeBuffer()
 	delete[] codebuffer;
 }
 
-void AnalyzeFunction2(Symbol &func);
 u32 EvaluateBranchTarget(UGeckoInstruction instr, u32 pc);
 
 #define INVALID_TARGET ((u32)-1)
@@ -191,13 +193,13 @@ bool AnalyzeFunction(u32 startAddr, Symbol &func, int max_size)
 
 
 // Second pass analysis, done after the first pass is done for all functions
-// so we have more information to work with
-static void AnalyzeFunction2(Symbol *func)
+// so we have more information to work with. Returns the new flags.
+static u32 AnalyzeFunction2(const Symbol& func)
 {
-	u32 flags = func->flags;
+	u32 flags = func.flags;
 
 	bool nonleafcall = false;
-	for (const SCall& c : func->calls)
+	for (const SCall& c : func.calls)
 	{
 		Symbol *called_func = g_symbolDB.GetSymbolFromAddr(c.function);
 		if (called_func && (called_func->flags & FFLAG_LEAF) == 0)
@@ -210,7 +212,7 @@ static void AnalyzeFunction2(Symbol *func)
 	if (nonleafcall && !(flags & FFLAG_EVIL) && !(flags & FFLAG_RFI))
 		flags |= FFLAG_ONLYCALLSNICELEAFS;
 
-	func->flags = flags;
+	return flags;
 }
 
 static bool CanSwapAdjacentOps(const CodeOp &a, const CodeOp &b)
@@ -267,67 +269,134 @@ static bool CanSwapAdjacentOps(const CodeOp &a, const CodeOp &b)
 	return true;
 }
 
+// Splits [0, count) into contiguous parts of at least min_per_thread items
+// and runs func(begin, end) on each of them on its own thread.
+template <typename Func>
+static void RunParallel(size_t count, size_t min_per_thread, Func func)
+{
+	size_t num_threads = std::max(std::thread::hardware_concurrency(), 1u);
+	num_threads = std::min(num_threads, std::max<size_t>(count / min_per_thread, 1));
+	if (num_threads == 1)
+	{
+		func(0, count);
+		return;
+	}
+
+	size_t per_thread = (count + num_threads - 1) / num_threads;
+	std::vector<std::thread> threads;
+	for (size_t begin = per_thread; begin < count; begin += per_thread)
+		threads.emplace_back(func, begin, std::min(begin + per_thread, count));
+	func(0, per_thread);
+	for (std::thread& thread : threads)
+		thread.join();
+}
+
+// Analyzes the functions at the given addresses on several threads. The
+// results are in the same order as the addresses, and are duds (analyzed == 0)
+// where there is no valid function. Addresses of 0 are skipped.
+static std::vector<Symbol> AnalyzeFunctions(const std::vector<u32>& addresses)
+{
+	std::vector<Symbol> funcs(addresses.size());
+	RunParallel(addresses.size(), 64, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i)
+		{
+			if (addresses[i])
+				AnalyzeFunction(addresses[i], funcs[i]);
+		}
+	});
+	return funcs;
+}
+
 // Most functions that are relevant to analyze should be
 // called by another function. Therefore, let's scan the
 // entire space for bl operations and find what functions
 // get called.
-static void FindFunctionsFromBranches(u32 startAddr, u32 endAddr, SymbolDB *func_db)
+static void FindFunctionsFromBranches(u32 startAddr, u32 endAddr, PPCSymbolDB *func_db)
 {
-	for (u32 addr = startAddr; addr < endAddr; addr+=4)
-	{
-		UGeckoInstruction instr = (UGeckoInstruction)PowerPC::HostRead_U32(addr);
-
-		if (PPCTables::IsValidInstruction(instr))
+	// The scan is split in chunks whose results are merged in address order,
+	// so the functions are added in the same order as by a single thread.
+	const u32 chunk_size = 0x10000;
+	u32 num_chunks = (endAddr - startAddr + chunk_size - 1) / chunk_size;
+	std::vector<std::vector<u32>> chunk_targets(num_chunks);
+	RunParallel(num_chunks, 1, [&](size_t begin, size_t end) {
+		for (size_t chunk = begin; chunk < end; ++chunk)
 		{
-			switch (instr.OPCD)
+			u32 chunk_start = startAddr + (u32)chunk * chunk_size;
+			u32 chunk_end = std::min(chunk_start + chunk_size, endAddr);
+			for (u32 addr = chunk_start; addr < chunk_end; addr += 4)
 			{
-			case 18://branch instruction
+				UGeckoInstruction instr = (UGeckoInstruction)PowerPC::HostRead_U32(addr);
+
+				if (instr.OPCD == 18 && instr.LK && PPCTables::IsValidInstruction(instr)) //bl
 				{
-					if (instr.LK) //bl
-					{
-						u32 target = SignExt26(instr.LI << 2);
-						if (!instr.AA)
-							target += addr;
-						if (PowerPC::HostIsRAMAddress(target))
-						{
-							func_db->AddFunction(target);
-						}
-					}
+					u32 target = SignExt26(instr.LI << 2);
+					if (!instr.AA)
+						target += addr;
+					chunk_targets[chunk].push_back(target);
 				}
-				break;
-			default:
-				break;
 			}
 		}
+	});
+
+	std::vector<u32> targets;
+	std::unordered_set<u32> seen;
+	for (const std::vector<u32>& chunk : chunk_targets)
+	{
+		for (u32 target : chunk)
+		{
+			if (target < 0x80000010 || !seen.insert(target).second)
+				continue;
+			if (PowerPC::HostIsRAMAddress(target) && !func_db->Symbols().count(target))
+				targets.push_back(target);
+		}
+	}
+
+	std::vector<Symbol> funcs = AnalyzeFunctions(targets);
+	for (const Symbol& func : funcs)
+	{
+		if (func.analyzed)
+			func_db->AddAnalyzedFunction(func);
 	}
 }
 
+// Finds functions that directly follow known ones. All the chains of
+// functions are followed one step at a time, analyzing the next function of
+// each chain in parallel. A chain ends at the first address that isn't a new
+// function.
 static void FindFunctionsAfterBLR(PPCSymbolDB *func_db)
 {
-	std::vector<u32> funcAddrs;
+	std::vector<u32> locations;
 
 	for (const auto& func : func_db->Symbols())
-		funcAddrs.push_back(func.second.address + func.second.size);
+		locations.push_back(func.second.address + func.second.size);
 
-	for (u32& location : funcAddrs)
+	while (!locations.empty())
 	{
-		while (true)
-		{
-			// skip zeroes that sometimes pad function to 16 byte boundary (e.g. Donkey Kong Country Returns)
-			while (PowerPC::HostRead_Instruction(location) == 0 && ((location & 0xf) != 0))
-				location += 4;
-			if (PPCTables::IsValidInstruction(PowerPC::HostRead_Instruction(location)))
+		std::vector<u32> candidates(locations.size(), 0);
+		RunParallel(locations.size(), 64, [&](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; ++i)
 			{
-				//check if this function is already mapped
-				Symbol *f = func_db->AddFunction(location);
-				if (!f)
-					break;
-				else
-					location += f->size;
+				u32 location = locations[i];
+				// skip zeroes that sometimes pad function to 16 byte boundary (e.g. Donkey Kong Country Returns)
+				while (PowerPC::HostRead_Instruction(location) == 0 && ((location & 0xf) != 0))
+					location += 4;
+				if (location >= 0x80000010 && PPCTables::IsValidInstruction(PowerPC::HostRead_Instruction(location)) &&
+				    !func_db->Symbols().count(location))
+					candidates[i] = location;
 			}
-			else
-				break;
+		});
+
+		std::vector<Symbol> funcs = AnalyzeFunctions(candidates);
+
+		std::vector<u32> next_locations;
+		for (const Symbol& func : funcs)
+		{
+			//check if this function is already mapped
+			Symbol *f = func.analyzed ? func_db->AddAnalyzedFunction(func) : nullptr;
+			if (f)
+				next_locations.push_back(f->address + f->size);
 		}
+		locations.swap(next_locations);
 	}
 }
 
@@ -340,18 +409,30 @@ void FindFunctions(u32 startAddr, u32 endAddr, PPCSymbolDB *func_db)
 	//Step 2:
 	func_db->FillInCallers();
 
+	// The second pass only reads other functions' leaf flags, which it doesn't
+	// change, so it can run in parallel as long as the flags are stored after.
+	std::vector<Symbol*> symbols;
+	for (auto& func : func_db->AccessSymbols())
+		symbols.push_back(&func.second);
+	g_symbolDB.PrepareLookups();
+	std::vector<u32> new_flags(symbols.size());
+	RunParallel(symbols.size(), 256, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i)
+			new_flags[i] = AnalyzeFunction2(*symbols[i]);
+	});
+
 	int numLeafs = 0, numNice = 0, numUnNice = 0;
 	int numTimer = 0, numRFI = 0, numStraightLeaf = 0;
 	int leafSize = 0, niceSize = 0, unniceSize = 0;
-	for (auto& func : func_db->AccessSymbols())
+	for (size_t i = 0; i < symbols.size(); ++i)
 	{
-		if (func.second.address == 4)
+		Symbol &f = *symbols[i];
+		if (f.address == 4)
 		{
 			WARN_LOG(OSHLE, "Weird function");
 			continue;
 		}
-		AnalyzeFunction2(&(func.second));
-		Symbol &f = func.second;
+		f.flags = new_flags[i];
 		if (f.name.substr(0, 3) == "zzz")
 		{
 			if (f.flags & FFLAG_LEAF)
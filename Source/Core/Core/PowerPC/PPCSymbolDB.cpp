@@ -2,6 +2,7 @@
 // Licensed under GPLv2
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <map>
 #include <string>
 #include <vector>
@@ -21,6 +22,7 @@
 PPCSymbolDB g_symbolDB;
 
 PPCSymbolDB::PPCSymbolDB()
+	: m_ranges_valid(false)
 {
 	// Get access to the disasm() fgnction
 	debugger = &PowerPC::debug_interface;
@@ -48,15 +50,28 @@ Symbol *PPCSymbolDB::AddFunction(u32 startAddr)
 		if (targetEnd == 0)
 			return nullptr;  //found a dud :(
 		//LOG(OSHLE, "Symbol found at %08x", startAddr);
-		functions[startAddr] = tempFunc;
-		tempFunc.type = Symbol::SYMBOL_FUNCTION;
-		checksumToFunction[tempFunc.hash] = &(functions[startAddr]);
-		return &functions[startAddr];
+		return AddAnalyzedFunction(tempFunc);
 	}
 }
 
+Symbol *PPCSymbolDB::AddAnalyzedFunction(const Symbol& func)
+{
+	XFuncMap::iterator iter = functions.find(func.address);
+	if (iter != functions.end())
+		return nullptr;
+
+	m_ranges_valid = false;
+	Symbol& symbol = functions[func.address];
+	symbol = func;
+	symbol.type = Symbol::SYMBOL_FUNCTION;
+	checksumToFunction[symbol.hash] = &symbol;
+	return &symbol;
+}
+
 void PPCSymbolDB::AddKnownSymbol(u32 startAddr, u32 size, const std::string& name, int type)
 {
+	m_ranges_valid = false;
+
 	XFuncMap::iterator iter = functions.find(startAddr);
 	if (iter != functions.end())
 	{
@@ -91,18 +106,65 @@ Symbol *PPCSymbolDB::GetSymbolFromAddr(u32 addr)
 
 	XFuncMap::iterator it = functions.find(addr);
 	if (it != functions.end())
-	{
 		return &it->second;
-	}
-	else
+
+	if (!m_ranges_valid)
+		BuildRanges();
+
+	// The last range starting at or before addr
+	auto range = std::upper_bound(m_ranges.begin(), m_ranges.end(), addr,
+		[](u32 address, const SymbolRange& r) { return address < r.start; });
+	if (range == m_ranges.begin())
+		return nullptr;
+	--range;
+	if (addr >= range->end)
+		return nullptr;
+	return range->symbol;
+}
+
+void PPCSymbolDB::PrepareLookups()
+{
+	if (!m_ranges_valid)
+		BuildRanges();
+}
+
+void PPCSymbolDB::BuildRanges()
+{
+	m_ranges.clear();
+	m_ranges.reserve(functions.size());
+
+	// functions is sorted by address, so only the end of the previous ranges
+	// has to be tracked to cut off the overlapping part of each function.
+	u64 covered_end = 0;
+	for (auto& entry : functions)
 	{
-		for (auto& p : functions)
-		{
-			if (addr >= p.second.address && addr < p.second.address + p.second.size)
-				return &p.second;
-		}
+		Symbol& symbol = entry.second;
+		if (symbol.size <= 0)
+			continue;
+
+		u64 start = std::max<u64>(symbol.address, covered_end);
+		u64 end = (u64)symbol.address + symbol.size;
+		if (start >= end)
+			continue;
+
+		m_ranges.push_back({ (u32)start, end, &symbol });
+		covered_end = end;
 	}
-	return nullptr;
+
+	m_ranges_valid = true;
+}
+
+void PPCSymbolDB::Clear(const char *prefix)
+{
+	SymbolDB::Clear(prefix);
+	m_ranges.clear();
+	m_ranges_valid = false;
+}
+
+void PPCSymbolDB::Index()
+{
+	SymbolDB::Index();
+	BuildRanges();
 }
 
 const std::string PPCSymbolDB::GetDescription(u32 addr)
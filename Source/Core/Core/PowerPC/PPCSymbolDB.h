@@ -19,6 +19,19 @@ class PPCSymbolDB : public SymbolDB
 private:
 	DebugInterface* debugger;
 
+	// The address ranges covered by functions, sorted and non-overlapping.
+	// Where functions overlap, the range belongs to the one that starts first.
+	struct SymbolRange
+	{
+		u32 start;
+		u64 end;
+		Symbol* symbol;
+	};
+	std::vector<SymbolRange> m_ranges;
+	bool m_ranges_valid;
+
+	void BuildRanges();
+
 public:
 	typedef void (*functionGetterCallback)(Symbol *f);
 
@@ -26,9 +39,18 @@ public:
 	~PPCSymbolDB();
 
 	Symbol *AddFunction(u32 startAddr) override;
+	// Adds a function that PPCAnalyst::AnalyzeFunction was already run on,
+	// unless there is one at its address already.
+	Symbol *AddAnalyzedFunction(const Symbol& func);
 	void AddKnownSymbol(u32 startAddr, u32 size, const std::string& name, int type = Symbol::SYMBOL_FUNCTION);
 
 	Symbol *GetSymbolFromAddr(u32 addr) override;
+	// Makes GetSymbolFromAddr safe to call from several threads until the
+	// symbols change.
+	void PrepareLookups();
+
+	void Clear(const char *prefix = "") override;
+	void Index() override;
 
 	const std::string GetDescription(u32 addr);
 
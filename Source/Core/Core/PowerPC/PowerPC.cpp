@@ -68,6 +68,9 @@ void DoState(PointerWrap &p)
 
 	p.DoPOD(ppcState);
 
+	if (p.GetMode() == PointerWrap::MODE_READ)
+		InvalidateHostTLB();
+
 	// SystemTimers::DecrementerSet();
 	// SystemTimers::TimeBaseSet();
 
@@ -133,6 +136,7 @@ void Init(int cpu_core)
 			}
 		}
 	}
+	InvalidateHostTLB();
 
 	ResetRegisters();
 	PPCTables::InitTables(cpu_core);
@@ -264,6 +264,9 @@ void ClearCacheLine(const u32 address); // Zeroes 32 bytes; address should be 32
 // TLB functions
 void SDRUpdated();
 void InvalidateTLBEntry(u32 address);
+// Drops every cached host translation; needed whenever the effective to physical
+// mapping may have changed wholesale (segment registers, BATs, SDR1, savestates).
+void InvalidateHostTLB();
 
 // Result changes based on the BAT registers and MSR.DR.  Returns whether
 // it's safe to optimize a read or write to this address to an unguarded
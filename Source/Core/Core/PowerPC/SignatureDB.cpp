@@ -2,7 +2,9 @@
 // Licensed under GPLv2
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <string>
+#include <vector>
 
 #include "Common/CommonTypes.h"
 #include "Common/FileUtil.h"
@@ -58,15 +60,22 @@ bool SignatureDB::Save(const std::string& filename)
 		ERROR_LOG(OSHLE, "Database save failed");
 		return false;
 	}
+	// Sorted by checksum, so that saving the same database gives the same file.
+	std::vector<const FuncDB::value_type*> entries;
+	for (const auto& entry : database)
+		entries.push_back(&entry);
+	std::sort(entries.begin(), entries.end(),
+		[](const FuncDB::value_type* a, const FuncDB::value_type* b) { return a->first < b->first; });
+
 	u32 fcount = (u32)database.size();
 	f.WriteArray(&fcount, 1);
-	for (const auto& entry : database)
+	for (const auto* entry : entries)
 	{
 		FuncDesc temp;
 		memset(&temp, 0, sizeof(temp));
-		temp.checkSum = entry.first;
-		temp.size = entry.second.size;
-		strncpy(temp.name, entry.second.name.c_str(), 127);
+		temp.checkSum = entry->first;
+		temp.size = entry->second.size;
+		strncpy(temp.name, entry->second.name.c_str(), 127);
 		f.WriteArray(&temp, 1);
 	}
 
@@ -107,24 +116,28 @@ void SignatureDB::Clear()
 
 void SignatureDB::Apply(PPCSymbolDB *symbol_db)
 {
-	for (const auto& entry : database)
+	// Look up each function in the database rather than each entry of the
+	// database in the functions; there are far fewer functions in a game than
+	// signatures in a big database. Only the function that is registered for
+	// a checksum is renamed, like when looking the checksums up.
+	for (auto& symbol : symbol_db->AccessSymbols())
 	{
-		u32 hash = entry.first;
-		Symbol *function = symbol_db->GetSymbolFromHash(hash);
-		if (function)
+		Symbol *function = &symbol.second;
+		FuncDB::const_iterator entry = database.find(function->hash);
+		if (entry == database.end() || symbol_db->GetSymbolFromHash(function->hash) != function)
+			continue;
+
+		// Found the function. Let's rename it according to the symbol file.
+		if (entry->second.size == (unsigned int)function->size)
 		{
-			// Found the function. Let's rename it according to the symbol file.
-			if (entry.second.size == (unsigned int)function->size)
-			{
-				function->name = entry.second.name;
-				INFO_LOG(OSHLE, "Found %s at %08x (size: %08x)!", entry.second.name.c_str(), function->address, function->size);
-			}
-			else
-			{
-				function->name = entry.second.name;
-				ERROR_LOG(OSHLE, "Wrong size! Found %s at %08x (size: %08x instead of %08x)!",
-				          entry.second.name.c_str(), function->address, function->size, entry.second.size);
-			}
+			function->name = entry->second.name;
+			INFO_LOG(OSHLE, "Found %s at %08x (size: %08x)!", entry->second.name.c_str(), function->address, function->size);
+		}
+		else
+		{
+			function->name = entry->second.name;
+			ERROR_LOG(OSHLE, "Wrong size! Found %s at %08x (size: %08x instead of %08x)!",
+			          entry->second.name.c_str(), function->address, function->size, entry->second.size);
 		}
 	}
 	symbol_db->Index();
@@ -4,8 +4,8 @@
 
 #pragma once
 
-#include <map>
 #include <string>
+#include <unordered_map>
 
 #include "Common/CommonTypes.h"
 
@@ -26,7 +26,7 @@ class SignatureDB
 
 	// Map from signature to function. We store the DB in this map because it optimizes the
 	// most common operation - lookup. We don't care about ordering anyway.
-	typedef std::map<u32, DBFunc> FuncDB;
+	typedef std::unordered_map<u32, DBFunc> FuncDB;
 	FuncDB database;
 
 public:
@@ -16,6 +16,7 @@
 #include "Core/ConfigManager.h"
 #include "Core/Core.h"
 #include "Core/CoreTiming.h"
+#include "Core/DSPEmulator.h"
 #include "Core/Movie.h"
 #include "Core/State.h"
 #include "Core/HW/CPU.h"
@@ -66,7 +67,7 @@ static Common::Event g_compressAndDumpStateSyncEvent;
 static std::thread g_save_thread;
 
 // Don't forget to increase this after doing changes on the savestate system
-static const u32 STATE_VERSION = 43;	// Last changed in PR 2232
+static const u32 STATE_VERSION = 44;	// Last changed: movie input hash
 
 // Maps savestate versions to Dolphin versions.
 // Versions after 42 don't need to be added to this list,
@@ -163,7 +164,7 @@ static std::string DoState(PointerWrap& p)
 	p.DoMarker("video_backend");
 
 	if (SConfig::GetInstance().m_LocalCoreStartupParameter.bWii)
-		Wiimote::DoState(p.GetPPtr(), p.GetMode());
+		Wiimote::DoState(p);
 	p.DoMarker("Wiimote");
 
 	PowerPC::DoState(p);
@@ -197,16 +198,10 @@ void SaveToBuffer(std::vector<u8>& buffer)
 {
 	bool wasUnpaused = Core::PauseAndLock(true);
 
-	u8* ptr = nullptr;
-	PointerWrap p(&ptr, PointerWrap::MODE_MEASURE);
-
-	DoState(p);
-	const size_t buffer_size = reinterpret_cast<size_t>(ptr);
-	buffer.resize(buffer_size);
-
-	ptr = &buffer[0];
-	p.SetMode(PointerWrap::MODE_WRITE);
+	u8* ptr = buffer.data();
+	PointerWrap p(&ptr, &buffer);
 	DoState(p);
+	buffer.resize(ptr - buffer.data());
 
 	Core::PauseAndLock(false, wasUnpaused);
 }
@@ -222,6 +217,39 @@ void VerifyBuffer(std::vector<u8>& buffer)
 	Core::PauseAndLock(false, wasUnpaused);
 }
 
+// The CPU thread, between two blocks, is where the other callers pause it.
+// Only the DSP and GPU threads need to be synced with it here.
+static void LockOtherThreads(bool do_lock, bool unpause_on_unlock)
+{
+	DSP::GetDSPEmulator()->PauseAndLock(do_lock, unpause_on_unlock);
+	g_video_backend->PauseAndLock(do_lock, unpause_on_unlock);
+}
+
+void LoadFromBufferOnCPUThread(std::vector<u8>& buffer)
+{
+	const bool unpause = !CCPU::IsStepping();
+	LockOtherThreads(true, unpause);
+
+	u8* ptr = &buffer[0];
+	PointerWrap p(&ptr, PointerWrap::MODE_READ);
+	DoState(p);
+
+	LockOtherThreads(false, unpause);
+}
+
+void SaveToBufferOnCPUThread(std::vector<u8>& buffer)
+{
+	const bool unpause = !CCPU::IsStepping();
+	LockOtherThreads(true, unpause);
+
+	u8* ptr = buffer.data();
+	PointerWrap p(&ptr, &buffer);
+	DoState(p);
+	buffer.resize(ptr - buffer.data());
+
+	LockOtherThreads(false, unpause);
+}
+
 // return state number not in map
 static int GetEmptySlot(std::map<double, int> m)
 {
@@ -272,6 +300,8 @@ struct CompressAndDumpState_args
 	std::mutex* buffer_mutex;
 	std::string filename;
 	bool wait;
+	// Guest memory still has to be copied into the buffer, see Memory::SetSnapshotOnSave.
+	bool memory_snapshot;
 };
 
 static void CompressAndDumpState(CompressAndDumpState_args save_args)
@@ -280,6 +310,9 @@ static void CompressAndDumpState(CompressAndDumpState_args save_args)
 	if (!save_args.wait)
 		g_compressAndDumpStateSyncEvent.Set();
 
+	if (save_args.memory_snapshot)
+		Memory::FinishSnapshot(save_args.buffer_vector->data());
+
 	const u8* const buffer_data = &(*(save_args.buffer_vector))[0];
 	const size_t buffer_size = (save_args.buffer_vector)->size();
 	std::string& filename = save_args.filename;
@@ -301,9 +334,11 @@ static void CompressAndDumpState(CompressAndDumpState_args save_args)
 			File::Rename(filename + ".dtm", File::GetUserPath(D_STATESAVES_IDX) + "lastState.sav.dtm");
 	}
 
-	if ((Movie::IsMovieActive()) && !Movie::IsJustStartingRecordingInputFromSaveState())
+	// Streamed movies aren't copied next to each savestate, the state only
+	// refers to the input by its position and hash.
+	if (Movie::IsMovieActive() && !Movie::IsStreamingInput() && !Movie::IsJustStartingRecordingInputFromSaveState())
 		Movie::SaveRecording(filename + ".dtm");
-	else if (!Movie::IsMovieActive())
+	else if (!Movie::IsMovieActive() || Movie::IsStreamingInput())
 		File::Delete(filename + ".dtm");
 
 	File::IOFile f(filename, "wb");
@@ -366,19 +401,18 @@ void SaveAs(const std::string& filename, bool wait)
 	// Pause the core while we save the state
 	bool wasUnpaused = Core::PauseAndLock(true);
 
-	// Measure the size of the buffer.
-	u8 *ptr = nullptr;
-	PointerWrap p(&ptr, PointerWrap::MODE_MEASURE);
-	DoState(p);
-	const size_t buffer_size = reinterpret_cast<size_t>(ptr);
-
-	// Then actually do the write.
+	// Write the state in a single pass, growing the buffer as needed. Guest
+	// memory is snapshotted copy-on-write when possible and copied into the
+	// buffer by the save thread, after the core has been resumed.
+	u8 *ptr;
+	PointerWrap p(&ptr, &g_current_buffer);
 	{
 		std::lock_guard<std::mutex> lk(g_cs_current_buffer);
-		g_current_buffer.resize(buffer_size);
-		ptr = &g_current_buffer[0];
-		p.SetMode(PointerWrap::MODE_WRITE);
+		ptr = g_current_buffer.data();
+		Memory::SetSnapshotOnSave(true);
 		DoState(p);
+		Memory::SetSnapshotOnSave(false);
+		g_current_buffer.resize(ptr - g_current_buffer.data());
 	}
 
 	if (p.GetMode() == PointerWrap::MODE_WRITE)
@@ -390,6 +424,7 @@ void SaveAs(const std::string& filename, bool wait)
 		save_args.buffer_mutex = &g_cs_current_buffer;
 		save_args.filename = filename;
 		save_args.wait = wait;
+		save_args.memory_snapshot = Memory::IsSnapshotPending();
 
 		Flush();
 		g_save_thread = std::thread(CompressAndDumpState, save_args);
@@ -400,6 +435,7 @@ void SaveAs(const std::string& filename, bool wait)
 	else
 	{
 		// someone aborted the save by changing the mode?
+		Memory::FinishSnapshot(nullptr);
 		Core::DisplayMessage("Unable to save: Internal DoState Error", 4000);
 	}
 
@@ -502,7 +538,7 @@ void LoadAs(const std::string& filename)
 	{
 		std::lock_guard<std::mutex> lk(g_cs_undo_load_buffer);
 		SaveToBuffer(g_undo_load_buffer);
-		if (Movie::IsMovieActive())
+		if (Movie::IsMovieActive() && !Movie::IsStreamingInput())
 			Movie::SaveRecording(File::GetUserPath(D_STATESAVES_IDX) + "undo.dtm");
 		else if (File::Exists(File::GetUserPath(D_STATESAVES_IDX) +"undo.dtm"))
 			File::Delete(File::GetUserPath(D_STATESAVES_IDX) + "undo.dtm");
@@ -532,7 +568,12 @@ void LoadAs(const std::string& filename)
 		if (loadedSuccessfully)
 		{
 			Core::DisplayMessage(StringFromFormat("Loaded state from %s", filename.c_str()), 2000);
-			if (File::Exists(filename + ".dtm"))
+			if (Movie::IsStreamingInput())
+			{
+				if (!Movie::IsJustStartingRecordingInputFromSaveState() && !Movie::IsJustStartingPlayingInputFromSaveState())
+					Movie::LoadStreamedInput();
+			}
+			else if (File::Exists(filename + ".dtm"))
 				Movie::LoadInput(filename + ".dtm");
 			else if (!Movie::IsJustStartingRecordingInputFromSaveState() && !Movie::IsJustStartingPlayingInputFromSaveState())
 				Movie::EndPlayInput(false);
@@ -675,10 +716,12 @@ void UndoLoadState()
 	std::lock_guard<std::mutex> lk(g_cs_undo_load_buffer);
 	if (!g_undo_load_buffer.empty())
 	{
-		if (File::Exists(File::GetUserPath(D_STATESAVES_IDX) + "undo.dtm") || (!Movie::IsMovieActive()))
+		if (File::Exists(File::GetUserPath(D_STATESAVES_IDX) + "undo.dtm") || !Movie::IsMovieActive() || Movie::IsStreamingInput())
 		{
 			LoadFromBuffer(g_undo_load_buffer);
-			if (Movie::IsMovieActive())
+			if (Movie::IsStreamingInput())
+				Movie::LoadStreamedInput();
+			else if (Movie::IsMovieActive())
 				Movie::LoadInput(File::GetUserPath(D_STATESAVES_IDX) + "undo.dtm");
 		}
 		else
@@ -50,6 +50,11 @@ void SaveToBuffer(std::vector<u8>& buffer);
 void LoadFromBuffer(std::vector<u8>& buffer);
 void VerifyBuffer(std::vector<u8>& buffer);
 
+// Like the above, but for the CPU thread between two blocks, e.g. in a
+// CoreTiming event, where the CPU can't be paused.
+void SaveToBufferOnCPUThread(std::vector<u8>& buffer);
+void LoadFromBufferOnCPUThread(std::vector<u8>& buffer);
+
 void LoadLastSaved(int i = 1);
 void SaveFirstSaved();
 void UndoSaveState();
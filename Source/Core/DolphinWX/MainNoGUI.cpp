@@ -4,9 +4,11 @@
 
 #include <cstddef>
 #include <cstdio>
+#include <cstdlib>
 #include <cstring>
 #include <getopt.h>
 #include <string>
+#include <unistd.h>
 
 #include "Common/CommonTypes.h"
 #include "Common/Event.h"
@@ -101,6 +103,30 @@ void Host_SetWiiMoteConnectionState(int _State) {}
 
 void Host_ShowVideoConfig(void*, const std::string&, const std::string&) {}
 
+// Without a window, for backends that don't need one, like Null.
+class PlatformHeadless : public Platform
+{
+	void Init() override
+	{
+	}
+
+	void SetTitle(const std::string &string) override
+	{
+		printf("%s\n", string.c_str());
+		fflush(stdout);
+	}
+
+	void MainLoop() override
+	{
+		while (running)
+			usleep(100000);
+	}
+
+	void Shutdown() override
+	{
+	}
+};
+
 #if HAVE_X11
 #include <X11/keysym.h>
 #include "DolphinWX/X11Utils.h"
@@ -280,9 +306,10 @@ class PlatformX11 : public Platform
 static Platform* GetPlatform()
 {
 #if HAVE_X11
-	return new PlatformX11();
+	if (getenv("DISPLAY"))
+		return new PlatformX11();
 #endif
-	return nullptr;
+	return new PlatformHeadless();
 }
 
 int main(int argc, char* argv[])
@@ -323,11 +350,6 @@ int main(int argc, char* argv[])
 	}
 
 	platform = GetPlatform();
-	if (!platform)
-	{
-		fprintf(stderr, "No platform found\n");
-		return 1;
-	}
 
 	UICommon::SetUserDirectory(""); // Auto-detect user folder
 	UICommon::Init();
@@ -273,6 +273,9 @@ void NetPlaySetupFrame::MakeNetPlayDiag(int port, const std::string &game, bool
 	netplay_client = new NetPlayClient(ip, (u16)port, npd, WxStrToStr(m_nickname_text->GetValue()), trav, centralServer, (u16) centralPort);
 	if (netplay_client->is_connected)
 	{
+		// The saves of the host's own client are the ones the others get.
+		if (is_hosting)
+			NetPlayDialog::GetNetPlayServer()->SetHostPlayer(netplay_client->GetLocalPlayerId());
 		npd->Show();
 		Destroy();
 	}
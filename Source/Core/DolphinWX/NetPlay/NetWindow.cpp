@@ -95,6 +95,7 @@ NetPlayDialog::NetPlayDialog(wxWindow* const parent, const CGameListCtrl* const
 	, m_host_copy_btn(nullptr)
 	, m_host_copy_btn_is_retry(false)
 	, m_is_hosting(is_hosting)
+	, m_save_sync_quarter()
 	, m_game_list(game_list)
 {
 	Bind(wxEVT_THREAD, &NetPlayDialog::OnThread, this);
@@ -197,6 +198,14 @@ NetPlayDialog::NetPlayDialog(wxWindow* const parent, const CGameListCtrl* const
 		padbuf_spin->Bind(wxEVT_SPINCTRL, &NetPlayDialog::OnAdjustBuffer, this);
 		bottom_szr->Add(padbuf_spin, 0, wxCENTER);
 
+		bottom_szr->Add(new wxStaticText(panel, wxID_ANY, _("Rollback:")), 0, wxLEFT | wxCENTER, 5);
+		wxSpinCtrl* const rollback_spin = new wxSpinCtrl(panel, wxID_ANY, "0"
+			, wxDefaultPosition, wxSize(64, -1), wxSP_ARROW_KEYS, 0, MAX_ROLLBACK_FRAMES, 0);
+		rollback_spin->SetToolTip(_("Number of frames the input of other players is predicted for, and rolled back when the prediction was wrong. "
+			"0 uses the pad buffer instead. Applies from the next game, GameCube games only."));
+		rollback_spin->Bind(wxEVT_SPINCTRL, &NetPlayDialog::OnAdjustRollback, this);
+		bottom_szr->Add(rollback_spin, 0, wxCENTER);
+
 		m_memcard_write = new wxCheckBox(panel, wxID_ANY, _("Write memcards (GC)"));
 		bottom_szr->Add(m_memcard_write, 0, wxCENTER);
 	}
@@ -278,7 +287,7 @@ void NetPlayDialog::OnStart(wxCommandEvent&)
 	NetSettings settings;
 	GetNetSettings(settings);
 	netplay_server->SetNetSettings(settings);
-	netplay_server->StartGame();
+	netplay_server->StartGame(FindGame());
 }
 
 void NetPlayDialog::BootGame(const std::string& filename)
@@ -341,6 +350,27 @@ void NetPlayDialog::OnMsgStopGame()
 	m_record_chkbox->Enable();
 }
 
+void NetPlayDialog::OnSaveSyncProgress(int save_index, u32 blocks_done, u32 blocks_total)
+{
+	// Only show the start of the transfer and each quarter of it.
+	const u32 quarter = blocks_total ? blocks_done * 4 / blocks_total : 4;
+	if (blocks_done && quarter == m_save_sync_quarter[save_index])
+		return;
+	m_save_sync_quarter[save_index] = quarter;
+
+	std::ostringstream ss;
+	if (save_index == SAVE_SYNC_WII)
+		ss << " -- Wii save: ";
+	else
+		ss << " -- Memory card " << (char)('A' + save_index) << ": ";
+	if (!blocks_total)
+		ss << "same as the host's";
+	else
+		ss << "received " << blocks_done << " of " << blocks_total << " blocks";
+	ss << " -- ";
+	AppendChat(ss.str());
+}
+
 void NetPlayDialog::OnAdjustBuffer(wxCommandEvent& event)
 {
 	const int val = ((wxSpinCtrl*)event.GetEventObject())->GetValue();
@@ -352,6 +382,17 @@ void NetPlayDialog::OnAdjustBuffer(wxCommandEvent& event)
 	m_chat_text->AppendText(StrToWxStr(ss.str()).Append('\n'));
 }
 
+void NetPlayDialog::OnAdjustRollback(wxCommandEvent& event)
+{
+	const int val = ((wxSpinCtrl*)event.GetEventObject())->GetValue();
+	netplay_server->SetRollbackFrames(val);
+
+	std::ostringstream ss;
+	ss << "< Rollback: " << val << " frames >";
+	netplay_client->SendChatMessage(ss.str());
+	m_chat_text->AppendText(StrToWxStr(ss.str()).Append('\n'));
+}
+
 void NetPlayDialog::OnQuit(wxCommandEvent&)
 {
 	Destroy();
@@ -55,6 +55,7 @@ public:
 	void OnMsgChangeGame(const std::string& filename) override;
 	void OnMsgStartGame() override;
 	void OnMsgStopGame() override;
+	void OnSaveSyncProgress(int save_index, u32 blocks_done, u32 blocks_total) override;
 
 	static NetPlayDialog*& GetInstance() { return npd; }
 	static NetPlayClient*& GetNetPlayClient() { return netplay_client; }
@@ -69,6 +70,7 @@ private:
 	void OnThread(wxThreadEvent& event);
 	void OnChangeGame(wxCommandEvent& event);
 	void OnAdjustBuffer(wxCommandEvent& event);
+	void OnAdjustRollback(wxCommandEvent& event);
 	void OnConfigPads(wxCommandEvent& event);
 	void OnKick(wxCommandEvent& event);
 	void OnPlayerSelect(wxCommandEvent& event);
@@ -95,6 +97,8 @@ private:
 	wxButton*     m_host_copy_btn;
 	bool          m_host_copy_btn_is_retry;
 	bool          m_is_hosting;
+	// last quarter of each save transfer shown in the chat
+	u32           m_save_sync_quarter[NUM_SAVE_SYNCS];
 
 	std::vector<int> m_playerids;
 
@@ -33,7 +33,6 @@
 #include "VideoCommon/FPSCounter.h"
 #include "VideoCommon/ImageWrite.h"
 #include "VideoCommon/OnScreenDisplay.h"
-#include "VideoCommon/PixelEngine.h"
 #include "VideoCommon/PixelShaderManager.h"
 #include "VideoCommon/Statistics.h"
 #include "VideoCommon/VertexShaderManager.h"
@@ -336,7 +335,7 @@ void Renderer::SetColorMask()
 // and EFB pokes (which will change the color or depth of a pixel).
 //
 // The behavior of EFB peeks can only be modified by:
-//  - GX_PokeAlphaRead
+//  - GX_PokeAlphaRead, which is applied by the caller
 // The behavior of EFB pokes can be modified by:
 //  - GX_PokeAlphaMode (TODO)
 //  - GX_PokeAlphaUpdate (TODO)
@@ -444,9 +443,6 @@ u32 Renderer::AccessEFB(EFBAccessType type, u32 x, u32 y, u32 poke_data)
 			ret = *(u32*)map.pData;
 		D3D::context->Unmap(read_tex, 0);
 
-		// check what to do with the alpha channel (GX_PokeAlphaRead)
-		PixelEngine::UPEAlphaReadReg alpha_read_mode = PixelEngine::GetAlphaReadMode();
-
 		if (bpmem.zcontrol.pixel_format == PEControl::RGBA6_Z24)
 		{
 			ret = RGBA8ToRGBA6ToRGBA8(ret);
@@ -460,9 +456,8 @@ u32 Renderer::AccessEFB(EFBAccessType type, u32 x, u32 y, u32 poke_data)
 			ret |= 0xFF000000;
 		}
 
-		if (alpha_read_mode.ReadMode == 2) return ret; // GX_READ_NONE
-		else if (alpha_read_mode.ReadMode == 1) return (ret | 0xFF000000); // GX_READ_FF
-		else /*if(alpha_read_mode.ReadMode == 0)*/ return (ret & 0x00FFFFFF); // GX_READ_00
+		// GX_PokeAlphaRead is applied by the caller
+		return ret;
 	}
 	else //if(type == POKE_COLOR)
 	{
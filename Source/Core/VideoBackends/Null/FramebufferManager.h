@@ -0,0 +1,36 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "VideoCommon/FramebufferManagerBase.h"
+#include "VideoCommon/RenderBase.h"
+
+namespace Null
+{
+
+struct XFBSource : public XFBSourceBase
+{
+	void DecodeToTexture(u32 xfbAddr, u32 fbWidth, u32 fbHeight) override {}
+	void CopyEFB(float Gamma) override {}
+};
+
+class FramebufferManager : public FramebufferManagerBase
+{
+private:
+	XFBSourceBase* CreateXFBSource(unsigned int target_width, unsigned int target_height, unsigned int layers) override
+	{
+		return new XFBSource;
+	}
+
+	void GetTargetSize(unsigned int *width, unsigned int *height) override
+	{
+		*width = Renderer::GetTargetWidth();
+		*height = Renderer::GetTargetHeight();
+	}
+
+	void CopyToRealXFB(u32 xfbAddr, u32 fbWidth, u32 fbHeight, const EFBRectangle& sourceRc, float Gamma) override {}
+};
+
+}
@@ -0,0 +1,152 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+// Null Backend Documentation
+
+// This backend tries not to do anything in the backend,
+// but everything in VideoCommon.
+
+#include "Common/CommonPaths.h"
+#include "Common/FileUtil.h"
+
+#include "Core/Host.h"
+
+#include "VideoBackends/Null/Render.h"
+#include "VideoBackends/Null/TextureCache.h"
+#include "VideoBackends/Null/VertexManager.h"
+#include "VideoBackends/Null/VideoBackend.h"
+
+#include "VideoCommon/BPStructs.h"
+#include "VideoCommon/CommandProcessor.h"
+#include "VideoCommon/Fifo.h"
+#include "VideoCommon/GeometryShaderManager.h"
+#include "VideoCommon/IndexGenerator.h"
+#include "VideoCommon/MainBase.h"
+#include "VideoCommon/OnScreenDisplay.h"
+#include "VideoCommon/OpcodeDecoding.h"
+#include "VideoCommon/PerfQueryBase.h"
+#include "VideoCommon/PixelEngine.h"
+#include "VideoCommon/PixelShaderManager.h"
+#include "VideoCommon/VertexLoaderManager.h"
+#include "VideoCommon/VertexShaderManager.h"
+#include "VideoCommon/VideoConfig.h"
+
+namespace Null
+{
+
+static void InitBackendInfo()
+{
+	g_Config.backend_info.APIType = API_NONE;
+	g_Config.backend_info.bSupportsExclusiveFullscreen = false;
+	g_Config.backend_info.bSupportsDualSourceBlend = true;
+	g_Config.backend_info.bSupportsPrimitiveRestart = true;
+	g_Config.backend_info.bSupportsOversizedViewports = true;
+	g_Config.backend_info.bSupportsGeometryShaders = true;
+	g_Config.backend_info.bSupports3DVision = false;
+	g_Config.backend_info.bSupportsEarlyZ = true;
+	g_Config.backend_info.bSupportsBindingLayout = true;
+	g_Config.backend_info.bSupportsBBox = true;
+	g_Config.backend_info.bSupportsGSInstancing = true;
+	g_Config.backend_info.bSupportsPostProcessing = false;
+	g_Config.backend_info.bSupportsPaletteConversion = true;
+
+	// There's nothing to multisample.
+	g_Config.backend_info.Adapters.clear();
+	g_Config.backend_info.AAModes = { "None" };
+}
+
+std::string VideoBackend::GetName() const
+{
+	return "Null";
+}
+
+std::string VideoBackend::GetDisplayName() const
+{
+	return "Null";
+}
+
+void VideoBackend::ShowConfig(void *parent)
+{
+	if (!s_BackendInitialized)
+		InitBackendInfo();
+	Host_ShowVideoConfig(parent, GetDisplayName(), "gfx_null");
+}
+
+bool VideoBackend::Initialize(void *window_handle)
+{
+	InitializeShared();
+	InitBackendInfo();
+
+	frameCount = 0;
+
+	g_Config.Load(File::GetUserPath(D_CONFIG_IDX) + "gfx_null.ini");
+	g_Config.GameIniLoad();
+	g_Config.UpdateProjectionHack();
+	g_Config.VerifyValidity();
+	UpdateActiveConfig();
+
+	// Do our OSD callbacks
+	OSD::DoCallbacks(OSD::OSD_INIT);
+
+	s_BackendInitialized = true;
+
+	return true;
+}
+
+// This is called after Initialize() from the Core
+// Run from the graphics thread
+void VideoBackend::Video_Prepare()
+{
+	g_renderer = new Renderer;
+
+	CommandProcessor::Init();
+	PixelEngine::Init();
+
+	BPInit();
+	g_vertex_manager = new VertexManager;
+	g_perf_query = new PerfQueryBase;
+	Fifo_Init(); // must be done before OpcodeDecoder_Init()
+	OpcodeDecoder_Init();
+	IndexGenerator::Init();
+	VertexShaderManager::Init();
+	PixelShaderManager::Init();
+	GeometryShaderManager::Init();
+	g_texture_cache = new TextureCache;
+	VertexLoaderManager::Init();
+
+	// Notify the core that the video backend is ready
+	Host_Message(WM_USER_CREATE);
+}
+
+void VideoBackend::Shutdown()
+{
+	s_BackendInitialized = false;
+
+	// Do our OSD callbacks
+	OSD::DoCallbacks(OSD::OSD_SHUTDOWN);
+}
+
+void VideoBackend::Video_Cleanup()
+{
+	if (g_renderer)
+	{
+		Fifo_Shutdown();
+
+		VertexLoaderManager::Shutdown();
+		delete g_texture_cache;
+		g_texture_cache = nullptr;
+		VertexShaderManager::Shutdown();
+		PixelShaderManager::Shutdown();
+		GeometryShaderManager::Shutdown();
+		delete g_perf_query;
+		g_perf_query = nullptr;
+		delete g_vertex_manager;
+		g_vertex_manager = nullptr;
+		OpcodeDecoder_Shutdown();
+		delete g_renderer;
+		g_renderer = nullptr;
+	}
+}
+
+}
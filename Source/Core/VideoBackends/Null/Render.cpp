@@ -0,0 +1,53 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include "VideoBackends/Null/FramebufferManager.h"
+#include "VideoBackends/Null/Render.h"
+
+#include "VideoCommon/TextureCacheBase.h"
+#include "VideoCommon/VideoConfig.h"
+
+namespace Null
+{
+
+Renderer::Renderer()
+{
+	// There's no window, so pretend it has the size of the EFB.
+	s_backbuffer_width = EFB_WIDTH;
+	s_backbuffer_height = EFB_HEIGHT;
+	s_last_efb_scale = g_ActiveConfig.iEFBScale;
+
+	UpdateDrawRectangle(s_backbuffer_width, s_backbuffer_height);
+	CalculateTargetSize(s_backbuffer_width, s_backbuffer_height);
+
+	g_framebuffer_manager = new FramebufferManager;
+}
+
+Renderer::~Renderer()
+{
+	delete g_framebuffer_manager;
+	g_framebuffer_manager = nullptr;
+}
+
+TargetRectangle Renderer::ConvertEFBRectangle(const EFBRectangle& rc)
+{
+	TargetRectangle result;
+	result.left = EFBToScaledX(rc.left);
+	result.top = EFBToScaledY(rc.top);
+	result.right = EFBToScaledX(rc.right);
+	result.bottom = EFBToScaledY(rc.bottom);
+	return result;
+}
+
+void Renderer::SwapImpl(u32 xfbAddr, u32 fbWidth, u32 fbStride, u32 fbHeight, const EFBRectangle& rc, float Gamma)
+{
+	// Clean out old stuff from caches and pick up config changes, like the
+	// other backends do every frame.
+	TextureCache::Cleanup(frameCount);
+
+	UpdateActiveConfig();
+	TextureCache::OnConfigChanged(g_ActiveConfig);
+}
+
+}
@@ -0,0 +1,63 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include "VideoBackends/Null/VertexManager.h"
+
+#include "VideoCommon/IndexGenerator.h"
+#include "VideoCommon/Statistics.h"
+#include "VideoCommon/VertexLoaderManager.h"
+#include "VideoCommon/VideoConfig.h"
+
+namespace Null
+{
+
+VertexManager::VertexManager()
+	: m_local_v_buffer(MAXVBUFFERSIZE), m_local_i_buffer(MAXIBUFFERSIZE)
+{
+}
+
+VertexManager::~VertexManager()
+{
+}
+
+NativeVertexFormat* VertexManager::CreateNativeVertexFormat()
+{
+	return new NullNativeVertexFormat;
+}
+
+void VertexManager::ResetBuffer(u32 stride)
+{
+	s_pCurBufferPointer = s_pBaseBufferPointer = m_local_v_buffer.data();
+	s_pEndBufferPointer = s_pBaseBufferPointer + m_local_v_buffer.size();
+	IndexGenerator::Start(m_local_i_buffer.data());
+}
+
+void VertexManager::vFlush(bool useDstAlpha)
+{
+	u32 components = VertexLoaderManager::GetCurrentVertexFormat()->m_components;
+	DSTALPHA_MODE dst_alpha_mode = useDstAlpha ? DSTALPHA_DUAL_SOURCE_BLEND : DSTALPHA_NONE;
+
+	PixelShaderUid puid;
+	VertexShaderUid vuid;
+	GeometryShaderUid guid;
+	GetPixelShaderUid(puid, dst_alpha_mode, API_NONE, components);
+	GetVertexShaderUid(vuid, components, API_NONE);
+	GetGeometryShaderUid(guid, current_primitive_type, API_NONE);
+
+	if (m_pixel_shaders.insert(puid).second)
+	{
+		INCSTAT(stats.numPixelShadersCreated);
+		SETSTAT(stats.numPixelShadersAlive, m_pixel_shaders.size());
+	}
+	if (m_vertex_shaders.insert(vuid).second)
+	{
+		INCSTAT(stats.numVertexShadersCreated);
+		SETSTAT(stats.numVertexShadersAlive, m_vertex_shaders.size());
+	}
+	m_geometry_shaders.insert(guid);
+
+	INCSTAT(stats.thisFrame.numDrawCalls);
+}
+
+}
@@ -0,0 +1,51 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <set>
+#include <vector>
+
+#include "VideoCommon/GeometryShaderGen.h"
+#include "VideoCommon/NativeVertexFormat.h"
+#include "VideoCommon/PixelShaderGen.h"
+#include "VideoCommon/VertexManagerBase.h"
+#include "VideoCommon/VertexShaderGen.h"
+
+namespace Null
+{
+
+class NullNativeVertexFormat : public NativeVertexFormat
+{
+public:
+	void Initialize(const PortableVertexDeclaration &_vtx_decl) override { vtx_decl = _vtx_decl; }
+	void SetupVertexPointers() override {}
+};
+
+// Converts vertices into CPU buffers and looks up the shaders the draws would
+// need, but never draws them.
+class VertexManager : public ::VertexManager
+{
+public:
+	VertexManager();
+	~VertexManager();
+
+	NativeVertexFormat* CreateNativeVertexFormat() override;
+
+protected:
+	void ResetBuffer(u32 stride) override;
+
+private:
+	void vFlush(bool useDstAlpha) override;
+
+	std::vector<u8> m_local_v_buffer;
+	std::vector<u16> m_local_i_buffer;
+
+	// The shaders a hardware backend would have compiled so far.
+	std::set<PixelShaderUid> m_pixel_shaders;
+	std::set<VertexShaderUid> m_vertex_shaders;
+	std::set<GeometryShaderUid> m_geometry_shaders;
+};
+
+}
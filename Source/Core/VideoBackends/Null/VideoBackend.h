@@ -0,0 +1,30 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <string>
+#include "VideoCommon/VideoBackendBase.h"
+
+namespace Null
+{
+
+// Runs the whole VideoCommon front-end, but doesn't draw anything.
+class VideoBackend : public VideoBackendHardware
+{
+	bool Initialize(void *) override;
+	void Shutdown() override;
+
+	std::string GetName() const override;
+	std::string GetDisplayName() const override;
+
+	void Video_Prepare() override;
+	void Video_Cleanup() override;
+
+	void ShowConfig(void* parent) override;
+
+	unsigned int PeekMessages() override { return 0; }
+};
+
+}
@@ -40,11 +40,11 @@
 #include "VideoCommon/BPFunctions.h"
 #include "VideoCommon/BPStructs.h"
 #include "VideoCommon/DriverDetails.h"
+#include "VideoCommon/EFBCache.h"
 #include "VideoCommon/Fifo.h"
 #include "VideoCommon/FPSCounter.h"
 #include "VideoCommon/ImageWrite.h"
 #include "VideoCommon/OnScreenDisplay.h"
-#include "VideoCommon/PixelEngine.h"
 #include "VideoCommon/PixelShaderManager.h"
 #include "VideoCommon/Statistics.h"
 #include "VideoCommon/VertexLoaderManager.h"
@@ -97,14 +97,6 @@ static u32 s_blendMode;
 
 static bool s_vsync;
 
-// EFB cache related
-static const u32 EFB_CACHE_RECT_SIZE = 64; // Cache 64x64 blocks.
-static const u32 EFB_CACHE_WIDTH = (EFB_WIDTH + EFB_CACHE_RECT_SIZE - 1) / EFB_CACHE_RECT_SIZE; // round up
-static const u32 EFB_CACHE_HEIGHT = (EFB_HEIGHT + EFB_CACHE_RECT_SIZE - 1) / EFB_CACHE_RECT_SIZE;
-static bool s_efbCacheValid[2][EFB_CACHE_WIDTH * EFB_CACHE_HEIGHT];
-static bool s_efbCacheIsCleared = false;
-static std::vector<u32> s_efbCache[2][EFB_CACHE_WIDTH * EFB_CACHE_HEIGHT]; // 2 for PEEK_Z and PEEK_COLOR
-
 static int GetNumMSAASamples(int MSAAMode)
 {
 	int samples;
@@ -669,7 +661,7 @@ Renderer::Renderer()
 		}
 	}
 	UpdateActiveConfig();
-	ClearEFBCache();
+	EFBCache::Invalidate();
 }
 
 Renderer::~Renderer()
@@ -907,21 +899,9 @@ void Renderer::SetColorMask()
 	glColorMask(ColorMask,  ColorMask,  ColorMask,  AlphaMask);
 }
 
-void ClearEFBCache()
+void Renderer::UpdateEFBCache(EFBAccessType type, const EFBRectangle& efbPixelRc, const TargetRectangle& targetPixelRc, const u32* data)
 {
-	if (!s_efbCacheIsCleared)
-	{
-		s_efbCacheIsCleared = true;
-		memset(s_efbCacheValid, 0, sizeof(s_efbCacheValid));
-	}
-}
-
-void Renderer::UpdateEFBCache(EFBAccessType type, u32 cacheRectIdx, const EFBRectangle& efbPixelRc, const TargetRectangle& targetPixelRc, const u32* data)
-{
-	u32 cacheType = (type == PEEK_Z ? 0 : 1);
-
-	if (!s_efbCache[cacheType][cacheRectIdx].size())
-		s_efbCache[cacheType][cacheRectIdx].resize(EFB_CACHE_RECT_SIZE * EFB_CACHE_RECT_SIZE);
+	static u32 s_tile[EFBCache::TILE_SIZE * EFBCache::TILE_SIZE];
 
 	u32 targetPixelRcWidth = targetPixelRc.right - targetPixelRc.left;
 	u32 efbPixelRcHeight = efbPixelRc.bottom - efbPixelRc.top;
@@ -938,12 +918,46 @@ void Renderer::UpdateEFBCache(EFBAccessType type, u32 cacheRectIdx, const EFBRec
 			u32 xEFB = efbPixelRc.left + xCache;
 			u32 xPixel = (EFBToScaledX(xEFB) + EFBToScaledX(xEFB + 1)) / 2;
 			u32 xData = xPixel - targetPixelRc.left;
-			s_efbCache[cacheType][cacheRectIdx][yCache * EFB_CACHE_RECT_SIZE + xCache] = data[yData * targetPixelRcWidth + xData];
+			u32 value = data[yData * targetPixelRcWidth + xData];
+			s_tile[yCache * EFBCache::TILE_SIZE + xCache] = type == PEEK_Z ? ConvertPeekedDepth(value) : ConvertPeekedColor(value);
 		}
 	}
 
-	s_efbCacheValid[cacheType][cacheRectIdx] = true;
-	s_efbCacheIsCleared = false;
+	EFBCache::StoreTile(type, efbPixelRc.left, efbPixelRc.top, s_tile);
+}
+
+// Scale the 32-bit value returned by glReadPixels to a 24-bit
+// value (GC uses a 24-bit Z-buffer).
+u32 Renderer::ConvertPeekedDepth(u32 z)
+{
+	float val = z / float(0xFFFFFFFF);
+	if (bpmem.zcontrol.pixel_format == PEControl::RGB565_Z16)
+	{
+		// if Z is in 16 bit format you must return a 16 bit integer
+		return MathUtil::Clamp<u32>((u32)(val * 65536.0f), 0, 0xFFFF);
+	}
+	else
+	{
+		return MathUtil::Clamp<u32>((u32)(val * 16777216.0f), 0, 0xFFFFFF);
+	}
+}
+
+// Although it may sound strange, this really is A8R8G8B8 and not RGBA or 24-bit...
+u32 Renderer::ConvertPeekedColor(u32 color)
+{
+	if (bpmem.zcontrol.pixel_format == PEControl::RGBA6_Z24)
+	{
+		color = RGBA8ToRGBA6ToRGBA8(color);
+	}
+	else if (bpmem.zcontrol.pixel_format == PEControl::RGB565_Z16)
+	{
+		color = RGBA8ToRGB565ToRGBA8(color);
+	}
+	if (bpmem.zcontrol.pixel_format != PEControl::RGBA6_Z24)
+	{
+		color |= 0xFF000000;
+	}
+	return color;
 }
 
 // This function allows the CPU to directly access the EFB.
@@ -951,7 +965,7 @@ void Renderer::UpdateEFBCache(EFBAccessType type, u32 cacheRectIdx, const EFBRec
 // and EFB pokes (which will change the color or depth of a pixel).
 //
 // The behavior of EFB peeks can only be modified by:
-// - GX_PokeAlphaRead
+// - GX_PokeAlphaRead, which is applied by the caller
 // The behavior of EFB pokes can be modified by:
 // - GX_PokeAlphaMode (TODO)
 // - GX_PokeAlphaUpdate (TODO)
@@ -962,195 +976,101 @@ void Renderer::UpdateEFBCache(EFBAccessType type, u32 cacheRectIdx, const EFBRec
 // - GX_PokeZMode (TODO)
 u32 Renderer::AccessEFB(EFBAccessType type, u32 x, u32 y, u32 poke_data)
 {
-	u32 cacheRectIdx = (y / EFB_CACHE_RECT_SIZE) * EFB_CACHE_WIDTH
-	                 + (x / EFB_CACHE_RECT_SIZE);
-
-	EFBRectangle efbPixelRc;
-
-	if (type == PEEK_COLOR || type == PEEK_Z)
+	if (type == POKE_COLOR || type == POKE_Z)
 	{
-		// Get the rectangular target region containing the EFB pixel
-		efbPixelRc.left = (x / EFB_CACHE_RECT_SIZE) * EFB_CACHE_RECT_SIZE;
-		efbPixelRc.top = (y / EFB_CACHE_RECT_SIZE) * EFB_CACHE_RECT_SIZE;
-		efbPixelRc.right = std::min(efbPixelRc.left + EFB_CACHE_RECT_SIZE, (u32)EFB_WIDTH);
-		efbPixelRc.bottom = std::min(efbPixelRc.top + EFB_CACHE_RECT_SIZE, (u32)EFB_HEIGHT);
-	}
-	else
-	{
-		efbPixelRc.left = x;
-		efbPixelRc.top = y;
-		efbPixelRc.right = x+1;
-		efbPixelRc.bottom = y+1;
+		EfbPokeData poke = { (u16)x, (u16)y, poke_data };
+		PokeEFB(type, &poke, 1);
+		return 0;
 	}
 
+	// The whole tile containing the pixel is read back and cached, as games
+	// tend to peek at many pixels close to each other.
+	u32 value = 0;
+	if (EFBCache::Lookup(type, x, y, &value))
+		return value;
+
+	EFBRectangle efbPixelRc = EFBCache::GetTileRect(x, y);
 	TargetRectangle targetPixelRc = ConvertEFBRectangle(efbPixelRc);
 	u32 targetPixelRcWidth = targetPixelRc.right - targetPixelRc.left;
 	u32 targetPixelRcHeight = targetPixelRc.top - targetPixelRc.bottom;
 
 	// TODO (FIX) : currently, AA path is broken/offset and doesn't return the correct pixel
-	switch (type)
+	if (s_MSAASamples > 1)
 	{
-	case PEEK_Z:
-		{
-			if (!s_efbCacheValid[0][cacheRectIdx])
-			{
-				if (s_MSAASamples > 1)
-				{
-					g_renderer->ResetAPIState();
-
-					// Resolve our rectangle.
-					FramebufferManager::GetEFBDepthTexture(efbPixelRc);
-					glBindFramebuffer(GL_READ_FRAMEBUFFER, FramebufferManager::GetResolvedFramebuffer());
-
-					g_renderer->RestoreAPIState();
-				}
-
-				std::unique_ptr<u32> depthMap(new u32[targetPixelRcWidth * targetPixelRcHeight]);
-
-				glReadPixels(targetPixelRc.left, targetPixelRc.bottom, targetPixelRcWidth, targetPixelRcHeight,
-				             GL_DEPTH_COMPONENT, GL_UNSIGNED_INT, depthMap.get());
-
-				UpdateEFBCache(type, cacheRectIdx, efbPixelRc, targetPixelRc, depthMap.get());
-			}
-
-			u32 xRect = x % EFB_CACHE_RECT_SIZE;
-			u32 yRect = y % EFB_CACHE_RECT_SIZE;
-			u32 z = s_efbCache[0][cacheRectIdx][yRect * EFB_CACHE_RECT_SIZE + xRect];
+		g_renderer->ResetAPIState();
 
-			// Scale the 32-bit value returned by glReadPixels to a 24-bit
-			// value (GC uses a 24-bit Z-buffer).
-			float val = z / float(0xFFFFFFFF);
-			u32 ret = 0;
-			if (bpmem.zcontrol.pixel_format == PEControl::RGB565_Z16)
-			{
-				// if Z is in 16 bit format you must return a 16 bit integer
-				ret = MathUtil::Clamp<u32>((u32)(val * 65536.0f), 0, 0xFFFF);
-			}
-			else
-			{
-				ret = MathUtil::Clamp<u32>((u32)(val * 16777216.0f), 0, 0xFFFFFF);
-			}
-			return ret;
-		}
-
-	case PEEK_COLOR: // GXPeekARGB
-		{
-			// Although it may sound strange, this really is A8R8G8B8 and not RGBA or 24-bit...
-
-			// Tested in Killer 7, the first 8bits represent the alpha value which is used to
-			// determine if we're aiming at an enemy (0x80 / 0x88) or not (0x70)
-			// Wind Waker is also using it for the pictograph to determine the color of each pixel
-			if (!s_efbCacheValid[1][cacheRectIdx])
-			{
-				if (s_MSAASamples > 1)
-				{
-					g_renderer->ResetAPIState();
-
-					// Resolve our rectangle.
-					FramebufferManager::GetEFBColorTexture(efbPixelRc);
-					glBindFramebuffer(GL_READ_FRAMEBUFFER, FramebufferManager::GetResolvedFramebuffer());
-
-					g_renderer->RestoreAPIState();
-				}
-
-				std::unique_ptr<u32> colorMap(new u32[targetPixelRcWidth * targetPixelRcHeight]);
-
-				if (GLInterface->GetMode() == GLInterfaceMode::MODE_OPENGLES3)
-				// XXX: Swap colours
-					glReadPixels(targetPixelRc.left, targetPixelRc.bottom, targetPixelRcWidth, targetPixelRcHeight,
-						     GL_RGBA, GL_UNSIGNED_BYTE, colorMap.get());
-				else
-					glReadPixels(targetPixelRc.left, targetPixelRc.bottom, targetPixelRcWidth, targetPixelRcHeight,
-						     GL_BGRA, GL_UNSIGNED_INT_8_8_8_8_REV, colorMap.get());
-
-				UpdateEFBCache(type, cacheRectIdx, efbPixelRc, targetPixelRc, colorMap.get());
-			}
-
-			u32 xRect = x % EFB_CACHE_RECT_SIZE;
-			u32 yRect = y % EFB_CACHE_RECT_SIZE;
-			u32 color = s_efbCache[1][cacheRectIdx][yRect * EFB_CACHE_RECT_SIZE + xRect];
-
-			// check what to do with the alpha channel (GX_PokeAlphaRead)
-			PixelEngine::UPEAlphaReadReg alpha_read_mode = PixelEngine::GetAlphaReadMode();
-
-			if (bpmem.zcontrol.pixel_format == PEControl::RGBA6_Z24)
-			{
-				color = RGBA8ToRGBA6ToRGBA8(color);
-			}
-			else if (bpmem.zcontrol.pixel_format == PEControl::RGB565_Z16)
-			{
-				color = RGBA8ToRGB565ToRGBA8(color);
-			}
-			if (bpmem.zcontrol.pixel_format != PEControl::RGBA6_Z24)
-			{
-				color |= 0xFF000000;
-			}
-			if (alpha_read_mode.ReadMode == 2)
-			{
-				// GX_READ_NONE
-				return color;
-			}
-			else if (alpha_read_mode.ReadMode == 1)
-			{
-				// GX_READ_FF
-				return (color | 0xFF000000);
-			}
-			else /*if(alpha_read_mode.ReadMode == 0)*/
-			{
-				// GX_READ_00
-				return (color & 0x00FFFFFF);
-			}
-		}
+		// Resolve our rectangle.
+		if (type == PEEK_Z)
+			FramebufferManager::GetEFBDepthTexture(efbPixelRc);
+		else
+			FramebufferManager::GetEFBColorTexture(efbPixelRc);
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, FramebufferManager::GetResolvedFramebuffer());
 
-	case POKE_COLOR:
-	{
-		ResetAPIState();
+		g_renderer->RestoreAPIState();
+	}
 
-		glClearColor(float((poke_data >> 16) & 0xFF) / 255.0f,
-		             float((poke_data >>  8) & 0xFF) / 255.0f,
-		             float((poke_data >>  0) & 0xFF) / 255.0f,
-		             float((poke_data >> 24) & 0xFF) / 255.0f);
+	std::unique_ptr<u32[]> data(new u32[targetPixelRcWidth * targetPixelRcHeight]);
 
-		glEnable(GL_SCISSOR_TEST);
-		glScissor(targetPixelRc.left, targetPixelRc.bottom, targetPixelRc.GetWidth(), targetPixelRc.GetHeight());
+	if (type == PEEK_Z)
+		glReadPixels(targetPixelRc.left, targetPixelRc.bottom, targetPixelRcWidth, targetPixelRcHeight,
+		             GL_DEPTH_COMPONENT, GL_UNSIGNED_INT, data.get());
+	else if (GLInterface->GetMode() == GLInterfaceMode::MODE_OPENGLES3)
+		// XXX: Swap colours
+		glReadPixels(targetPixelRc.left, targetPixelRc.bottom, targetPixelRcWidth, targetPixelRcHeight,
+		             GL_RGBA, GL_UNSIGNED_BYTE, data.get());
+	else
+		glReadPixels(targetPixelRc.left, targetPixelRc.bottom, targetPixelRcWidth, targetPixelRcHeight,
+		             GL_BGRA, GL_UNSIGNED_INT_8_8_8_8_REV, data.get());
 
-		glClear(GL_COLOR_BUFFER_BIT);
+	UpdateEFBCache(type, efbPixelRc, targetPixelRc, data.get());
 
-		RestoreAPIState();
+	EFBCache::Lookup(type, x, y, &value);
+	return value;
+}
 
-		// TODO: Could just update the EFB cache with the new value
-		ClearEFBCache();
+// All pokes in a batch are cleared with one reset of the API state.
+void Renderer::PokeEFB(EFBAccessType type, const EfbPokeData* points, size_t num_points)
+{
+	ResetAPIState();
 
-		break;
-	}
+	glEnable(GL_SCISSOR_TEST);
+	if (type == POKE_Z)
+		glDepthMask(GL_TRUE);
 
-	case POKE_Z:
+	for (size_t i = 0; i < num_points; ++i)
 	{
-		ResetAPIState();
-
-		glDepthMask(GL_TRUE);
-		glClearDepthf(float(poke_data & 0xFFFFFF) / 16777216.0f);
+		const EfbPokeData& point = points[i];
 
-		glEnable(GL_SCISSOR_TEST);
+		EFBRectangle efbPixelRc;
+		efbPixelRc.left = point.x;
+		efbPixelRc.top = point.y;
+		efbPixelRc.right = point.x + 1;
+		efbPixelRc.bottom = point.y + 1;
+		TargetRectangle targetPixelRc = ConvertEFBRectangle(efbPixelRc);
 		glScissor(targetPixelRc.left, targetPixelRc.bottom, targetPixelRc.GetWidth(), targetPixelRc.GetHeight());
 
-		glClear(GL_DEPTH_BUFFER_BIT);
-
-		RestoreAPIState();
-
-		// TODO: Could just update the EFB cache with the new value
-		ClearEFBCache();
-
-		break;
+		if (type == POKE_COLOR)
+		{
+			glClearColor(float((point.data >> 16) & 0xFF) / 255.0f,
+			             float((point.data >>  8) & 0xFF) / 255.0f,
+			             float((point.data >>  0) & 0xFF) / 255.0f,
+			             float((point.data >> 24) & 0xFF) / 255.0f);
+			glClear(GL_COLOR_BUFFER_BIT);
+		}
+		else
+		{
+			glClearDepthf(float(point.data & 0xFFFFFF) / 16777216.0f);
+			glClear(GL_DEPTH_BUFFER_BIT);
+		}
 	}
 
-	default:
-		break;
-	}
+	RestoreAPIState();
 
-	return 0;
+	// TODO: Could just update the EFB cache with the new values
+	EFBCache::Invalidate();
 }
 
+
 u16 Renderer::BBoxRead(int index)
 {
 	int swapped_index = index;
@@ -1276,7 +1196,7 @@ void Renderer::ClearScreen(const EFBRectangle& rc, bool colorEnable, bool alphaE
 
 	RestoreAPIState();
 
-	ClearEFBCache();
+	EFBCache::Invalidate();
 }
 
 void Renderer::BlitScreen(TargetRectangle src, TargetRectangle dst, GLuint src_texture, int src_width, int src_height)
@@ -1736,7 +1656,7 @@ void Renderer::SwapImpl(u32 xfbAddr, u32 fbWidth, u32 fbStride, u32 fbHeight, co
 	//	      GetTargetWidth(), GetTargetHeight());
 
 	// Invalidate EFB cache
-	ClearEFBCache();
+	EFBCache::Invalidate();
 }
 
 // ALWAYS call RestoreAPIState for each ResetAPIState call you're doing
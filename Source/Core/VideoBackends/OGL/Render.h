@@ -6,8 +6,6 @@
 namespace OGL
 {
 
-void ClearEFBCache();
-
 enum GLSL_VERSION
 {
 	GLSL_130,
@@ -71,6 +69,7 @@ public:
 	void FlipImageData(u8 *data, int w, int h, int pixel_width = 3);
 
 	u32 AccessEFB(EFBAccessType type, u32 x, u32 y, u32 poke_data) override;
+	void PokeEFB(EFBAccessType type, const EfbPokeData* points, size_t num_points) override;
 
 	u16 BBoxRead(int index) override;
 	void BBoxWrite(int index, u16 value) override;
@@ -91,7 +90,9 @@ public:
 	int GetMaxTextureSize() override;
 
 private:
-	void UpdateEFBCache(EFBAccessType type, u32 cacheRectIdx, const EFBRectangle& efbPixelRc, const TargetRectangle& targetPixelRc, const u32* data);
+	void UpdateEFBCache(EFBAccessType type, const EFBRectangle& efbPixelRc, const TargetRectangle& targetPixelRc, const u32* data);
+	static u32 ConvertPeekedDepth(u32 z);
+	static u32 ConvertPeekedColor(u32 color);
 
 	void BlitScreen(TargetRectangle src, TargetRectangle dst, GLuint src_texture, int src_width, int src_height);
 };
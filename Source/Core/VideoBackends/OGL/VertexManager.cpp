@@ -19,6 +19,7 @@
 
 #include "VideoCommon/BPMemory.h"
 #include "VideoCommon/DriverDetails.h"
+#include "VideoCommon/EFBCache.h"
 #include "VideoCommon/Fifo.h"
 #include "VideoCommon/ImageWrite.h"
 #include "VideoCommon/IndexGenerator.h"
@@ -222,7 +223,7 @@ void VertexManager::vFlush(bool useDstAlpha)
 #endif
 	g_Config.iSaveTargetId++;
 
-	ClearEFBCache();
+	EFBCache::Invalidate();
 }
 
 
@@ -29,7 +29,9 @@ namespace EfbCopy
 {
 	static void CopyToXfb(u32 xfbAddr, u32 fbWidth, u32 fbHeight, const EFBRectangle& sourceRc, float Gamma)
 	{
-		GLInterface->Update(); // update the render window position and the backbuffer size
+		// There's no window when replaying fifologs headlessly.
+		if (GLInterface)
+			GLInterface->Update(); // update the render window position and the backbuffer size
 
 		if (!g_SWVideoConfig.bHwRasterizer)
 		{
@@ -2,6 +2,8 @@
 // Licensed under GPLv2
 // Refer to the license.txt file included.
 
+#include <algorithm>
+
 #include "Common/ChunkFile.h"
 #include "Common/CommonTypes.h"
 #include "Core/HW/Memmap.h"
@@ -13,6 +15,7 @@
 #include "VideoBackends/Software/SWStatistics.h"
 #include "VideoBackends/Software/SWVertexLoader.h"
 #include "VideoBackends/Software/SWVideoConfig.h"
+#include "VideoBackends/Software/TextureSampler.h"
 #include "VideoBackends/Software/XFMemLoader.h"
 #include "VideoCommon/Fifo.h"
 #include "VideoCommon/VertexLoaderUtils.h"
@@ -64,12 +67,9 @@ static void DecodePrimitiveStream(u32 iBufferSize)
 	}
 	else
 	{
-		while (streamSize > 0 && iBufferSize >= vertexSize)
-		{
-			vertexLoader.LoadVertex();
-			iBufferSize -= vertexSize;
-			streamSize--;
-		}
+		u32 count = vertexSize ? std::min<u32>(streamSize, iBufferSize / vertexSize) : streamSize;
+		vertexLoader.LoadVertices(count);
+		streamSize -= count;
 	}
 
 	if (streamSize == 0)
@@ -124,6 +124,7 @@ static void DecodeStandard(u32 bufferSize)
 
 	if (Cmd == GX_NOP)
 		return;
+	INCSTAT(swstats.thisFrame.numCommands);
 	// Causes a SIGBUS error on Android
 	// XXX: Investigate
 #ifndef ANDROID
@@ -209,6 +210,10 @@ static void DecodeStandard(u32 bufferSize)
 			u8 primitiveType = (Cmd & GX_PRIMITIVE_MASK) >> GX_PRIMITIVE_SHIFT;
 			vertexLoader.SetFormat(vatIndex, primitiveType);
 
+			// The textures may have been changed since the last draw, by the
+			// CPU, EFB copies or loads into TMEM.
+			TextureSampler::InvalidateCache();
+
 			// switch to primitive processing
 			streamSize = DataReadU16();
 			currentFunction = DecodePrimitiveStream;
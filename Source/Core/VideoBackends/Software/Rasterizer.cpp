@@ -120,7 +120,8 @@ void SetTevReg(int reg, int comp, bool konst, s16 color)
 	tev.SetRegColor(reg, comp, konst, color);
 }
 
-inline void Draw(s32 x, s32 y, s32 xi, s32 yi)
+// Computes the inputs of the pixel, returns false if it fails the early depth test.
+static inline bool SetupPixel(s32 x, s32 y, s32 xi, s32 yi, Tev::PixelInputs* inputs)
 {
 	INCSTAT(swstats.thisFrame.rasterizedPixels);
 
@@ -137,16 +138,16 @@ inline void Draw(s32 x, s32 y, s32 xi, s32 yi)
 		{
 			// early z
 			if (!EfbInterface::ZCompare(x, y, z))
-				return;
+				return false;
 		}
 		EfbInterface::IncPerfCounterQuadCount(PQ_ZCOMP_OUTPUT_ZCOMPLOC);
 	}
 
 	RasterBlockPixel& pixel = rasterBlock.Pixel[xi][yi];
 
-	tev.Position[0] = x;
-	tev.Position[1] = y;
-	tev.Position[2] = z;
+	inputs->Position[0] = x;
+	inputs->Position[1] = y;
+	inputs->Position[2] = z;
 
 	//  colors
 	for (unsigned int i = 0; i < bpmem.genMode.numcolchans; i++)
@@ -158,7 +159,7 @@ inline void Draw(s32 x, s32 y, s32 xi, s32 yi)
 			// clamp color value to 0
 			u16 mask = ~(color >> 8);
 
-			tev.Color[i][comp] = color & mask;
+			inputs->Color[i][comp] = color & mask;
 		}
 	}
 
@@ -166,10 +167,19 @@ inline void Draw(s32 x, s32 y, s32 xi, s32 yi)
 	for (unsigned int i = 0; i < bpmem.genMode.numtexgens; i++)
 	{
 		// multiply by 128 because TEV stores UVs as s17.7
-		tev.Uv[i].s = (s32)(pixel.Uv[i][0] * 128);
-		tev.Uv[i].t = (s32)(pixel.Uv[i][1] * 128);
+		inputs->Uv[i].s = (s32)(pixel.Uv[i][0] * 128);
+		inputs->Uv[i].t = (s32)(pixel.Uv[i][1] * 128);
 	}
 
+	return true;
+}
+
+// Draws the first count pixels of tev.Quad, which are all in the current block.
+static inline void DrawPixels(int count)
+{
+	if (count == 0)
+		return;
+
 	for (unsigned int i = 0; i < bpmem.genMode.numindstages; i++)
 	{
 		tev.IndirectLod[i] = rasterBlock.IndirectLod[i];
@@ -182,7 +192,13 @@ inline void Draw(s32 x, s32 y, s32 xi, s32 yi)
 		tev.TextureLinear[i] = rasterBlock.TextureLinear[i];
 	}
 
-	tev.Draw();
+	tev.DrawQuad(count);
+}
+
+inline void Draw(s32 x, s32 y, s32 xi, s32 yi)
+{
+	if (SetupPixel(x, y, xi, yi, &tev.Quad[0]))
+		DrawPixels(1);
 }
 
 static void InitTriangle(float X1, float Y1, s32 xi, s32 yi)
@@ -468,6 +484,9 @@ void DrawTriangleFrontFace(OutputVertexData *v0, OutputVertexData *v1, OutputVer
 
 				BuildBlock(x, y);
 
+				// The pixels of the block are shaded together
+				int count = 0;
+
 				// Accept whole block when totally covered
 				if (a == 0xF && b == 0xF && c == 0xF)
 				{
@@ -475,7 +494,8 @@ void DrawTriangleFrontFace(OutputVertexData *v0, OutputVertexData *v1, OutputVer
 					{
 						for (s32 ix = 0; ix < BLOCK_SIZE; ix++)
 						{
-							Draw(x + ix, y + iy, ix, iy);
+							if (SetupPixel(x + ix, y + iy, ix, iy, &tev.Quad[count]))
+								count++;
 						}
 					}
 				}
@@ -493,9 +513,9 @@ void DrawTriangleFrontFace(OutputVertexData *v0, OutputVertexData *v1, OutputVer
 
 						for (s32 ix = 0; ix < BLOCK_SIZE; ix++)
 						{
-							if (CX1 > 0 && CX2 > 0 && CX3 > 0)
+							if (CX1 > 0 && CX2 > 0 && CX3 > 0 && SetupPixel(x + ix, y + iy, ix, iy, &tev.Quad[count]))
 							{
-								Draw(x + ix, y + iy, ix, iy);
+								count++;
 							}
 
 							CX1 -= FDY12;
@@ -508,6 +528,8 @@ void DrawTriangleFrontFace(OutputVertexData *v0, OutputVertexData *v1, OutputVer
 						CY3 += FDX31;
 					}
 				}
+
+				DrawPixels(count);
 			}
 		}
 	}
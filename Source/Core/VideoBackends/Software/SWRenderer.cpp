@@ -133,6 +133,7 @@ void SWRenderer::DrawDebugText()
 
 	if (g_SWVideoConfig.bShowStats)
 	{
+		debugtext += StringFromFormat("Commands:           %i\n", swstats.thisFrame.numCommands);
 		debugtext += StringFromFormat("Objects:            %i\n", swstats.thisFrame.numDrawnObjects);
 		debugtext += StringFromFormat("Primitives:         %i\n", swstats.thisFrame.numPrimatives);
 		debugtext += StringFromFormat("Vertices Loaded:    %i\n", swstats.thisFrame.numVerticesLoaded);
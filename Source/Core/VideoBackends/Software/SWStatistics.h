@@ -11,6 +11,7 @@ struct SWStatistics
 {
 	struct ThisFrame
 	{
+		u32 numCommands;
 		u32 numDrawnObjects;
 		u32 numPrimatives;
 		u32 numVerticesLoaded;
@@ -2,6 +2,7 @@
 // Licensed under GPLv2
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <limits>
 
 #include "Common/ChunkFile.h"
@@ -140,9 +141,9 @@ static void ReadVertexAttribute(T* dst, DataReader src, const AttributeFormat& f
 	}
 }
 
-void SWVertexLoader::ParseVertex(const PortableVertexDeclaration& vdec)
+void SWVertexLoader::ParseVertex(const PortableVertexDeclaration& vdec, u8* data)
 {
-	DataReader src(m_LoadedVertices.data(), m_LoadedVertices.data() + m_LoadedVertices.size());
+	DataReader src(data, data + vdec.stride);
 
 	ReadVertexAttribute<float>(&m_Vertex.position[0], src, vdec.position, 0, 3, false);
 
@@ -170,42 +171,80 @@ void SWVertexLoader::ParseVertex(const PortableVertexDeclaration& vdec)
 	ReadVertexAttribute<u8>(&m_Vertex.posMtx, src, vdec.posmtx, 0, 1, false);
 }
 
-void SWVertexLoader::LoadVertex()
+void SWVertexLoader::LoadVertices(u32 count)
 {
+	// Vertices are transformed in batches of this size, which keeps the
+	// buffers small for long primitives.
+	const u32 BATCH_SIZE = 256;
+
 	const PortableVertexDeclaration& vdec = m_CurrentLoader->m_native_vtx_decl;
+	const bool has_normal = g_main_cp_state.vtx_desc.Normal != NOT_PRESENT;
+	const bool nbt = m_CurrentVat->g0.NormalElements != 0;
 
-	// reserve memory for the destination of the vertex loader
-	m_LoadedVertices.resize(vdec.stride + 4);
+	while (count > 0)
+	{
+		u32 batch_size = std::min(count, BATCH_SIZE);
+		count -= batch_size;
+
+		// reserve memory for the destination of the vertex loader
+		m_LoadedVertices.resize(vdec.stride * batch_size + 4);
+
+		// convert the vertices from the gc format to the videocommon (hardware optimized) format
+		u8* old = g_video_buffer_read_ptr;
+		int converted_vertices = m_CurrentLoader->RunVertices(
+			DataReader(g_video_buffer_read_ptr, nullptr), // src
+			DataReader(m_LoadedVertices.data(), m_LoadedVertices.data() + m_LoadedVertices.size()), // dst
+			batch_size, m_primitiveType
+		);
+		g_video_buffer_read_ptr = old + m_CurrentLoader->m_VertexSize * batch_size;
+
+		if (converted_vertices <= 0)
+			continue;
+
+		// parse the videocommon format to our own struct format. Attributes that
+		// aren't present keep the values of the previous vertex.
+		m_InputVertices.resize(converted_vertices);
+		for (int i = 0; i < converted_vertices; i++)
+		{
+			ParseVertex(vdec, &m_LoadedVertices[i * vdec.stride]);
+			m_InputVertices[i] = m_Vertex;
+		}
 
-	// convert the vertex from the gc format to the videocommon (hardware optimized) format
-	u8* old = g_video_buffer_read_ptr;
-	int converted_vertices = m_CurrentLoader->RunVertices(
-		DataReader(g_video_buffer_read_ptr, nullptr), // src
-		DataReader(m_LoadedVertices.data(), m_LoadedVertices.data() + m_LoadedVertices.size()), // dst
-		1, m_primitiveType
-	);
-	g_video_buffer_read_ptr = old + m_CurrentLoader->m_VertexSize;
+		// transform the positions and normals of the whole batch
+		m_TransformedVertices.resize(converted_vertices);
+		TransformUnit::TransformPositions(m_InputVertices.data(), m_TransformedVertices.data(), converted_vertices);
+		if (has_normal)
+			TransformUnit::TransformNormals(m_InputVertices.data(), nbt, m_TransformedVertices.data(), converted_vertices);
 
-	if (converted_vertices == 0)
-		return;
+		for (int i = 0; i < converted_vertices; i++)
+		{
+			const InputVertexData& vertex = m_InputVertices[i];
+			const OutputVertexData& transformed = m_TransformedVertices[i];
+
+			// Lighting and texture coordinates use what the vertex slot of the
+			// setup unit holds, including normals of earlier vertices if this
+			// one has none, so they are done per vertex.
+			OutputVertexData* outVertex = m_SetupUnit->GetVertex();
+			outVertex->mvPosition = transformed.mvPosition;
+			outVertex->projectedPosition = transformed.projectedPosition;
+			if (has_normal)
+			{
+				outVertex->normal[0] = transformed.normal[0];
+				if (nbt)
+				{
+					outVertex->normal[1] = transformed.normal[1];
+					outVertex->normal[2] = transformed.normal[2];
+				}
+			}
+			TransformUnit::TransformColor(&vertex, outVertex);
+			TransformUnit::TransformTexCoord(&vertex, outVertex, m_TexGenSpecialCase);
 
-	// parse the videocommon format to our own struct format (m_Vertex)
-	ParseVertex(vdec);
+			// assemble and rasterize the primitive
+			m_SetupUnit->SetupVertex();
 
-	// transform this vertex so that it can be used for rasterization (outVertex)
-	OutputVertexData* outVertex = m_SetupUnit->GetVertex();
-	TransformUnit::TransformPosition(&m_Vertex, outVertex);
-	if (g_main_cp_state.vtx_desc.Normal != NOT_PRESENT)
-	{
-		TransformUnit::TransformNormal(&m_Vertex, m_CurrentVat->g0.NormalElements, outVertex);
+			INCSTAT(swstats.thisFrame.numVerticesLoaded)
+		}
 	}
-	TransformUnit::TransformColor(&m_Vertex, outVertex);
-	TransformUnit::TransformTexCoord(&m_Vertex, outVertex, m_TexGenSpecialCase);
-
-	// assemble and rasterize the primitive
-	m_SetupUnit->SetupVertex();
-
-	INCSTAT(swstats.thisFrame.numVerticesLoaded)
 }
 
 void SWVertexLoader::DoState(PointerWrap &p)
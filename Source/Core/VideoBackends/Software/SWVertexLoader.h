@@ -6,6 +6,7 @@
 
 #include <memory>
 #include <unordered_map>
+#include <vector>
 
 #include "Common/CommonTypes.h"
 
@@ -25,7 +26,7 @@ class SWVertexLoader
 
 	InputVertexData m_Vertex;
 
-	void ParseVertex(const PortableVertexDeclaration& vdec);
+	void ParseVertex(const PortableVertexDeclaration& vdec, u8* data);
 
 	SetupUnit *m_SetupUnit;
 
@@ -33,6 +34,8 @@ class SWVertexLoader
 
 	std::unordered_map<VertexLoaderUID, std::unique_ptr<VertexLoaderBase>> m_VertexLoaderMap;
 	std::vector<u8> m_LoadedVertices;
+	std::vector<InputVertexData> m_InputVertices;
+	std::vector<OutputVertexData> m_TransformedVertices;
 	VertexLoaderBase* m_CurrentLoader;
 
 	u8 m_attributeIndex;
@@ -46,6 +49,7 @@ public:
 
 	u32 GetVertexSize() { return m_VertexSize; }
 
-	void LoadVertex();
+	// Loads, transforms and draws count vertices of the current primitive.
+	void LoadVertices(u32 count);
 	void DoState(PointerWrap &p);
 };
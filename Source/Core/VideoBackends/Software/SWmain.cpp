@@ -30,6 +30,7 @@
 #include "VideoBackends/Software/SWStatistics.h"
 #include "VideoBackends/Software/SWVertexLoader.h"
 #include "VideoBackends/Software/SWVideoConfig.h"
+#include "VideoBackends/Software/TextureSampler.h"
 #include "VideoBackends/Software/VideoBackend.h"
 #include "VideoBackends/Software/XFMemLoader.h"
 
@@ -157,6 +158,7 @@ void VideoSoftware::Shutdown()
 	// TODO: should be in Video_Cleanup
 	HwRasterizer::Shutdown();
 	SWRenderer::Shutdown();
+	TextureSampler::Shutdown();
 	DebugUtil::Shutdown();
 
 	// Do our OSD callbacks
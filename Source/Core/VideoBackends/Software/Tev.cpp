@@ -3,9 +3,11 @@
 // Refer to the license.txt file included.
 
 #include <cmath>
+#include <cstring>
 
 #include "Common/ChunkFile.h"
 #include "Common/CommonTypes.h"
+#include "Common/Intrinsics.h"
 #include "VideoBackends/Software/DebugUtil.h"
 #include "VideoBackends/Software/EfbInterface.h"
 #include "VideoBackends/Software/SWStatistics.h"
@@ -504,13 +506,8 @@ void Tev::Indirect(unsigned int stageNum, s32 s, s32 t)
 	}
 }
 
-void Tev::Draw()
+void Tev::SampleIndirectStages()
 {
-	_assert_(Position[0] >= 0 && Position[0] < EFB_WIDTH);
-	_assert_(Position[1] >= 0 && Position[1] < EFB_HEIGHT);
-
-	INCSTAT(swstats.thisFrame.tevPixelsIn);
-
 	for (unsigned int stageNum = 0; stageNum < bpmem.genMode.numindstages; stageNum++)
 	{
 		int stageNum2 = stageNum >> 1;
@@ -539,55 +536,72 @@ void Tev::Draw()
 		}
 #endif
 	}
+}
 
-	for (unsigned int stageNum = 0; stageNum <= bpmem.genMode.numtevstages; stageNum++)
-	{
-		int stageNum2 = stageNum >> 1;
-		int stageOdd = stageNum&1;
-		TwoTevStageOrders &order = bpmem.tevorders[stageNum2];
-		TevKSel &kSel = bpmem.tevksel[stageNum2];
+void Tev::SetStageInputs(unsigned int stageNum)
+{
+	int stageNum2 = stageNum >> 1;
+	int stageOdd = stageNum&1;
+	TwoTevStageOrders &order = bpmem.tevorders[stageNum2];
+	TevKSel &kSel = bpmem.tevksel[stageNum2];
 
-		// stage combiners
-		TevStageCombiner::ColorCombiner &cc = bpmem.combiners[stageNum].colorC;
-		TevStageCombiner::AlphaCombiner &ac = bpmem.combiners[stageNum].alphaC;
+	TevStageCombiner::AlphaCombiner &ac = bpmem.combiners[stageNum].alphaC;
 
-		int texcoordSel = order.getTexCoord(stageOdd);
-		int texmap = order.getTexMap(stageOdd);
+	int texcoordSel = order.getTexCoord(stageOdd);
+	int texmap = order.getTexMap(stageOdd);
 
-		Indirect(stageNum, Uv[texcoordSel].s, Uv[texcoordSel].t);
+	Indirect(stageNum, Uv[texcoordSel].s, Uv[texcoordSel].t);
 
-		// sample texture
-		if (order.getEnable(stageOdd))
-		{
-			// RGBA
-			u8 texel[4];
+	// sample texture
+	if (order.getEnable(stageOdd))
+	{
+		// RGBA
+		u8 texel[4];
 
-			TextureSampler::Sample(TexCoord.s, TexCoord.t, TextureLod[stageNum], TextureLinear[stageNum], texmap, texel);
+		TextureSampler::Sample(TexCoord.s, TexCoord.t, TextureLod[stageNum], TextureLinear[stageNum], texmap, texel);
 
 #if ALLOW_TEV_DUMPS
-			if (g_SWVideoConfig.bDumpTevTextureFetches)
-				DebugUtil::DrawTempBuffer(texel, DIRECT_TFETCH + stageNum);
+		if (g_SWVideoConfig.bDumpTevTextureFetches)
+			DebugUtil::DrawTempBuffer(texel, DIRECT_TFETCH + stageNum);
 #endif
 
-			int swaptable = ac.tswap * 2;
+		int swaptable = ac.tswap * 2;
 
-			TexColor[RED_C] = texel[bpmem.tevksel[swaptable].swap1];
-			TexColor[GRN_C] = texel[bpmem.tevksel[swaptable].swap2];
-			swaptable++;
-			TexColor[BLU_C] = texel[bpmem.tevksel[swaptable].swap1];
-			TexColor[ALP_C] = texel[bpmem.tevksel[swaptable].swap2];
-		}
+		TexColor[RED_C] = texel[bpmem.tevksel[swaptable].swap1];
+		TexColor[GRN_C] = texel[bpmem.tevksel[swaptable].swap2];
+		swaptable++;
+		TexColor[BLU_C] = texel[bpmem.tevksel[swaptable].swap1];
+		TexColor[ALP_C] = texel[bpmem.tevksel[swaptable].swap2];
+	}
 
-		// set konst for this stage
-		int kc = kSel.getKC(stageOdd);
-		int ka = kSel.getKA(stageOdd);
-		StageKonst[RED_C] = *(m_KonstLUT[kc][RED_C]);
-		StageKonst[GRN_C] = *(m_KonstLUT[kc][GRN_C]);
-		StageKonst[BLU_C] = *(m_KonstLUT[kc][BLU_C]);
-		StageKonst[ALP_C] = *(m_KonstLUT[ka][ALP_C]);
+	// set konst for this stage
+	int kc = kSel.getKC(stageOdd);
+	int ka = kSel.getKA(stageOdd);
+	StageKonst[RED_C] = *(m_KonstLUT[kc][RED_C]);
+	StageKonst[GRN_C] = *(m_KonstLUT[kc][GRN_C]);
+	StageKonst[BLU_C] = *(m_KonstLUT[kc][BLU_C]);
+	StageKonst[ALP_C] = *(m_KonstLUT[ka][ALP_C]);
 
-		// set color
-		SetRasColor(order.getColorChan(stageOdd), ac.rswap * 2);
+	// set color
+	SetRasColor(order.getColorChan(stageOdd), ac.rswap * 2);
+}
+
+void Tev::Draw()
+{
+	_assert_(Position[0] >= 0 && Position[0] < EFB_WIDTH);
+	_assert_(Position[1] >= 0 && Position[1] < EFB_HEIGHT);
+
+	INCSTAT(swstats.thisFrame.tevPixelsIn);
+
+	SampleIndirectStages();
+
+	for (unsigned int stageNum = 0; stageNum <= bpmem.genMode.numtevstages; stageNum++)
+	{
+		SetStageInputs(stageNum);
+
+		// stage combiners
+		TevStageCombiner::ColorCombiner &cc = bpmem.combiners[stageNum].colorC;
+		TevStageCombiner::AlphaCombiner &ac = bpmem.combiners[stageNum].alphaC;
 
 		// combine inputs
 		InputRegType inputs[4];
@@ -647,6 +661,11 @@ void Tev::Draw()
 	u32 alpha_index = bpmem.combiners[bpmem.genMode.numtevstages].alphaC.dest;
 	u8 output[4] = {(u8)Reg[alpha_index][ALP_C], (u8)Reg[color_index][BLU_C], (u8)Reg[color_index][GRN_C], (u8)Reg[color_index][RED_C]};
 
+	OutputPixel(output);
+}
+
+void Tev::OutputPixel(u8 output[4])
+{
 	if (!TevAlphaTest(output[ALP_C]))
 		return;
 
@@ -809,6 +828,370 @@ void Tev::Draw()
 	EfbInterface::BlendTev(Position[0], Position[1], output);
 }
 
+void Tev::LoadQuadPixel(int i)
+{
+	const PixelInputs& pixel = Quad[i];
+
+	Position[0] = pixel.Position[0];
+	Position[1] = pixel.Position[1];
+	Position[2] = pixel.Position[2];
+
+	// The rasterizer only sets the channels and coordinates in use, the others
+	// keep the values of earlier pixels.
+	for (unsigned int chan = 0; chan < bpmem.genMode.numcolchans; chan++)
+		memcpy(Color[chan], pixel.Color[chan], sizeof(Color[chan]));
+
+	for (unsigned int texgen = 0; texgen < bpmem.genMode.numtexgens; texgen++)
+		Uv[texgen] = pixel.Uv[texgen];
+}
+
+// What a stage reads or writes that can differ between pixels: bits 0-3 are
+// the colors of prev, c0, c1 and c2, bits 4-7 their alphas.
+enum
+{
+	TEXCOLOR_BIT = 1 << 8
+};
+
+static u32 ColorInputBits(u32 input)
+{
+	if (input < 8)
+		return ((input & 1) ? 0x10 : 0x01) << (input >> 1);
+	return (input < 10) ? TEXCOLOR_BIT : 0;
+}
+
+static u32 AlphaInputBits(u32 input)
+{
+	if (input < 4)
+		return 0x10 << input;
+	return (input == 4) ? TEXCOLOR_BIT : 0;
+}
+
+bool Tev::CanDrawQuad() const
+{
+#ifdef _M_X86
+#if ALLOW_TEV_DUMPS
+	if (g_SWVideoConfig.bDumpTevStages || g_SWVideoConfig.bDumpTevTextureFetches)
+		return false;
+#endif
+
+	// The texture coordinate of the first stage is only independent of the
+	// previous pixel if Indirect sets it.
+	TevStageIndirect& first = bpmem.tevind[0];
+	if (first.fb_addprev || ((first.mid & 3) && (first.mid & 12) == 12))
+		return false;
+
+	u32 written = 0;
+	u32 read_first = 0;
+	for (unsigned int stageNum = 0; stageNum <= bpmem.genMode.numtevstages; stageNum++)
+	{
+		TevStageCombiner::ColorCombiner& cc = bpmem.combiners[stageNum].colorC;
+		TevStageCombiner::AlphaCombiner& ac = bpmem.combiners[stageNum].alphaC;
+
+		if (bpmem.tevorders[stageNum >> 1].getEnable(stageNum & 1))
+			written |= TEXCOLOR_BIT;
+
+		u32 read = ColorInputBits(cc.a) | ColorInputBits(cc.b) | ColorInputBits(cc.c) | ColorInputBits(cc.d) |
+		           AlphaInputBits(ac.a) | AlphaInputBits(ac.b) | AlphaInputBits(ac.c) | AlphaInputBits(ac.d);
+		read_first |= read & ~written;
+		written |= (0x01 << cc.dest) | (0x10 << ac.dest);
+	}
+
+	// z textures use the texture color of the last stage that sampled one
+	if (bpmem.ztex2.op)
+		read_first |= TEXCOLOR_BIT & ~written;
+
+	return (read_first & written) == 0;
+#else
+	return false;
+#endif
+}
+
+void Tev::DrawQuad(int count)
+{
+#ifdef _M_X86
+	if (count > 1 && CanDrawQuad())
+	{
+		DrawQuadSIMD(count);
+		return;
+	}
+#endif
+
+	for (int i = 0; i < count; i++)
+	{
+		LoadQuadPixel(i);
+		Draw();
+	}
+}
+
+#ifdef _M_X86
+
+static inline __m128i Select(__m128i mask, __m128i a, __m128i b)
+{
+	return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+static inline __m128i ClampSIMD(__m128i x, s32 min, s32 max)
+{
+	const __m128i lo = _mm_set1_epi32(min);
+	const __m128i hi = _mm_set1_epi32(max);
+	x = Select(_mm_cmplt_epi32(x, lo), lo, x);
+	return Select(_mm_cmpgt_epi32(x, hi), hi, x);
+}
+
+// Same as storing into a signed bit field with the given width
+static inline __m128i SignExtend(__m128i x, int bits)
+{
+	const __m128i shift = _mm_cvtsi32_si128(32 - bits);
+	return _mm_sra_epi32(_mm_sll_epi32(x, shift), shift);
+}
+
+// DrawColorRegular and DrawAlphaRegular for one component of four pixels
+static inline __m128i CombineRegular(__m128i a, __m128i b, __m128i c, __m128i d,
+                                     s32 bias, int lshift, int rshift, s32 round, bool negate, bool alpha)
+{
+	const __m128i lshift_count = _mm_cvtsi32_si128(lshift);
+
+	c = _mm_add_epi32(c, _mm_srli_epi32(c, 7));
+
+	// a * (256 - c) + b * c, with a and b, and 256 - c and c, in the 16 bit halves
+	__m128i ab = _mm_or_si128(a, _mm_slli_epi32(b, 16));
+	__m128i weights = _mm_or_si128(_mm_sub_epi32(_mm_set1_epi32(256), c), _mm_slli_epi32(c, 16));
+	__m128i temp = _mm_madd_epi16(ab, weights);
+	temp = _mm_sll_epi32(temp, lshift_count);
+	temp = _mm_add_epi32(temp, _mm_set1_epi32(round));
+
+	// The alpha combiner negates before shifting, which rounds differently
+	if (negate && alpha)
+		temp = _mm_srai_epi32(_mm_sub_epi32(_mm_setzero_si128(), temp), 8);
+	else if (negate)
+		temp = _mm_sub_epi32(_mm_setzero_si128(), _mm_srai_epi32(temp, 8));
+	else
+		temp = _mm_srai_epi32(temp, 8);
+
+	__m128i result = _mm_sll_epi32(_mm_add_epi32(d, _mm_set1_epi32(bias)), lshift_count);
+	result = _mm_add_epi32(result, temp);
+	return _mm_sra_epi32(result, _mm_cvtsi32_si128(rshift));
+}
+
+// The values TEVCMP_R8, TEVCMP_GR16 and TEVCMP_BGR24 compare
+static inline __m128i CompareValue(const __m128i v[4], int mode)
+{
+	switch (mode)
+	{
+	case TEVCMP_R8:
+		return v[Tev::RED_C];
+	case TEVCMP_GR16:
+		return _mm_or_si128(_mm_slli_epi32(v[Tev::GRN_C], 8), v[Tev::RED_C]);
+	default:
+		return _mm_or_si128(_mm_or_si128(_mm_slli_epi32(v[Tev::BLU_C], 16), _mm_slli_epi32(v[Tev::GRN_C], 8)), v[Tev::RED_C]);
+	}
+}
+
+// DrawColorCompare and DrawAlphaCompare for one component of four pixels.
+// Mode TEVCMP_RGB8 compares the component itself, which is TEVCMP_A8 for alpha.
+static inline __m128i CombineCompare(const __m128i a[4], const __m128i b[4], __m128i c, __m128i d,
+                                     int component, int mode, bool equal)
+{
+	__m128i x = (mode == TEVCMP_RGB8) ? a[component] : CompareValue(a, mode);
+	__m128i y = (mode == TEVCMP_RGB8) ? b[component] : CompareValue(b, mode);
+	__m128i mask = equal ? _mm_cmpeq_epi32(x, y) : _mm_cmpgt_epi32(x, y);
+	return _mm_add_epi32(d, _mm_and_si128(c, mask));
+}
+
+void Tev::DrawQuadSIMD(int count)
+{
+	// What Draw keeps in members between the stages, for each pixel. Pixels past
+	// count are computed too, but never output.
+	u8 indirect_tex[4][4][4];
+	TextureCoordinateType tex_coord[4];
+	u8 alpha_bump[4];
+	s32 tex_color[4][4]; // [component][pixel]
+	s32 ras_color[4][4];
+
+	for (int i = 0; i < 4; i++)
+	{
+		tex_coord[i] = TexCoord;
+		alpha_bump[i] = AlphaBump;
+		for (int comp = 0; comp < 4; comp++)
+			tex_color[comp][i] = TexColor[comp];
+	}
+
+	for (int i = 0; i < count; i++)
+	{
+		LoadQuadPixel(i);
+
+		_assert_(Position[0] >= 0 && Position[0] < EFB_WIDTH);
+		_assert_(Position[1] >= 0 && Position[1] < EFB_HEIGHT);
+
+		INCSTAT(swstats.thisFrame.tevPixelsIn);
+
+		SampleIndirectStages();
+		memcpy(indirect_tex[i], IndirectTex, sizeof(IndirectTex));
+	}
+	for (int i = count; i < 4; i++)
+		memcpy(indirect_tex[i], IndirectTex, sizeof(IndirectTex));
+
+	__m128i reg[4][4];
+	for (int r = 0; r < 4; r++)
+		for (int comp = 0; comp < 4; comp++)
+			reg[r][comp] = _mm_set1_epi32(Reg[r][comp]);
+
+	__m128i tex[4];
+	__m128i ras[4];
+	__m128i konst[4];
+	const __m128i one = _mm_set1_epi32(FixedConstants[8]);
+	const __m128i half = _mm_set1_epi32(FixedConstants[4]);
+	const __m128i zero = _mm_setzero_si128();
+
+	// m_ColorInputLUT and m_AlphaInputLUT for the vectors
+	const __m128i* color_inputs[16][3];
+	const __m128i* alpha_inputs[8];
+	for (int i = 0; i < 3; i++)
+	{
+		for (int r = 0; r < 4; r++)
+		{
+			color_inputs[r * 2][i] = &reg[r][BLU_C + i];
+			color_inputs[r * 2 + 1][i] = &reg[r][ALP_C];
+		}
+		color_inputs[8][i] = &tex[BLU_C + i];
+		color_inputs[9][i] = &tex[ALP_C];
+		color_inputs[10][i] = &ras[BLU_C + i];
+		color_inputs[11][i] = &ras[ALP_C];
+		color_inputs[12][i] = &one;
+		color_inputs[13][i] = &half;
+		color_inputs[14][i] = &konst[BLU_C + i];
+		color_inputs[15][i] = &zero;
+	}
+	for (int r = 0; r < 4; r++)
+		alpha_inputs[r] = &reg[r][ALP_C];
+	alpha_inputs[4] = &tex[ALP_C];
+	alpha_inputs[5] = &ras[ALP_C];
+	alpha_inputs[6] = &konst[ALP_C];
+	alpha_inputs[7] = &zero;
+
+	const __m128i mask8 = _mm_set1_epi32(0xff);
+
+	for (unsigned int stageNum = 0; stageNum <= bpmem.genMode.numtevstages; stageNum++)
+	{
+		// Texture sampling and the rasterized color stay per pixel
+		for (int i = 0; i < count; i++)
+		{
+			LoadQuadPixel(i);
+			memcpy(IndirectTex, indirect_tex[i], sizeof(IndirectTex));
+			TexCoord = tex_coord[i];
+			AlphaBump = alpha_bump[i];
+			for (int comp = 0; comp < 4; comp++)
+				TexColor[comp] = tex_color[comp][i];
+
+			SetStageInputs(stageNum);
+
+			tex_coord[i] = TexCoord;
+			alpha_bump[i] = AlphaBump;
+			for (int comp = 0; comp < 4; comp++)
+			{
+				tex_color[comp][i] = TexColor[comp];
+				ras_color[comp][i] = RasColor[comp];
+			}
+		}
+		for (int i = count; i < 4; i++)
+		{
+			for (int comp = 0; comp < 4; comp++)
+				ras_color[comp][i] = RasColor[comp];
+		}
+
+		for (int comp = 0; comp < 4; comp++)
+		{
+			tex[comp] = _mm_loadu_si128((const __m128i*)tex_color[comp]);
+			ras[comp] = _mm_loadu_si128((const __m128i*)ras_color[comp]);
+			konst[comp] = _mm_set1_epi32(StageKonst[comp]);
+		}
+
+		TevStageCombiner::ColorCombiner &cc = bpmem.combiners[stageNum].colorC;
+		TevStageCombiner::AlphaCombiner &ac = bpmem.combiners[stageNum].alphaC;
+
+		// Gather all inputs before writing any register, with the truncation
+		// of InputRegType
+		__m128i a[4], b[4], c[4], d[4];
+		for (int i = 0; i < 3; i++)
+		{
+			a[BLU_C + i] = *color_inputs[cc.a][i];
+			b[BLU_C + i] = *color_inputs[cc.b][i];
+			c[BLU_C + i] = *color_inputs[cc.c][i];
+			d[BLU_C + i] = *color_inputs[cc.d][i];
+		}
+		a[ALP_C] = *alpha_inputs[ac.a];
+		b[ALP_C] = *alpha_inputs[ac.b];
+		c[ALP_C] = *alpha_inputs[ac.c];
+		d[ALP_C] = *alpha_inputs[ac.d];
+		for (int comp = 0; comp < 4; comp++)
+		{
+			a[comp] = _mm_and_si128(a[comp], mask8);
+			b[comp] = _mm_and_si128(b[comp], mask8);
+			c[comp] = _mm_and_si128(c[comp], mask8);
+			d[comp] = SignExtend(d[comp], 11);
+		}
+
+		for (int comp = BLU_C; comp <= RED_C; comp++)
+		{
+			__m128i result;
+			if (cc.bias != 3)
+			{
+				s32 round = (cc.shift == 3) ? 0 : (cc.op == 1) ? 127 : 128;
+				result = CombineRegular(a[comp], b[comp], c[comp], d[comp], m_BiasLUT[cc.bias],
+				                        m_ScaleLShiftLUT[cc.shift], m_ScaleRShiftLUT[cc.shift], round, cc.op != 0, false);
+			}
+			else
+			{
+				result = CombineCompare(a, b, c[comp], d[comp], comp, cc.shift, cc.op != 0);
+			}
+
+			result = SignExtend(result, 16);
+			reg[cc.dest][comp] = cc.clamp ? ClampSIMD(result, 0, 255) : ClampSIMD(result, -1024, 1023);
+		}
+
+		__m128i result;
+		if (ac.bias != 3)
+		{
+			s32 round = (ac.shift != 3) ? 0 : (ac.op == 1) ? 127 : 128;
+			result = CombineRegular(a[ALP_C], b[ALP_C], c[ALP_C], d[ALP_C], m_BiasLUT[ac.bias],
+			                        m_ScaleLShiftLUT[ac.shift], m_ScaleRShiftLUT[ac.shift], round, ac.op != 0, true);
+		}
+		else
+		{
+			result = CombineCompare(a, b, c[ALP_C], d[ALP_C], ALP_C, ac.shift, ac.op != 0);
+		}
+
+		result = SignExtend(result, 16);
+		reg[ac.dest][ALP_C] = ac.clamp ? ClampSIMD(result, 0, 255) : ClampSIMD(result, -1024, 1023);
+	}
+
+	// Leave the registers as Draw would have after the last pixel
+	s32 regs[4][4][4]; // [register][component][pixel]
+	for (int r = 0; r < 4; r++)
+	{
+		for (int comp = 0; comp < 4; comp++)
+		{
+			_mm_storeu_si128((__m128i*)regs[r][comp], reg[r][comp]);
+			Reg[r][comp] = regs[r][comp][count - 1];
+		}
+	}
+
+	u32 color_index = bpmem.combiners[bpmem.genMode.numtevstages].colorC.dest;
+	u32 alpha_index = bpmem.combiners[bpmem.genMode.numtevstages].alphaC.dest;
+	for (int i = 0; i < count; i++)
+	{
+		LoadQuadPixel(i);
+		for (int comp = 0; comp < 4; comp++)
+			TexColor[comp] = tex_color[comp][i];
+
+		u8 output[4] = {(u8)regs[alpha_index][ALP_C][i], (u8)regs[color_index][BLU_C][i], (u8)regs[color_index][GRN_C][i], (u8)regs[color_index][RED_C][i]};
+
+		OutputPixel(output);
+	}
+}
+
+#endif
+
 void Tev::SetRegColor(int reg, int comp, bool konst, s16 color)
 {
 	if (konst)
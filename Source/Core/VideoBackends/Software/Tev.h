@@ -68,6 +68,12 @@ class Tev
 
 	void Indirect(unsigned int stageNum, s32 s, s32 t);
 
+	void SampleIndirectStages();
+	void SetStageInputs(unsigned int stageNum);
+	void OutputPixel(u8 output[4]);
+	void LoadQuadPixel(int i);
+	void DrawQuadSIMD(int count);
+
 public:
 	s32 Position[3];
 	u8 Color[2][4]; // must be RGBA for correct swap table ordering
@@ -89,6 +95,24 @@ public:
 
 	void Draw();
 
+	// The inputs Draw takes from Position, Color and Uv, for each pixel of a
+	// 2x2 block. The LODs are the same for the whole block.
+	struct PixelInputs
+	{
+		s32 Position[3];
+		u8 Color[2][4];
+		TextureCoordinateType Uv[8];
+	};
+	PixelInputs Quad[4];
+
+	// Whether the pixels of a block can be combined together with the current
+	// TEV configuration. Registers aren't reset between pixels, so this isn't
+	// the case if a stage reads a register that a later stage writes.
+	bool CanDrawQuad() const;
+	// Draws the first count pixels of Quad, with the same results as calling
+	// Draw for each of them in order.
+	void DrawQuad(int count);
+
 	void SetRegColor(int reg, int comp, bool konst, s16 color);
 
 	void DoState(PointerWrap &p);
@@ -4,8 +4,12 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstring>
+#include <memory>
+#include <vector>
 
 #include "Common/Common.h"
+#include "Common/Hash.h"
 #include "Core/HW/Memmap.h"
 #include "VideoBackends/Software/BPMemLoader.h"
 #include "VideoBackends/Software/TextureSampler.h"
@@ -16,6 +20,177 @@
 namespace TextureSampler
 {
 
+// lod is at most 15.9, and linear mip filtering samples one level further.
+static const int MAX_MIPS = 17;
+static const size_t MAX_CACHED_TEXTURES = 64;
+static const size_t MAX_CACHED_BYTES = 64 * 1024 * 1024;
+
+// Everything a decoded mip level depends on, apart from the contents of the
+// memory it is decoded from, which are hashed.
+struct TextureKey
+{
+	const u8* src;
+	const u8* src_odd; // GB bank of RGBA8 textures in TMEM
+	const u8* tlut;
+	int tlut_format;
+	int format;
+	int width; // In texels minus one, like TexImage0
+	int height;
+
+	bool operator==(const TextureKey& other) const
+	{
+		return src == other.src && src_odd == other.src_odd && tlut == other.tlut &&
+		       tlut_format == other.tlut_format && format == other.format &&
+		       width == other.width && height == other.height;
+	}
+};
+
+struct DecodedTexture
+{
+	TextureKey key;
+	u64 hash;
+	u64 last_used;
+	std::vector<u32> texels;
+};
+
+static std::vector<std::unique_ptr<DecodedTexture>> s_cache;
+static size_t s_cached_bytes = 0;
+static u64 s_use_counter = 0;
+
+// The textures checked since the last InvalidateCache, by texmap and mip level.
+static DecodedTexture* s_bound[8][MAX_MIPS];
+
+static u64 HashTexture(const TextureKey& key)
+{
+	// Hash the memory TexDecoder_DecodeTexel reads for texels up to width x height.
+	u64 hash;
+	if (key.src_odd)
+	{
+		u32 size = ((key.width >> 2) + 1) * ((key.height >> 2) + 1) * 32;
+		size = std::min<u32>(size, (u32)(texMem + TMEM_SIZE - key.src));
+		u32 size_odd = std::min<u32>(size, (u32)(texMem + TMEM_SIZE - key.src_odd));
+		hash = GetHash64(key.src, size, 0) ^ (GetHash64(key.src_odd, size_odd, 0) * 31);
+	}
+	else
+	{
+		int block_width = TexDecoder_GetBlockWidthInTexels(key.format);
+		int block_height = TexDecoder_GetBlockHeightInTexels(key.format);
+		u32 size = (key.width / block_width + 1) * block_width * (key.height / block_height + 1) * block_height *
+		           TexDecoder_GetTexelSizeInNibbles(key.format) / 2;
+		if (key.src >= texMem && key.src < texMem + TMEM_SIZE)
+			size = std::min<u32>(size, (u32)(texMem + TMEM_SIZE - key.src));
+		hash = GetHash64(key.src, size, 0);
+	}
+
+	if (key.tlut)
+	{
+		u32 tlut_size = std::min<u32>(TexDecoder_GetPaletteSize(key.format), (u32)(texMem + TMEM_SIZE - key.tlut));
+		hash ^= GetHash64(key.tlut, tlut_size, 0) * 17;
+	}
+	return hash;
+}
+
+static void DecodeTexture(DecodedTexture* texture)
+{
+	const TextureKey& key = texture->key;
+	int stride = key.width + 1;
+	texture->texels.resize(stride * (key.height + 1));
+
+	// Decoded texel by texel with the same functions that were used when
+	// sampling directly from memory, so the results are identical.
+	u32* dst = texture->texels.data();
+	for (int t = 0; t <= key.height; t++)
+	{
+		for (int s = 0; s <= key.width; s++)
+		{
+			if (key.src_odd)
+				TexDecoder_DecodeTexelRGBA8FromTmem((u8*)dst, key.src, key.src_odd, s, t, key.width);
+			else
+				TexDecoder_DecodeTexel((u8*)dst, key.src, s, t, key.width, key.format, key.tlut, (TlutFormat)key.tlut_format);
+			dst++;
+		}
+	}
+}
+
+static void EvictTextures(size_t needed_bytes)
+{
+	while (!s_cache.empty() &&
+	       (s_cache.size() >= MAX_CACHED_TEXTURES || s_cached_bytes + needed_bytes > MAX_CACHED_BYTES))
+	{
+		auto oldest = std::min_element(s_cache.begin(), s_cache.end(),
+			[](const std::unique_ptr<DecodedTexture>& a, const std::unique_ptr<DecodedTexture>& b)
+			{
+				return a->last_used < b->last_used;
+			});
+
+		// Textures that are bound were checked during this draw, so they can
+		// only be the oldest if everything is bound.
+		for (auto& mips : s_bound)
+			for (DecodedTexture*& bound : mips)
+				if (bound == oldest->get())
+					bound = nullptr;
+
+		s_cached_bytes -= (*oldest)->texels.size() * sizeof(u32);
+		s_cache.erase(oldest);
+	}
+}
+
+static const DecodedTexture* GetTexture(u8 texmap, s32 mip, const TextureKey& key)
+{
+	DecodedTexture*& bound = s_bound[texmap][mip];
+	if (bound && bound->key == key)
+		return bound;
+
+	u64 hash = HashTexture(key);
+	DecodedTexture* texture = nullptr;
+	for (auto& cached : s_cache)
+	{
+		if (cached->key == key)
+		{
+			texture = cached.get();
+			break;
+		}
+	}
+
+	if (!texture)
+	{
+		size_t bytes = (key.width + 1) * (key.height + 1) * sizeof(u32);
+		EvictTextures(bytes);
+		s_cache.emplace_back(new DecodedTexture);
+		texture = s_cache.back().get();
+		texture->key = key;
+		DecodeTexture(texture);
+		texture->hash = hash;
+		s_cached_bytes += bytes;
+	}
+	else if (texture->hash != hash)
+	{
+		DecodeTexture(texture);
+		texture->hash = hash;
+	}
+
+	texture->last_used = ++s_use_counter;
+	bound = texture;
+	return texture;
+}
+
+static inline void FetchTexel(const DecodedTexture* texture, int s, int t, u8* texel)
+{
+	memcpy(texel, &texture->texels[t * (texture->key.width + 1) + s], sizeof(u32));
+}
+
+void InvalidateCache()
+{
+	memset(s_bound, 0, sizeof(s_bound));
+}
+
+void Shutdown()
+{
+	InvalidateCache();
+	s_cache.clear();
+	s_cached_bytes = 0;
+}
+
 static inline void WrapCoord(int* coordp, int wrapMode, int imageSize)
 {
 	int coord = *coordp;
@@ -122,6 +297,11 @@ void SampleMip(s32 s, s32 t, s32 mip, bool linear, u8 texmap, u8 *sample)
 	{
 		u32 imageBase = texUnit.texImage3[subTexmap].image_base << 5;
 		imageSrc = Memory::GetPointer(imageBase);
+		if (!imageSrc)
+		{
+			memset(sample, 0, 4);
+			return;
+		}
 	}
 
 	int imageWidth = ti0.width;
@@ -130,6 +310,8 @@ void SampleMip(s32 s, s32 t, s32 mip, bool linear, u8 texmap, u8 *sample)
 	int tlutAddress = texTlut.tmem_offset << 9;
 	const u8* tlut = &texMem[tlutAddress];
 
+	const s32 level = mip;
+
 	// reduce sample location and texture size to mip level
 	// move texture pointer to mip location
 	if (mip)
@@ -159,6 +341,24 @@ void SampleMip(s32 s, s32 t, s32 mip, bool linear, u8 texmap, u8 *sample)
 		}
 	}
 
+	TextureKey key;
+	key.src = imageSrc;
+	key.src_odd = imageSrcOdd;
+	key.format = ti0.format;
+	key.width = imageWidth;
+	key.height = imageHeight;
+	if (TexDecoder_GetPaletteSize(ti0.format))
+	{
+		key.tlut = tlut;
+		key.tlut_format = tlutfmt;
+	}
+	else
+	{
+		key.tlut = nullptr;
+		key.tlut_format = 0;
+	}
+	const DecodedTexture* texture = GetTexture(texmap, std::min(level, MAX_MIPS - 1), key);
+
 	if (linear)
 	{
 		// offset linear sampling
@@ -184,34 +384,17 @@ void SampleMip(s32 s, s32 t, s32 mip, bool linear, u8 texmap, u8 *sample)
 		WrapCoord(&imageSPlus1, tm0.wrap_s, imageWidth);
 		WrapCoord(&imageTPlus1, tm0.wrap_t, imageHeight);
 
-		if (!(ti0.format == GX_TF_RGBA8 && texUnit.texImage1[subTexmap].image_type))
-		{
-			TexDecoder_DecodeTexel(sampledTex, imageSrc, imageS, imageT, imageWidth, ti0.format, tlut, tlutfmt);
-			SetTexel(sampledTex, texel, (128 - fractS) * (128 - fractT));
+		FetchTexel(texture, imageS, imageT, sampledTex);
+		SetTexel(sampledTex, texel, (128 - fractS) * (128 - fractT));
 
-			TexDecoder_DecodeTexel(sampledTex, imageSrc, imageSPlus1, imageT, imageWidth, ti0.format, tlut, tlutfmt);
-			AddTexel(sampledTex, texel, (fractS) * (128 - fractT));
+		FetchTexel(texture, imageSPlus1, imageT, sampledTex);
+		AddTexel(sampledTex, texel, (fractS) * (128 - fractT));
 
-			TexDecoder_DecodeTexel(sampledTex, imageSrc, imageS, imageTPlus1, imageWidth, ti0.format, tlut, tlutfmt);
-			AddTexel(sampledTex, texel, (128 - fractS) * (fractT));
+		FetchTexel(texture, imageS, imageTPlus1, sampledTex);
+		AddTexel(sampledTex, texel, (128 - fractS) * (fractT));
 
-			TexDecoder_DecodeTexel(sampledTex, imageSrc, imageSPlus1, imageTPlus1, imageWidth, ti0.format, tlut, tlutfmt);
-			AddTexel(sampledTex, texel, (fractS) * (fractT));
-		}
-		else
-		{
-			TexDecoder_DecodeTexelRGBA8FromTmem(sampledTex, imageSrc, imageSrcOdd, imageS, imageT, imageWidth);
-			SetTexel(sampledTex, texel, (128 - fractS) * (128 - fractT));
-
-			TexDecoder_DecodeTexelRGBA8FromTmem(sampledTex, imageSrc, imageSrcOdd, imageSPlus1, imageT, imageWidth);
-			AddTexel(sampledTex, texel, (fractS) * (128 - fractT));
-
-			TexDecoder_DecodeTexelRGBA8FromTmem(sampledTex, imageSrc, imageSrcOdd, imageS, imageTPlus1, imageWidth);
-			AddTexel(sampledTex, texel, (128 - fractS) * (fractT));
-
-			TexDecoder_DecodeTexelRGBA8FromTmem(sampledTex, imageSrc, imageSrcOdd, imageSPlus1, imageTPlus1, imageWidth);
-			AddTexel(sampledTex, texel, (fractS) * (fractT));
-		}
+		FetchTexel(texture, imageSPlus1, imageTPlus1, sampledTex);
+		AddTexel(sampledTex, texel, (fractS) * (fractT));
 
 		sample[0] = (u8)(texel[0] >> 14);
 		sample[1] = (u8)(texel[1] >> 14);
@@ -228,10 +411,7 @@ void SampleMip(s32 s, s32 t, s32 mip, bool linear, u8 texmap, u8 *sample)
 		WrapCoord(&imageS, tm0.wrap_s, imageWidth);
 		WrapCoord(&imageT, tm0.wrap_t, imageHeight);
 
-		if (!(ti0.format == GX_TF_RGBA8 && texUnit.texImage1[subTexmap].image_type))
-			TexDecoder_DecodeTexel(sample, imageSrc, imageS, imageT, imageWidth, ti0.format, tlut, tlutfmt);
-		else
-			TexDecoder_DecodeTexelRGBA8FromTmem(sample, imageSrc, imageSrcOdd, imageS, imageT, imageWidth);
+		FetchTexel(texture, imageS, imageT, sample);
 	}
 }
 
@@ -12,6 +12,13 @@ namespace TextureSampler
 
 	void SampleMip(s32 s, s32 t, s32 mip, bool linear, u8 texmap, u8 *sample);
 
+	// Textures are decoded once and sampled from the decoded copy. This makes
+	// the next sample of each texmap check whether its texture changed, which
+	// is needed whenever the texture state or the texture data in memory may
+	// have changed, e.g. before each draw.
+	void InvalidateCache();
+	void Shutdown();
+
 	enum
 	{
 		RED_SMP,
@@ -4,8 +4,10 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstring>
 
 #include "Common/CommonTypes.h"
+#include "Common/Intrinsics.h"
 #include "Common/MathUtil.h"
 
 #include "VideoBackends/Software/BPMemLoader.h"
@@ -104,6 +106,177 @@ void TransformNormal(const InputVertexData *src, bool nbt, OutputVertexData *dst
 	}
 }
 
+#ifdef _M_X86
+
+// The entries of the matrices of four vertices, one vertex per lane. Only
+// loaded again if one of the matrices changes, which usually all vertices of
+// a batch share.
+struct MatrixLanes
+{
+	const float* mats[4] = {};
+	__m128 entries[12];
+
+	void Load(const float* const new_mats[4], int size)
+	{
+		if (memcmp(mats, new_mats, sizeof(mats)) == 0)
+			return;
+
+		memcpy(mats, new_mats, sizeof(mats));
+		bool same = mats[0] == mats[1] && mats[0] == mats[2] && mats[0] == mats[3];
+		for (int n = 0; n < size; n++)
+			entries[n] = same ? _mm_set1_ps(mats[0][n]) : _mm_setr_ps(mats[0][n], mats[1][n], mats[2][n], mats[3][n]);
+	}
+};
+
+// a * x + b * y + c * z + d, in the order the scalar functions compute it
+static inline __m128 Dot3Add(__m128 a, __m128 b, __m128 c, __m128 d, __m128 x, __m128 y, __m128 z)
+{
+	return _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(a, x), _mm_mul_ps(b, y)), _mm_mul_ps(c, z)), d);
+}
+
+static inline __m128 Dot3(__m128 a, __m128 b, __m128 c, __m128 x, __m128 y, __m128 z)
+{
+	return _mm_add_ps(_mm_add_ps(_mm_mul_ps(a, x), _mm_mul_ps(b, y)), _mm_mul_ps(c, z));
+}
+
+// MultiplyVec3Mat33 for the vectors of four vertices
+static inline void MultiplyVec3Mat33x4(const MatrixLanes& mat, const __m128 vec[3], __m128 result[3])
+{
+	const __m128* m = mat.entries;
+	for (int row = 0; row < 3; row++)
+		result[row] = Dot3(m[row * 3], m[row * 3 + 1], m[row * 3 + 2], vec[0], vec[1], vec[2]);
+}
+
+static inline void LoadVec3(const Vec3* const vecs[4], __m128 result[3])
+{
+	result[0] = _mm_setr_ps(vecs[0]->x, vecs[1]->x, vecs[2]->x, vecs[3]->x);
+	result[1] = _mm_setr_ps(vecs[0]->y, vecs[1]->y, vecs[2]->y, vecs[3]->y);
+	result[2] = _mm_setr_ps(vecs[0]->z, vecs[1]->z, vecs[2]->z, vecs[3]->z);
+}
+
+static inline void StoreVec3(const __m128 vec[3], Vec3* const result[4])
+{
+	float x[4], y[4], z[4];
+	_mm_storeu_ps(x, vec[0]);
+	_mm_storeu_ps(y, vec[1]);
+	_mm_storeu_ps(z, vec[2]);
+	for (int i = 0; i < 4; i++)
+	{
+		result[i]->x = x[i];
+		result[i]->y = y[i];
+		result[i]->z = z[i];
+	}
+}
+
+#endif
+
+void TransformPositions(const InputVertexData *src, OutputVertexData *dst, int count)
+{
+	int i = 0;
+
+#ifdef _M_X86
+	const float* proj = xfmem.projection.rawProjection;
+	const bool perspective = xfmem.projection.type == GX_PERSPECTIVE;
+	MatrixLanes mat;
+
+	for (; i + 4 <= count; i += 4)
+	{
+		const float* mats[4];
+		const Vec3* positions[4];
+		Vec3* mvPositions[4];
+		for (int j = 0; j < 4; j++)
+		{
+			mats[j] = (const float*)&xfmem.posMatrices[src[i + j].posMtx * 4];
+			positions[j] = &src[i + j].position;
+			mvPositions[j] = &dst[i + j].mvPosition;
+		}
+
+		mat.Load(mats, 12);
+
+		__m128 pos[3];
+		__m128 mv[3];
+		LoadVec3(positions, pos);
+		const __m128* m = mat.entries;
+		for (int row = 0; row < 3; row++)
+			mv[row] = Dot3Add(m[row * 4], m[row * 4 + 1], m[row * 4 + 2], m[row * 4 + 3], pos[0], pos[1], pos[2]);
+		StoreVec3(mv, mvPositions);
+
+		__m128 projected[4];
+		if (perspective)
+		{
+			projected[0] = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(proj[0]), mv[0]), _mm_mul_ps(_mm_set1_ps(proj[1]), mv[2]));
+			projected[1] = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(proj[2]), mv[1]), _mm_mul_ps(_mm_set1_ps(proj[3]), mv[2]));
+			projected[2] = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(proj[4]), mv[2]), _mm_set1_ps(proj[5])),
+			                          _mm_set1_ps(1.0f - (float)1e-7));
+			projected[3] = _mm_xor_ps(mv[2], _mm_set1_ps(-0.0f));
+		}
+		else
+		{
+			projected[0] = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(proj[0]), mv[0]), _mm_set1_ps(proj[1]));
+			projected[1] = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(proj[2]), mv[1]), _mm_set1_ps(proj[3]));
+			projected[2] = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(proj[4]), mv[2]), _mm_set1_ps(proj[5]));
+			projected[3] = _mm_set1_ps(1.0f);
+		}
+
+		// Back to one struct per vertex
+		_MM_TRANSPOSE4_PS(projected[0], projected[1], projected[2], projected[3]);
+		for (int j = 0; j < 4; j++)
+			_mm_storeu_ps(&dst[i + j].projectedPosition.x, projected[j]);
+	}
+#endif
+
+	for (; i < count; i++)
+		TransformPosition(&src[i], &dst[i]);
+}
+
+void TransformNormals(const InputVertexData *src, bool nbt, OutputVertexData *dst, int count)
+{
+	int i = 0;
+
+#ifdef _M_X86
+	const __m128 one = _mm_set1_ps(1.0f);
+	MatrixLanes mat;
+
+	for (; i + 4 <= count; i += 4)
+	{
+		const float* mats[4];
+		for (int j = 0; j < 4; j++)
+			mats[j] = (const float*)&xfmem.normalMatrices[(src[i + j].posMtx & 31) * 3];
+		mat.Load(mats, 9);
+
+		for (int n = 0; n < (nbt ? 3 : 1); n++)
+		{
+			const Vec3* normals[4];
+			Vec3* results[4];
+			for (int j = 0; j < 4; j++)
+			{
+				normals[j] = &src[i + j].normal[n];
+				results[j] = &dst[i + j].normal[n];
+			}
+
+			__m128 normal[3];
+			__m128 result[3];
+			LoadVec3(normals, normal);
+			MultiplyVec3Mat33x4(mat, normal, result);
+
+			// Vec3::Normalize
+			if (n == 0)
+			{
+				__m128 length = _mm_sqrt_ps(Dot3(result[0], result[1], result[2], result[0], result[1], result[2]));
+				__m128 inv = _mm_div_ps(one, length);
+				for (__m128& component : result)
+					component = _mm_mul_ps(component, inv);
+			}
+
+			StoreVec3(result, results);
+		}
+	}
+#endif
+
+	for (; i < count; i++)
+		TransformNormal(&src[i], nbt, &dst[i]);
+}
+
 static void TransformTexCoordRegular(const TexMtxInfo &texinfo, int coordNum, bool specialCase, const InputVertexData *srcVertex, OutputVertexData *dstVertex)
 {
 	const Vec3 *src;
@@ -16,6 +16,10 @@ namespace TransformUnit
 
 	void TransformPosition(const InputVertexData *src, OutputVertexData *dst);
 	void TransformNormal(const InputVertexData *src, bool nbt, OutputVertexData *dst);
+
+	// The same as TransformPosition and TransformNormal, for count vertices at once
+	void TransformPositions(const InputVertexData *src, OutputVertexData *dst, int count);
+	void TransformNormals(const InputVertexData *src, bool nbt, OutputVertexData *dst, int count);
 	void TransformColor(const InputVertexData *src, OutputVertexData *dst);
 	void TransformTexCoord(const InputVertexData *src, OutputVertexData *dst, bool specialCase);
 }
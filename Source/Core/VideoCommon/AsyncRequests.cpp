@@ -1,75 +1,165 @@
+#include "Common/Thread.h"
+#include "Common/Timer.h"
 #include "VideoCommon/AsyncRequests.h"
+#include "VideoCommon/EFBCache.h"
 #include "VideoCommon/Fifo.h"
 #include "VideoCommon/RenderBase.h"
+#include "VideoCommon/Statistics.h"
 
 AsyncRequests AsyncRequests::s_singleton;
 
 AsyncRequests::AsyncRequests()
-: m_enable(false), m_passthrough(true)
+: m_write_pos(0), m_read_pos(0), m_done_pos(0), m_num_waiters(0), m_enable(false), m_passthrough(true)
+, m_num_events(0), m_num_blocking_events(0), m_blocking_wait_us(0)
 {
+	for (u32 i = 0; i < QUEUE_SIZE; ++i)
+		m_slots[i].sequence.store(i);
 }
 
-void AsyncRequests::PullEventsInternal()
+void AsyncRequests::PopEvent()
 {
-	std::unique_lock<std::mutex> lock(m_mutex);
-	m_empty.store(true);
+	m_slots[m_read_pos % QUEUE_SIZE].sequence.store(m_read_pos + QUEUE_SIZE, std::memory_order_release);
+	++m_read_pos;
+}
 
-	while (!m_queue.empty())
+void AsyncRequests::PullEventsInternal()
+{
+	while (const Event* front = FrontEvent())
 	{
-		const Event& e = m_queue.front();
-
-		lock.unlock();
-		HandleEvent(e);
-		lock.lock();
-
-		m_queue.pop();
+		Event::Type type = front->type;
+		if (type == Event::EFB_POKE_COLOR || type == Event::EFB_POKE_Z)
+		{
+			// Pokes queued one after another are handed to the backend in one go.
+			m_merged_efb_pokes.clear();
+			do
+			{
+				EfbPokeData poke = { front->efb_poke.x, front->efb_poke.y, front->efb_poke.data };
+				m_merged_efb_pokes.push_back(poke);
+				PopEvent();
+				front = FrontEvent();
+			} while (front && front->type == type);
+
+			g_renderer->PokeEFB(type == Event::EFB_POKE_COLOR ? POKE_COLOR : POKE_Z, m_merged_efb_pokes.data(), m_merged_efb_pokes.size());
+		}
+		else
+		{
+			// The slot may be reused as soon as it's popped.
+			Event e = *front;
+			PopEvent();
+			HandleEvent(e);
+		}
+
+		m_done_pos.store(m_read_pos);
 	}
 
-	if (m_wake_me_up_again)
+	WakeWaiters();
+}
+
+void AsyncRequests::WakeWaiters()
+{
+	if (m_num_waiters.load())
 	{
-		m_wake_me_up_again = false;
-		m_cond.notify_all();
+		std::lock_guard<std::mutex> lock(m_wait_mutex);
+		m_wait_cond.notify_all();
 	}
 }
 
 void AsyncRequests::PushEvent(const AsyncRequests::Event& event, bool blocking)
 {
-	std::unique_lock<std::mutex> lock(m_mutex);
+	m_num_events.fetch_add(1, std::memory_order_relaxed);
 
-	if (m_passthrough)
+	if (m_passthrough.load())
 	{
 		HandleEvent(event);
 		return;
 	}
 
-	m_empty.store(false);
-	m_wake_me_up_again |= blocking;
-
-	if (!m_enable)
+	if (!m_enable.load())
 		return;
 
-	m_queue.push(event);
+	// Until the GPU thread gets to the event, peeks must not be answered from
+	// the EFB as it was before.
+	if (event.type == Event::EFB_POKE_COLOR || event.type == Event::EFB_POKE_Z || event.type == Event::SWAP_EVENT)
+		EFBCache::Invalidate();
+
+	// Claim a slot, waiting for the GPU thread to free one if the ring is full.
+	u32 pos = m_write_pos.load(std::memory_order_relaxed);
+	Slot* slot;
+	while (true)
+	{
+		slot = &m_slots[pos % QUEUE_SIZE];
+		s32 diff = (s32)(slot->sequence.load(std::memory_order_acquire) - pos);
+		if (diff == 0)
+		{
+			if (m_write_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+				break;
+		}
+		else if (diff < 0)
+		{
+			// Nothing empties the ring once the GPU loop has exited.
+			if (!m_enable.load())
+				return;
+
+			RunGpu();
+			Common::YieldCPU();
+			pos = m_write_pos.load(std::memory_order_relaxed);
+		}
+		else
+		{
+			pos = m_write_pos.load(std::memory_order_relaxed);
+		}
+	}
+	slot->event = event;
+	slot->sequence.store(pos + 1, std::memory_order_release);
 
 	RunGpu();
-	if (blocking)
+	if (!blocking)
+		return;
+
+	m_num_blocking_events.fetch_add(1, std::memory_order_relaxed);
+	u64 start = Common::Timer::GetTimeUs();
+
+	auto handled = [&] { return (s32)(m_done_pos.load() - (pos + 1)) >= 0 || !m_enable.load(); };
+	if (!handled())
 	{
-		m_cond.wait(lock, [this]{return m_queue.empty();});
+		std::unique_lock<std::mutex> lock(m_wait_mutex);
+		m_num_waiters.fetch_add(1);
+		m_wait_cond.wait(lock, handled);
+		m_num_waiters.fetch_sub(1);
 	}
+
+	m_blocking_wait_us.fetch_add((u32)(Common::Timer::GetTimeUs() - start), std::memory_order_relaxed);
 }
 
-void AsyncRequests::SetEnable(bool enable)
+// Events left in the ring may point to data on the stack of a producer that
+// gave up waiting, so they're dropped without being handled.
+void AsyncRequests::DropEvents()
 {
-	std::unique_lock<std::mutex> lock(m_mutex);
-	m_enable = enable;
+	while (FrontEvent())
+		PopEvent();
+	m_done_pos.store(m_read_pos);
+}
 
+void AsyncRequests::SetEnable(bool enable)
+{
 	if (!enable)
-	{
-		// flush the queue on disabling
-		while (!m_queue.empty())
-			m_queue.pop();
-		if (m_wake_me_up_again)
-			m_cond.notify_all();
-	}
+		m_enable.store(false);
+
+	DropEvents();
+
+	if (enable)
+		m_enable.store(true);
+
+	// producers waiting for dropped events give up when disabled
+	std::lock_guard<std::mutex> lock(m_wait_mutex);
+	m_wait_cond.notify_all();
+}
+
+void AsyncRequests::UpdateStatistics()
+{
+	stats.thisFrame.numAsyncRequests = m_num_events.exchange(0);
+	stats.thisFrame.numBlockingAsyncRequests = m_num_blocking_events.exchange(0);
+	stats.thisFrame.asyncRequestWaitUs = m_blocking_wait_us.exchange(0);
 }
 
 void AsyncRequests::HandleEvent(const AsyncRequests::Event& e)
@@ -110,7 +200,6 @@ void AsyncRequests::HandleEvent(const AsyncRequests::Event& e)
 
 void AsyncRequests::SetPassthrough(bool enable)
 {
-	std::unique_lock<std::mutex> lock(m_mutex);
-	m_passthrough = enable;
+	m_passthrough.store(enable);
 }
 
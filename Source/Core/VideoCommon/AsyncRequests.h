@@ -7,9 +7,10 @@
 #include <atomic>
 #include <condition_variable>
 #include <mutex>
-#include <queue>
+#include <vector>
 
 #include "Common/CommonTypes.h"
+#include "VideoCommon/RenderBase.h"
 
 class AsyncRequests
 {
@@ -66,29 +67,69 @@ public:
 
 	AsyncRequests();
 
+	// Called from the GPU thread, the only one that pulls events.
 	void PullEvents()
 	{
-		if (!m_empty.load())
+		if (FrontEvent())
 			PullEventsInternal();
 	}
+	// Blocking events return once the GPU thread has handled them.
 	void PushEvent(const Event& event, bool blocking = false);
 	void SetEnable(bool enable);
 	void SetPassthrough(bool enable);
 
+	// Moves the counts since the last call into the frame statistics.
+	void UpdateStatistics();
+
 	static AsyncRequests* GetInstance() { return &s_singleton; }
 
 private:
+	// Bounded multi-producer, single-consumer ring. A slot's sequence number
+	// tells whether it's free for the producer claiming write position n
+	// (sequence == n) or holds an event for the consumer at read position n
+	// (sequence == n + 1).
+	enum { QUEUE_SIZE = 1024 };
+	struct Slot
+	{
+		std::atomic<u32> sequence;
+		Event event;
+	};
+
+	const Event* FrontEvent() const
+	{
+		const Slot& slot = m_slots[m_read_pos % QUEUE_SIZE];
+		if (slot.sequence.load(std::memory_order_acquire) != m_read_pos + 1)
+			return nullptr;
+		return &slot.event;
+	}
+	void PopEvent();
+	void DropEvents();
+	void WakeWaiters();
+
 	void PullEventsInternal();
 	void HandleEvent(const Event& e);
 
 	static AsyncRequests s_singleton;
 
-	std::atomic<bool> m_empty;
-	std::queue<Event> m_queue;
-	std::mutex m_mutex;
-	std::condition_variable m_cond;
+	Slot m_slots[QUEUE_SIZE];
+	std::atomic<u32> m_write_pos;
+	// only used by the consumer
+	u32 m_read_pos;
+	// the events before this one have been handled
+	std::atomic<u32> m_done_pos;
+
+	// Only producers waiting for a blocking event sleep on the condition.
+	std::atomic<int> m_num_waiters;
+	std::mutex m_wait_mutex;
+	std::condition_variable m_wait_cond;
+
+	std::vector<EfbPokeData> m_merged_efb_pokes;
+
+	std::atomic<bool> m_enable;
+	std::atomic<bool> m_passthrough;
 
-	bool m_wake_me_up_again;
-	bool m_enable;
-	bool m_passthrough;
+	// statistics, reset every frame
+	std::atomic<u32> m_num_events;
+	std::atomic<u32> m_num_blocking_events;
+	std::atomic<u32> m_blocking_wait_us;
 };
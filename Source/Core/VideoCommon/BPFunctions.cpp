@@ -8,6 +8,7 @@
 #include "Core/HW/Memmap.h"
 
 #include "VideoCommon/BPFunctions.h"
+#include "VideoCommon/EFBCache.h"
 #include "VideoCommon/RenderBase.h"
 #include "VideoCommon/TextureCacheBase.h"
 #include "VideoCommon/VertexManagerBase.h"
@@ -148,6 +149,9 @@ void OnPixelFormatChange()
 {
 	int convtype = -1;
 
+	// Peeks are converted to the pixel format when they're cached.
+	EFBCache::Invalidate();
+
 	// TODO : Check for Z compression format change
 	// When using 16bit Z, the game may enable a special compression format which we need to handle
 	// If we don't, Z values will be completely screwed up, currently only Star Wars:RS2 uses that.
@@ -0,0 +1,83 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+#include "VideoCommon/EFBCache.h"
+
+namespace EFBCache
+{
+
+// [0] for depth, [1] for color
+static std::vector<u32> s_tiles[2][TILES_WIDE * TILES_HIGH];
+static bool s_valid[2][TILES_WIDE * TILES_HIGH];
+// Lets the GPU thread invalidate the cache after every draw without locking
+// when nothing has been peeked since.
+static std::atomic<bool> s_empty(true);
+static std::mutex s_mutex;
+
+static int GetCacheType(EFBAccessType type)
+{
+	return type == PEEK_Z ? 0 : 1;
+}
+
+static u32 GetTileIndex(u32 x, u32 y)
+{
+	return (y / TILE_SIZE) * TILES_WIDE + (x / TILE_SIZE);
+}
+
+EFBRectangle GetTileRect(u32 x, u32 y)
+{
+	EFBRectangle rc;
+	rc.left = (x / TILE_SIZE) * TILE_SIZE;
+	rc.top = (y / TILE_SIZE) * TILE_SIZE;
+	rc.right = std::min(rc.left + TILE_SIZE, (int)EFB_WIDTH);
+	rc.bottom = std::min(rc.top + TILE_SIZE, (int)EFB_HEIGHT);
+	return rc;
+}
+
+bool Lookup(EFBAccessType type, u32 x, u32 y, u32* value)
+{
+	if (s_empty.load() || x >= EFB_WIDTH || y >= EFB_HEIGHT)
+		return false;
+
+	std::lock_guard<std::mutex> lk(s_mutex);
+	const int cache_type = GetCacheType(type);
+	const u32 index = GetTileIndex(x, y);
+	if (!s_valid[cache_type][index])
+		return false;
+
+	*value = s_tiles[cache_type][index][(y % TILE_SIZE) * TILE_SIZE + (x % TILE_SIZE)];
+	return true;
+}
+
+void StoreTile(EFBAccessType type, u32 x, u32 y, const u32* values)
+{
+	if (x >= EFB_WIDTH || y >= EFB_HEIGHT)
+		return;
+
+	std::lock_guard<std::mutex> lk(s_mutex);
+	const int cache_type = GetCacheType(type);
+	const u32 index = GetTileIndex(x, y);
+	std::vector<u32>& tile = s_tiles[cache_type][index];
+	tile.assign(values, values + TILE_SIZE * TILE_SIZE);
+	s_valid[cache_type][index] = true;
+	s_empty.store(false);
+}
+
+void Invalidate()
+{
+	if (s_empty.load())
+		return;
+
+	std::lock_guard<std::mutex> lk(s_mutex);
+	memset(s_valid, 0, sizeof(s_valid));
+	s_empty.store(true);
+}
+
+}
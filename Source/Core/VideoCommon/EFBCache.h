@@ -0,0 +1,42 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "Common/CommonTypes.h"
+#include "VideoCommon/VideoBackendBase.h"
+#include "VideoCommon/VideoCommon.h"
+
+// Cache of EFB peek results, shared by the backends.
+//
+// A backend that reads the EFB back for a peek stores the whole tile around
+// the pixel, so that the following peeks in that tile can be answered on the
+// CPU thread without waiting for the GPU thread. The cache is invalidated
+// whenever the EFB may have changed.
+
+namespace EFBCache
+{
+
+enum
+{
+	TILE_SIZE = 64,
+	TILES_WIDE = (EFB_WIDTH + TILE_SIZE - 1) / TILE_SIZE,
+	TILES_HIGH = (EFB_HEIGHT + TILE_SIZE - 1) / TILE_SIZE
+};
+
+// The EFB pixels of the tile containing (x, y).
+EFBRectangle GetTileRect(u32 x, u32 y);
+
+// Called from the CPU thread. Returns false if the tile isn't cached.
+bool Lookup(EFBAccessType type, u32 x, u32 y, u32* value);
+
+// Called from the GPU thread. values holds the peek results for the tile
+// containing (x, y), in rows of TILE_SIZE.
+void StoreTile(EFBAccessType type, u32 x, u32 y, const u32* values);
+
+// Called from the GPU thread when the EFB or the format it is read in changes,
+// and from the CPU thread when it queues a change of the EFB.
+void Invalidate();
+
+}
@@ -5,6 +5,7 @@
 #include "VideoCommon/BoundingBox.h"
 #include "VideoCommon/BPStructs.h"
 #include "VideoCommon/CommandProcessor.h"
+#include "VideoCommon/EFBCache.h"
 #include "VideoCommon/Fifo.h"
 #include "VideoCommon/FramebufferManagerBase.h"
 #include "VideoCommon/MainBase.h"
@@ -119,14 +120,31 @@ u32 VideoBackendHardware::Video_AccessEFB(EFBAccessType type, u32 x, u32 y, u32
 	}
 	else
 	{
-		AsyncRequests::Event e;
-		u32 result;
-		e.type = type == PEEK_COLOR ? AsyncRequests::Event::EFB_PEEK_COLOR : AsyncRequests::Event::EFB_PEEK_Z;
-		e.time = 0;
-		e.efb_peek.x = x;
-		e.efb_peek.y = y;
-		e.efb_peek.data = &result;
-		AsyncRequests::GetInstance()->PushEvent(e, true);
+		// The whole tile around a peeked pixel is cached, so usually only the
+		// first peek in a tile has to wait for the GPU thread.
+		u32 result = 0;
+		if (!EFBCache::Lookup(type, x, y, &result))
+		{
+			AsyncRequests::Event e;
+			e.type = type == PEEK_COLOR ? AsyncRequests::Event::EFB_PEEK_COLOR : AsyncRequests::Event::EFB_PEEK_Z;
+			e.time = 0;
+			e.efb_peek.x = x;
+			e.efb_peek.y = y;
+			e.efb_peek.data = &result;
+			AsyncRequests::GetInstance()->PushEvent(e, true);
+		}
+
+		if (type == PEEK_COLOR)
+		{
+			// check what to do with the alpha channel (GX_PokeAlphaRead)
+			PixelEngine::UPEAlphaReadReg alpha_read_mode = PixelEngine::GetAlphaReadMode();
+			if (alpha_read_mode.ReadMode == 2)
+				return result; // GX_READ_NONE
+			else if (alpha_read_mode.ReadMode == 1)
+				return result | 0xFF000000; // GX_READ_FF
+			else /*if(alpha_read_mode.ReadMode == 0)*/
+				return result & 0x00FFFFFF; // GX_READ_00
+		}
 		return result;
 	}
 }
@@ -16,6 +16,8 @@
 #include <cmath>
 #include <string>
 
+#include "AudioCommon/AudioCommon.h"
+#include "AudioCommon/Mixer.h"
 #include "Common/Atomic.h"
 #include "Common/Profiler.h"
 #include "Common/StringUtil.h"
@@ -27,6 +29,7 @@
 #include "Core/Movie.h"
 #include "Core/FifoPlayer/FifoRecorder.h"
 
+#include "VideoCommon/AsyncRequests.h"
 #include "VideoCommon/AVIDump.h"
 #include "VideoCommon/BPMemory.h"
 #include "VideoCommon/CommandProcessor.h"
@@ -313,6 +316,14 @@ void Renderer::DrawDebugText()
 		final_yellow += "\n";
 	}
 
+	if (SConfig::GetInstance().m_ShowAudioStats && g_sound_stream && g_sound_stream->GetMixer())
+	{
+		CMixer* mixer = g_sound_stream->GetMixer();
+		final_cyan += StringFromFormat("Audio: %u ms buffered, %u underruns\n",
+		                               mixer->GetBufferedMs(), mixer->GetUnderrunCount());
+		final_yellow += "\n";
+	}
+
 	if (SConfig::GetInstance().m_ShowInputDisplay)
 	{
 		final_cyan += Movie::GetInputDisplay();
@@ -583,6 +594,7 @@ void Renderer::RecordVideoMemory()
 void Renderer::Swap(u32 xfbAddr, u32 fbWidth, u32 fbStride, u32 fbHeight, const EFBRectangle& rc, float Gamma)
 {
 	// TODO: merge more generic parts into VideoCommon
+	AsyncRequests::GetInstance()->UpdateStatistics();
 	g_renderer->SwapImpl(xfbAddr, fbWidth, fbStride, fbHeight, rc, Gamma);
 
 	if (XFBWrited)
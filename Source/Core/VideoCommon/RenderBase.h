@@ -32,6 +32,13 @@ extern int OSDChoice;
 
 extern bool bLastFrameDumped;
 
+struct EfbPokeData
+{
+	u16 x;
+	u16 y;
+	u32 data;
+};
+
 // Renderer really isn't a very good name for this class - it's more like "Misc".
 // The long term goal is to get rid of this class and replace it with others that make
 // more sense.
@@ -104,6 +111,12 @@ public:
 	static void RenderToXFB(u32 xfbAddr, const EFBRectangle& sourceRc, u32 fbWidth, u32 fbHeight, float Gamma = 1.0f);
 
 	virtual u32 AccessEFB(EFBAccessType type, u32 x, u32 y, u32 poke_data) = 0;
+	// Pokes of the same type that were queued together, in order.
+	virtual void PokeEFB(EFBAccessType type, const EfbPokeData* points, size_t num_points)
+	{
+		for (size_t i = 0; i < num_points; ++i)
+			AccessEFB(type, points[i].x, points[i].y, points[i].data);
+	}
 
 	virtual u16 BBoxRead(int index) = 0;
 	virtual void BBoxWrite(int index, u16 value) = 0;
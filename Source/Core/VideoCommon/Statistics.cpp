@@ -38,6 +38,8 @@ std::string Statistics::ToString()
 	str += StringFromFormat("dlists called: %i\n", stats.thisFrame.numDListsCalled);
 	str += StringFromFormat("Primitive joins: %i\n", stats.thisFrame.numPrimitiveJoins);
 	str += StringFromFormat("Draw calls: %i\n", stats.thisFrame.numDrawCalls);
+	str += StringFromFormat("Async requests: %i (%i blocking, %i us waiting)\n", stats.thisFrame.numAsyncRequests,
+	                        stats.thisFrame.numBlockingAsyncRequests, stats.thisFrame.asyncRequestWaitUs);
 	str += StringFromFormat("Primitives: %i\n", stats.thisFrame.numPrims);
 	str += StringFromFormat("Primitives (DL): %i\n", stats.thisFrame.numDLPrims);
 	str += StringFromFormat("XF loads: %i\n", stats.thisFrame.numXFLoads);
@@ -54,6 +54,12 @@ struct Statistics
 		int bytesVertexStreamed;
 		int bytesIndexStreamed;
 		int bytesUniformStreamed;
+
+		// requests from the CPU thread, and how long it waited for the
+		// GPU thread to answer the blocking ones
+		int numAsyncRequests;
+		int numBlockingAsyncRequests;
+		int asyncRequestWaitUs;
 	};
 	ThisFrame thisFrame;
 	void ResetFrame();
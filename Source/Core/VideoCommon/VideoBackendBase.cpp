@@ -6,6 +6,7 @@
 #ifdef _WIN32
 #include "VideoBackends/D3D/VideoBackend.h"
 #endif
+#include "VideoBackends/Null/VideoBackend.h"
 #include "VideoBackends/OGL/VideoBackend.h"
 #include "VideoBackends/Software/VideoBackend.h"
 
@@ -43,15 +44,16 @@ __declspec(dllexport) DWORD NvOptimusEnablement = 1;
 
 void VideoBackend::PopulateList()
 {
-	VideoBackend* backends[4] = { nullptr };
+	VideoBackend* backends[5] = { nullptr };
 
-	// OGL > D3D11 > SW
+	// OGL > D3D11 > SW > Null
 	g_available_video_backends.push_back(backends[0] = new OGL::VideoBackend);
 #ifdef _WIN32
 	if (IsGteVista())
 		g_available_video_backends.push_back(backends[1] = new DX11::VideoBackend);
 #endif
 	g_available_video_backends.push_back(backends[3] = new SW::VideoSoftware);
+	g_available_video_backends.push_back(backends[4] = new Null::VideoBackend);
 
 	for (VideoBackend* backend : backends)
 	{
@@ -7,6 +7,7 @@
 #include "VideoCommon/BPMemory.h"
 #include "VideoCommon/CommandProcessor.h"
 #include "VideoCommon/CPMemory.h"
+#include "VideoCommon/EFBCache.h"
 #include "VideoCommon/Fifo.h"
 #include "VideoCommon/GeometryShaderManager.h"
 #include "VideoCommon/PixelEngine.h"
@@ -60,6 +61,10 @@ static void DoState(PointerWrap &p)
 	BoundingBox::DoState(p);
 	p.DoMarker("BoundingBox");
 
+	// The EFB doesn't match what was peeked before the state was loaded.
+	if (p.GetMode() == PointerWrap::MODE_READ)
+		EFBCache::Invalidate();
+
 
 	// TODO: search for more data that should be saved and add it here
 }
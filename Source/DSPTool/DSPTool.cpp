@@ -2,11 +2,21 @@
 // Licensed under GPLv2
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <sstream>
+
 #include "Common/Common.h"
+#include "Common/CommonPaths.h"
 #include "Common/FileUtil.h"
+#include "Common/MemoryUtil.h"
 #include "Common/StringUtil.h"
+#include "Common/Timer.h"
+#include "Core/DSP/DSPAnalyzer.h"
 #include "Core/DSP/DSPCodeUtil.h"
+#include "Core/DSP/DSPCore.h"
+#include "Core/DSP/DSPEmitter.h"
 #include "Core/DSP/DSPHost.h"
+#include "Core/DSP/DSPHWInterface.h"
 #include "Core/DSP/DSPTables.h"
 
 // Stub out the dsplib host stuff, since this is just a simple cmdline tools.
@@ -185,6 +195,120 @@ static void RunAsmTests()
 }
 
 
+static bool LoadDSPRom(u16* rom, const std::string& filename, u32 size_in_bytes)
+{
+	std::string bytes;
+	if (!File::ReadFileToString(filename, bytes) || bytes.size() != size_in_bytes)
+	{
+		printf("ERROR: Could not load %s.\n", filename.c_str());
+		return false;
+	}
+
+	const u16* words = reinterpret_cast<const u16*>(bytes.c_str());
+	for (u32 i = 0; i < size_in_bytes / 2; ++i)
+		rom[i] = Common::swap16(words[i]);
+
+	return true;
+}
+
+// Runs a ucode image on the LLE core and reports how many DSP cycles per second
+// it gets through. The CPU side is replaced by a synthetic mailbox: mails from
+// mail_name (hex words, replayed in a loop) are posted whenever the CPU mailbox
+// is empty, and mails sent by the DSP are read back immediately. Main memory is
+// zero filled, which is enough to keep AX/Zelda style ucodes running through
+// their command loops.
+static int RunBenchmark(const std::string& ucode_name, const std::string& mail_name,
+                        u16 entry, u64 total_cycles, bool use_interpreter)
+{
+	DSPInitOptions opts;
+	const std::string rom_dir = File::GetSysDirectory() + GC_SYS_DIR DIR_SEP;
+	if (!LoadDSPRom(opts.irom_contents.data(), rom_dir + DSP_IROM, DSP_IROM_BYTE_SIZE) ||
+	    !LoadDSPRom(opts.coef_contents.data(), rom_dir + DSP_COEF, DSP_COEF_BYTE_SIZE))
+		return 1;
+	opts.core_type = use_interpreter ? DSPInitOptions::CORE_INTERPRETER : DSPInitOptions::CORE_JIT;
+
+	std::string binary_code;
+	std::vector<u16> ucode;
+	File::ReadFileToString(ucode_name, binary_code);
+	BinaryStringBEToCode(binary_code, ucode);
+	if (ucode.empty() || ucode.size() > DSP_IRAM_SIZE)
+	{
+		printf("ERROR: %s is not a valid ucode image.\n", ucode_name.c_str());
+		return 1;
+	}
+
+	std::vector<u32> mails;
+	if (!mail_name.empty())
+	{
+		std::string mail_text;
+		File::ReadFileToString(mail_name, mail_text);
+		std::istringstream stream(mail_text);
+		u32 mail;
+		while (stream >> std::hex >> mail)
+			mails.push_back(mail);
+	}
+
+	if (!DSPCore_Init(opts))
+		return 1;
+
+	// Covers MEM1 and MEM2, which is all a ucode can DMA from.
+	const size_t cpu_ram_size = 0x14000000;
+	g_dsp.cpu_ram = (u8*)AllocateMemoryPages(cpu_ram_size);
+	DSPCore_Reset();
+	InitInstructionTable();
+
+	// Skip the IROM bootstrap and put the ucode straight into IRAM, like the
+	// bootstrap's DMA would.
+	UnWriteProtectMemory(g_dsp.iram, DSP_IRAM_BYTE_SIZE, false);
+	std::copy(ucode.begin(), ucode.end(), g_dsp.iram);
+	WriteProtectMemory(g_dsp.iram, DSP_IRAM_BYTE_SIZE, false);
+	DSPAnalyzer::Analyze();
+	if (dspjit)
+		dspjit->ClearIRAM();
+	g_dsp.pc = entry;
+	g_dsp.cr &= ~CR_HALT;
+
+	// Same slice length the emulator uses for one DSP_Update.
+	const int slice = 12600 / 6;
+	size_t next_mail = 0;
+	u32 mails_sent = 0, mails_received = 0;
+	u64 cycles = 0;
+
+	u64 start_time = Common::Timer::GetTimeUs();
+	while (cycles < total_cycles && !(g_dsp.cr & CR_HALT))
+	{
+		if (!mails.empty() && !(gdsp_mbox_peek(GDSP_MBOX_CPU) & 0x80000000))
+		{
+			u32 mail = mails[next_mail];
+			gdsp_mbox_write_h(GDSP_MBOX_CPU, mail >> 16);
+			gdsp_mbox_write_l(GDSP_MBOX_CPU, mail & 0xffff);
+			next_mail = (next_mail + 1) % mails.size();
+			mails_sent++;
+		}
+		if (gdsp_mbox_peek(GDSP_MBOX_DSP) & 0x80000000)
+		{
+			gdsp_mbox_read_h(GDSP_MBOX_DSP);
+			gdsp_mbox_read_l(GDSP_MBOX_DSP);
+			mails_received++;
+		}
+
+		// The core can overshoot the slice, or stop short of it when halted.
+		cycles += slice - DSPCore_RunCycles(slice);
+	}
+	u64 elapsed_us = std::max<u64>(Common::Timer::GetTimeUs() - start_time, 1);
+
+	printf("%s: %llu cycles in %.3f s (%.2f Mcycles/s) on the %s\n", ucode_name.c_str(),
+	       (unsigned long long)cycles, elapsed_us / 1000000.0, (double)cycles / elapsed_us,
+	       use_interpreter ? "interpreter" : "JIT");
+	printf("Mails sent: %u, received: %u%s\n", mails_sent, mails_received,
+	       (g_dsp.cr & CR_HALT) ? " (halted)" : "");
+
+	DSPCore_Shutdown();
+	FreeMemoryPages(g_dsp.cpu_ram, cpu_ram_size);
+	g_dsp.cpu_ram = nullptr;
+	return 0;
+}
+
 // Usage:
 // Run internal tests:
 //   dsptool test
@@ -198,6 +322,8 @@ static void RunAsmTests()
 //   dsptool [-f] -h asdf.h asdf.txt
 // Print results from DSPSpy register dump
 //   dsptool -p dsp_dump0.bin
+// Benchmark a ucode on the LLE JIT, feeding it mails from a file
+//   dsptool -b -mail mails.txt -e 0x10 ucode.bin
 // So far, all this binary can do is test partially that itself works correctly.
 int main(int argc, const char *argv[])
 {
@@ -215,6 +341,11 @@ int main(int argc, const char *argv[])
 		printf("-ps <DUMP FILE>: Print results of DSPSpy register dump (disable SR output)\n");
 		printf("-pm <DUMP FILE>: Print results of DSPSpy register dump (convert PROD values)\n");
 		printf("-psm <DUMP FILE>: Print results of DSPSpy register dump (convert PROD values/disable SR output)\n");
+		printf("-b <UCODE FILE>: Benchmark a ucode image on the LLE core\n");
+		printf("-bi <UCODE FILE>: Benchmark a ucode image on the LLE interpreter\n");
+		printf("-mail <FILE>: Mails (hex) the benchmark posts to the DSP, repeated in a loop\n");
+		printf("-e <ADDRESS>: IRAM entry point for the benchmark (default 0)\n");
+		printf("-n <CYCLES>: Number of DSP cycles the benchmark runs for (default 500000000)\n");
 
 		return 0;
 	}
@@ -228,9 +359,13 @@ int main(int argc, const char *argv[])
 	std::string input_name;
 	std::string output_header_name;
 	std::string output_name;
+	std::string mail_name;
+	u16 entry = 0;
+	u64 bench_cycles = 500000000;
 
 	bool disassemble = false, compare = false, multiple = false, outputSize = false,
-		force = false, print_results = false, print_results_prodhack = false, print_results_srhack = false;
+		force = false, print_results = false, print_results_prodhack = false, print_results_srhack = false,
+		benchmark = false, benchmark_interpreter = false;
 	for (int i = 1; i < argc; i++)
 	{
 		if (!strcmp(argv[i], "-d"))
@@ -262,6 +397,18 @@ int main(int argc, const char *argv[])
 			print_results_srhack = true;
 			print_results_prodhack = true;
 		}
+		else if (!strcmp(argv[i], "-b"))
+			benchmark = true;
+		else if (!strcmp(argv[i], "-bi")) {
+			benchmark = true;
+			benchmark_interpreter = true;
+		}
+		else if (!strcmp(argv[i], "-mail"))
+			mail_name = argv[++i];
+		else if (!strcmp(argv[i], "-e"))
+			entry = (u16)strtoul(argv[++i], nullptr, 0);
+		else if (!strcmp(argv[i], "-n"))
+			bench_cycles = strtoull(argv[++i], nullptr, 0);
 		else
 		{
 			if (!input_name.empty())
@@ -285,6 +432,16 @@ int main(int argc, const char *argv[])
 		return 1;
 	}
 
+	if (benchmark)
+	{
+		if (input_name.empty())
+		{
+			printf("Benchmark: Must specify input.\n");
+			return 1;
+		}
+		return RunBenchmark(input_name, mail_name, entry, bench_cycles, benchmark_interpreter);
+	}
+
 	if (compare)
 	{
 		// Two binary inputs, let's diff.
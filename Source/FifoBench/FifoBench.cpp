@@ -0,0 +1,313 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+// Replays a fifolog through the software renderer without a window or the
+// emulated CPU, and reports how long each frame took, so that changes to the
+// video pipeline can be measured on reproducible workloads.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/Timer.h"
+#include "Core/ConfigManager.h"
+#include "Core/FifoPlayer/FifoDataFile.h"
+#include "Core/FifoPlayer/FifoPlaybackAnalyzer.h"
+#include "Core/Host.h"
+#include "Core/HW/Memmap.h"
+#include "VideoBackends/OGL/GLInterfaceBase.h"
+#include "VideoBackends/Software/BPMemLoader.h"
+#include "VideoBackends/Software/Clipper.h"
+#include "VideoBackends/Software/DebugUtil.h"
+#include "VideoBackends/Software/OpcodeDecoder.h"
+#include "VideoBackends/Software/Rasterizer.h"
+#include "VideoBackends/Software/SWStatistics.h"
+#include "VideoBackends/Software/XFMemLoader.h"
+#include "VideoCommon/BPMemory.h"
+#include "VideoCommon/PixelEngine.h"
+#include "VideoCommon/VertexLoaderUtils.h"
+
+// Stub out the host callbacks, there's no UI.
+void Host_NotifyMapLoaded() {}
+void Host_RefreshDSPDebuggerWindow() {}
+void Host_Message(int) {}
+void* Host_GetRenderHandle() { return nullptr; }
+void Host_UpdateTitle(const std::string&) {}
+void Host_UpdateDisasmDialog() {}
+void Host_UpdateMainFrame() {}
+void Host_RequestRenderWindowSize(int, int) {}
+void Host_RequestFullscreen(bool) {}
+void Host_SetStartupDebuggingParameters() {}
+bool Host_UIHasFocus() { return false; }
+bool Host_RendererHasFocus() { return false; }
+bool Host_RendererIsFullscreen() { return false; }
+void Host_ConnectWiimote(int, bool) {}
+void Host_SetWiiMoteConnectionState(int) {}
+void Host_ShowVideoConfig(void*, const std::string&, const std::string&) {}
+cInterfaceBase* HostGL_CreateGLInterface() { return nullptr; }
+
+// Commands not yet run by the decoder, like the command processor's buffer.
+static std::vector<u8> s_command_buffer;
+
+static void PushU8(u8 value)
+{
+	s_command_buffer.push_back(value);
+}
+
+static void PushU32(u32 value)
+{
+	for (int shift = 24; shift >= 0; shift -= 8)
+		PushU8((u8)(value >> shift));
+}
+
+static void PushData(const u8* data, u32 size)
+{
+	s_command_buffer.insert(s_command_buffer.end(), data, data + size);
+}
+
+// Runs every complete command in the buffer and keeps the rest for later.
+static void RunCommands()
+{
+	u8* start = s_command_buffer.data();
+	u32 available = (u32)s_command_buffer.size();
+	g_video_buffer_read_ptr = start;
+
+	while (OpcodeDecoder::CommandRunnable(available))
+	{
+		OpcodeDecoder::Run(available);
+		available = (u32)(s_command_buffer.size() - (g_video_buffer_read_ptr - start));
+	}
+
+	s_command_buffer.erase(s_command_buffer.begin(), s_command_buffer.end() - available);
+}
+
+// The same registers FifoPlayer::LoadMemory skips.
+static bool ShouldLoadBP(u8 address)
+{
+	switch (address)
+	{
+	case BPMEM_SETDRAWDONE:
+	case BPMEM_PE_TOKEN_ID:
+	case BPMEM_PE_TOKEN_INT_ID:
+	case BPMEM_TRIGGER_EFB_COPY:
+	case BPMEM_LOADTLUT1:
+	case BPMEM_PERF1:
+		return false;
+	default:
+		return true;
+	}
+}
+
+static void PushCPReg(u8 reg, u32 value)
+{
+	PushU8(0x08);
+	PushU8(reg);
+	PushU32(value);
+}
+
+// Loads the register state at the start of the log, in FifoPlayer's order.
+static void LoadRegisters(FifoDataFile* file)
+{
+	u32* regs = file->GetBPMem();
+	for (int i = 0; i < FifoDataFile::BP_MEM_SIZE; ++i)
+	{
+		if (!ShouldLoadBP(i))
+			continue;
+		PushU8(0x61);
+		PushU32((i << 24) | (regs[i] & 0x00ffffff));
+	}
+
+	regs = file->GetCPMem();
+	PushCPReg(0x30, regs[0x30]);
+	PushCPReg(0x40, regs[0x40]);
+	PushCPReg(0x50, regs[0x50]);
+	PushCPReg(0x60, regs[0x60]);
+	for (int i = 0; i < 8; ++i)
+	{
+		PushCPReg(0x70 + i, regs[0x70 + i]);
+		PushCPReg(0x80 + i, regs[0x80 + i]);
+		PushCPReg(0x90 + i, regs[0x90 + i]);
+	}
+	for (int i = 0; i < 16; ++i)
+	{
+		PushCPReg(0xa0 + i, regs[0xa0 + i]);
+		PushCPReg(0xb0 + i, regs[0xb0 + i]);
+	}
+
+	regs = file->GetXFMem();
+	for (int i = 0; i < FifoDataFile::XF_MEM_SIZE; i += 16)
+	{
+		PushU8(0x10);
+		PushU32(0x000f0000 | i);
+		for (int j = 0; j < 16; ++j)
+			PushU32(regs[i + j]);
+	}
+
+	regs = file->GetXFRegs();
+	for (int i = 0; i < FifoDataFile::XF_REGS_SIZE; ++i)
+	{
+		PushU8(0x10);
+		PushU32((i & 0x0fff) | 0x1000);
+		PushU32(regs[i]);
+	}
+
+	RunCommands();
+}
+
+static void WriteMemory(const MemoryUpdate& update)
+{
+	u8* mem;
+	if (update.address & 0x10000000)
+		mem = &Memory::m_pEXRAM[update.address & Memory::EXRAM_MASK];
+	else
+		mem = &Memory::m_pRAM[update.address & Memory::RAM_MASK];
+	memcpy(mem, update.data, update.size);
+}
+
+// Like FifoPlayer::WriteFramePart, the memory updates are made once the fifo
+// has been written up to where they were recorded.
+static void RunFrame(const FifoFrameInfo& frame, const AnalyzedFrameInfo& info)
+{
+	u32 position = 0;
+	for (const MemoryUpdate& update : info.memoryUpdates)
+	{
+		if (update.fifoPosition > position)
+		{
+			u32 end = std::min(update.fifoPosition, frame.fifoDataSize);
+			PushData(frame.fifoData + position, end - position);
+			RunCommands();
+			position = end;
+		}
+		WriteMemory(update);
+	}
+
+	PushData(frame.fifoData + position, frame.fifoDataSize - position);
+	RunCommands();
+}
+
+static void PrintUsage()
+{
+	printf("USAGE: fifobench [-l loops] [-v] <file.dff>\n"
+	       "  -l  Number of times the log is replayed (default 1)\n"
+	       "  -v  Print statistics for every frame\n");
+}
+
+int main(int argc, char* argv[])
+{
+	int loops = 1;
+	bool verbose = false;
+	std::string filename;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		if (!strcmp(argv[i], "-l") && i + 1 < argc)
+			loops = std::max(1, atoi(argv[++i]));
+		else if (!strcmp(argv[i], "-v"))
+			verbose = true;
+		else if (argv[i][0] != '-' && filename.empty())
+			filename = argv[i];
+		else
+		{
+			PrintUsage();
+			return 1;
+		}
+	}
+	if (filename.empty())
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	std::unique_ptr<FifoDataFile> file(FifoDataFile::Load(filename, false));
+	if (!file)
+	{
+		printf("Couldn't load %s\n", filename.c_str());
+		return 1;
+	}
+
+	std::vector<AnalyzedFrameInfo> frame_info;
+	FifoPlaybackAnalyzer analyzer;
+	analyzer.AnalyzeFrames(file.get(), frame_info);
+
+	SConfig::Init();
+	SConfig::GetInstance().m_LocalCoreStartupParameter.bWii = file->GetIsWii();
+
+	std::vector<u8> ram(Memory::RAM_SIZE);
+	std::vector<u8> exram(Memory::EXRAM_SIZE);
+	Memory::m_pRAM = ram.data();
+	if (file->GetIsWii())
+		Memory::m_pEXRAM = exram.data();
+
+	InitBPMemory();
+	InitXFMemory();
+	PixelEngine::Init();
+	OpcodeDecoder::Init();
+	Clipper::Init();
+	Rasterizer::Init();
+	DebugUtil::Init();
+
+	LoadRegisters(file.get());
+
+	const u32 frame_count = file->GetFrameCount();
+	u64 total_us = 0, total_bytes = 0, total_commands = 0;
+	u64 total_primitives = 0, total_vertices = 0, total_triangles = 0;
+	u64 slowest_us = 0;
+
+	if (verbose)
+		printf("%5s %5s %10s %10s %9s %9s %10s %10s\n", "loop", "frame", "us", "bytes",
+		       "commands", "prims", "vertices", "triangles");
+
+	for (int loop = 0; loop < loops; ++loop)
+	{
+		for (u32 frame = 0; frame < frame_count; ++frame)
+		{
+			const FifoFrameInfo& info = file->GetFrame(frame);
+			swstats.ResetFrame();
+
+			u64 start = Common::Timer::GetTimeUs();
+			RunFrame(info, frame_info[frame]);
+			u64 elapsed = Common::Timer::GetTimeUs() - start;
+
+			const SWStatistics::ThisFrame& stats = swstats.thisFrame;
+			total_us += elapsed;
+			total_bytes += info.fifoDataSize;
+			total_commands += stats.numCommands;
+			total_primitives += stats.numPrimatives;
+			total_vertices += stats.numVerticesLoaded;
+			total_triangles += stats.numTrianglesDrawn;
+			slowest_us = std::max(slowest_us, elapsed);
+
+			if (verbose)
+				printf("%5d %5u %10llu %10u %9u %9u %10u %10u\n", loop, frame,
+				       (unsigned long long)elapsed, info.fifoDataSize, stats.numCommands,
+				       stats.numPrimatives, stats.numVerticesLoaded, stats.numTrianglesDrawn);
+		}
+	}
+
+	const u64 frames = (u64)frame_count * loops;
+	const double seconds = std::max<u64>(total_us, 1) / 1000000.0;
+	printf("%s: %u frames, %d loops\n", filename.c_str(), frame_count, loops);
+	printf("Time:       %llu us total, %llu us per frame, %llu us slowest\n",
+	       (unsigned long long)total_us, (unsigned long long)(frames ? total_us / frames : 0),
+	       (unsigned long long)slowest_us);
+	printf("Frames:     %.1f per second\n", frames / seconds);
+	printf("Fifo:       %llu bytes, %.2f MB/s\n", (unsigned long long)total_bytes,
+	       total_bytes / seconds / (1024 * 1024));
+	printf("Commands:   %llu, %.0f per second\n", (unsigned long long)total_commands,
+	       total_commands / seconds);
+	printf("Primitives: %llu, vertices %llu (%.0f per second), triangles drawn %llu\n",
+	       (unsigned long long)total_primitives, (unsigned long long)total_vertices,
+	       total_vertices / seconds, (unsigned long long)total_triangles);
+
+	DebugUtil::Shutdown();
+	Memory::m_pRAM = nullptr;
+	Memory::m_pEXRAM = nullptr;
+
+	return 0;
+}
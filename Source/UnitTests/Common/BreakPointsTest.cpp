@@ -0,0 +1,81 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <memory>
+#include <gtest/gtest.h>
+
+#include "Common/BreakPoints.h"
+
+static TMemCheck MakeMemCheck(u32 start, u32 end)
+{
+	TMemCheck mc;
+	mc.StartAddress = start;
+	mc.EndAddress = end;
+	mc.bRange = start != end;
+	mc.OnRead = mc.OnWrite = true;
+	return mc;
+}
+
+TEST(MemChecks, SingleAddress)
+{
+	std::unique_ptr<MemChecks> mcs(new MemChecks);
+	EXPECT_FALSE(mcs->IsPageWatched(0x80001234));
+
+	mcs->Add(MakeMemCheck(0x80001234, 0x80001234));
+	EXPECT_TRUE(mcs->IsPageWatched(0x80001000));
+	EXPECT_TRUE(mcs->IsPageWatched(0x80001FFF));
+	EXPECT_FALSE(mcs->IsPageWatched(0x80002000));
+	EXPECT_FALSE(mcs->IsPageWatched(0x80000FFF));
+
+	ASSERT_NE(nullptr, mcs->GetMemCheck(0x80001234));
+	EXPECT_EQ(0x80001234u, mcs->GetMemCheck(0x80001234)->StartAddress);
+	EXPECT_EQ(nullptr, mcs->GetMemCheck(0x80001230));
+	EXPECT_EQ(nullptr, mcs->GetMemCheck(0x80001238));
+
+	mcs->Remove(0x80001234);
+	EXPECT_FALSE(mcs->HasAny());
+	EXPECT_FALSE(mcs->IsPageWatched(0x80001234));
+	EXPECT_EQ(nullptr, mcs->GetMemCheck(0x80001234));
+}
+
+TEST(MemChecks, OverlappingRanges)
+{
+	std::unique_ptr<MemChecks> mcs(new MemChecks);
+	mcs->Add(MakeMemCheck(0x80020000, 0x80020010));
+	mcs->Add(MakeMemCheck(0x80010000, 0x80030000));
+	mcs->Add(MakeMemCheck(0x80000100, 0x80000200));
+	mcs->Add(MakeMemCheck(0x80040000, 0x80040000));
+	// Starts inside an existing check, so it isn't added.
+	mcs->Add(MakeMemCheck(0x80020004, 0x80020004));
+	EXPECT_EQ(4u, mcs->GetMemChecks().size());
+
+	EXPECT_TRUE(mcs->IsPageWatched(0x80025000));
+	EXPECT_FALSE(mcs->IsPageWatched(0x80031000));
+
+	// Checks that were added first win.
+	ASSERT_NE(nullptr, mcs->GetMemCheck(0x80020008));
+	EXPECT_EQ(0x80020000u, mcs->GetMemCheck(0x80020008)->StartAddress);
+	ASSERT_NE(nullptr, mcs->GetMemCheck(0x80020014));
+	EXPECT_EQ(0x80010000u, mcs->GetMemCheck(0x80020014)->StartAddress);
+	ASSERT_NE(nullptr, mcs->GetMemCheck(0x80030000));
+	EXPECT_EQ(0x80010000u, mcs->GetMemCheck(0x80030000)->StartAddress);
+	ASSERT_NE(nullptr, mcs->GetMemCheck(0x80000180));
+	EXPECT_EQ(0x80000100u, mcs->GetMemCheck(0x80000180)->StartAddress);
+	ASSERT_NE(nullptr, mcs->GetMemCheck(0x80040000));
+	EXPECT_EQ(0x80040000u, mcs->GetMemCheck(0x80040000)->StartAddress);
+
+	EXPECT_EQ(nullptr, mcs->GetMemCheck(0x80030004));
+	EXPECT_EQ(nullptr, mcs->GetMemCheck(0x80000204));
+	EXPECT_EQ(nullptr, mcs->GetMemCheck(0x80040004));
+
+	mcs->Remove(0x80010000);
+	ASSERT_NE(nullptr, mcs->GetMemCheck(0x80020008));
+	EXPECT_EQ(0x80020000u, mcs->GetMemCheck(0x80020008)->StartAddress);
+	EXPECT_EQ(nullptr, mcs->GetMemCheck(0x80025000));
+	EXPECT_FALSE(mcs->IsPageWatched(0x80025000));
+
+	mcs->Clear();
+	EXPECT_FALSE(mcs->IsPageWatched(0x80020008));
+	EXPECT_EQ(nullptr, mcs->GetMemCheck(0x80020008));
+}
@@ -0,0 +1,134 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <random>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/MathUtil.h"
+#include "Core/HW/DSPHLE/UCodes/AXMix.h"
+
+namespace
+{
+
+// Reference implementations, as the scalar loops in AXVoice.h were written.
+void RefApplyVolume(s16* samples, u32 count, u16* volume, s16 volume_delta)
+{
+	for (u32 i = 0; i < count; ++i)
+	{
+		samples[i] = MathUtil::Clamp(((s32)samples[i] * *volume) >> 15, -32767, 32767);
+		*volume += volume_delta;
+	}
+}
+
+void RefMixAdd(int* out, const s16* input, u32 count, u16* pvol, s16* dpop, bool ramp)
+{
+	u16& volume = pvol[0];
+	u16 volume_delta = pvol[1];
+
+	if (!ramp)
+		volume_delta = 0;
+
+	for (u32 i = 0; i < count; ++i)
+	{
+		s64 sample = input[i];
+		sample *= volume;
+		sample >>= 15;
+		sample = MathUtil::Clamp((s32)sample, -32767, 32767);
+
+		out[i] += (s16)sample;
+		volume += volume_delta;
+
+		*dpop = (s16)sample;
+	}
+}
+
+std::vector<s16> RandomSamples(std::mt19937& rng, u32 count)
+{
+	std::uniform_int_distribution<int> dist(-32768, 32767);
+	std::vector<s16> samples(count);
+	for (s16& sample : samples)
+		sample = (s16)dist(rng);
+
+	// Make sure the extremes are always covered.
+	if (count >= 2)
+	{
+		samples[0] = -32768;
+		samples[1] = 32767;
+	}
+	return samples;
+}
+
+}
+
+TEST(AXMix, ApplyVolumeMatchesReference)
+{
+	std::mt19937 rng(1234);
+	std::uniform_int_distribution<int> dist(0, 0xFFFF);
+
+	for (u32 count : { 0, 1, 7, 8, 9, 32, 95, 96 })
+	{
+		for (int iter = 0; iter < 200; ++iter)
+		{
+			std::vector<s16> expected = RandomSamples(rng, count);
+			std::vector<s16> actual = expected;
+			u16 expected_volume = (u16)dist(rng);
+			u16 actual_volume = expected_volume;
+			s16 delta = (s16)dist(rng);
+
+			RefApplyVolume(expected.data(), count, &expected_volume, delta);
+			AXMix::ApplyVolume(actual.data(), count, &actual_volume, delta);
+
+			EXPECT_EQ(expected, actual);
+			EXPECT_EQ(expected_volume, actual_volume);
+		}
+	}
+}
+
+TEST(AXMix, MixAddMatchesReference)
+{
+	std::mt19937 rng(5678);
+	std::uniform_int_distribution<int> dist(0, 0xFFFF);
+	std::uniform_int_distribution<int> out_dist(-0x100000, 0x100000);
+
+	for (u32 count : { 0, 1, 6, 8, 18, 32, 95, 96 })
+	{
+		for (bool ramp : { false, true })
+		{
+			for (int iter = 0; iter < 200; ++iter)
+			{
+				std::vector<s16> input = RandomSamples(rng, count);
+				std::vector<int> expected(count);
+				for (int& value : expected)
+					value = out_dist(rng);
+				std::vector<int> actual = expected;
+
+				u16 expected_vol[2] = { (u16)dist(rng), (u16)dist(rng) };
+				u16 actual_vol[2] = { expected_vol[0], expected_vol[1] };
+				s16 expected_dpop = 0x1234;
+				s16 actual_dpop = expected_dpop;
+
+				RefMixAdd(expected.data(), input.data(), count, expected_vol, &expected_dpop, ramp);
+				AXMix::MixAdd(actual.data(), input.data(), count, actual_vol, &actual_dpop, ramp);
+
+				EXPECT_EQ(expected, actual);
+				EXPECT_EQ(expected_vol[0], actual_vol[0]);
+				EXPECT_EQ(expected_vol[1], actual_vol[1]);
+				EXPECT_EQ(expected_dpop, actual_dpop);
+			}
+		}
+	}
+}
+
+TEST(AXMix, FullVolumeSaturates)
+{
+	s16 samples[8] = { -32768, -32767, -1, 0, 1, 16384, 32766, 32767 };
+	u16 volume = 0xFFFF;
+	AXMix::ApplyVolume(samples, 8, &volume, 0);
+
+	const s16 expected[8] = { -32767, -32767, -2, 0, 1, 32767, 32767, 32767 };
+	for (int i = 0; i < 8; ++i)
+		EXPECT_EQ(expected[i], samples[i]);
+}
@@ -0,0 +1,182 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
+#include "Core/HW/Memmap.h"
+#include "Core/IPC_HLE/WII_IPC_HLE_Device_FileIO.h"
+
+#define AS_US(diff) ((unsigned long long)std::chrono::duration_cast<std::chrono::microseconds>(diff).count())
+
+namespace
+{
+
+const u32 COMMAND_ADDRESS = 0x1000;
+const u32 BUFFER_ADDRESS = 0x10000;
+const u32 STATS_ADDRESS = 0x2000;
+
+const char SAVE_NAME[] = "/title/00010000/52534245/data/save.bin";
+const u32 SAVE_SIZE = 0x40000;
+const u32 HEADER_SIZE = 0x20;
+const u32 CHUNK_SIZE = 0x200;
+
+}
+
+class FileIOTest : public testing::Test
+{
+protected:
+	virtual void SetUp() override
+	{
+		m_ram.resize(Memory::RAM_SIZE);
+		Memory::m_pRAM = m_ram.data();
+
+		m_old_root = File::GetUserPath(D_WIIROOT_IDX);
+		m_root = File::GetTempFilenameForAtomicWrite("FileIOTest");
+		File::CreateFullPath(m_root + SAVE_NAME);
+		File::SetUserPath(D_WIIROOT_IDX, m_root);
+
+		std::mt19937 rng(42);
+		m_save.resize(SAVE_SIZE);
+		for (u8& byte : m_save)
+			byte = (u8)rng();
+		File::IOFile(m_root + SAVE_NAME, "wb").WriteBytes(m_save.data(), m_save.size());
+	}
+
+	virtual void TearDown() override
+	{
+		File::SetUserPath(D_WIIROOT_IDX, m_old_root);
+		File::DeleteDirRecursively(m_root);
+		Memory::m_pRAM = nullptr;
+	}
+
+	u32 Reply() { return Memory::Read_U32(COMMAND_ADDRESS + 4); }
+
+	u32 Read(CWII_IPC_HLE_Device_FileIO& fd, u32 size)
+	{
+		Memory::Write_U32(BUFFER_ADDRESS, COMMAND_ADDRESS + 0xC);
+		Memory::Write_U32(size, COMMAND_ADDRESS + 0x10);
+		fd.Read(COMMAND_ADDRESS);
+		return Reply();
+	}
+
+	u32 Write(CWII_IPC_HLE_Device_FileIO& fd, u32 size)
+	{
+		Memory::Write_U32(BUFFER_ADDRESS, COMMAND_ADDRESS + 0xC);
+		Memory::Write_U32(size, COMMAND_ADDRESS + 0x10);
+		fd.Write(COMMAND_ADDRESS);
+		return Reply();
+	}
+
+	u32 Seek(CWII_IPC_HLE_Device_FileIO& fd, u32 position)
+	{
+		Memory::Write_U32(position, COMMAND_ADDRESS + 0xC);
+		Memory::Write_U32(0, COMMAND_ADDRESS + 0x10); // SEEK_SET
+		fd.Seek(COMMAND_ADDRESS);
+		return Reply();
+	}
+
+	u32 GetFileLength(CWII_IPC_HLE_Device_FileIO& fd)
+	{
+		Memory::Write_U32(11, COMMAND_ADDRESS + 0xC); // ISFS_IOCTL_GETFILESTATS
+		Memory::Write_U32(STATS_ADDRESS, COMMAND_ADDRESS + 0x18);
+		fd.IOCtl(COMMAND_ADDRESS);
+		return Memory::Read_U32(STATS_ADDRESS);
+	}
+
+	const u8* Buffer() { return Memory::GetPointer(BUFFER_ADDRESS); }
+
+	std::vector<u8> m_ram;
+	std::vector<u8> m_save;
+	std::string m_root;
+	std::string m_old_root;
+};
+
+// What a game does when it loads its save: get the size, read the header,
+// then read the rest in small pieces.
+TEST_F(FileIOTest, SaveGameLoad)
+{
+	const int num_loads = 50;
+	bool data_matches = true;
+
+	auto start = std::chrono::high_resolution_clock::now();
+	for (int i = 0; i < num_loads; ++i)
+	{
+		CWII_IPC_HLE_Device_FileIO fd(0x30, SAVE_NAME);
+		fd.Open(COMMAND_ADDRESS, 1); // ISFS_OPEN_READ
+		ASSERT_EQ(0x30u, Reply());
+		ASSERT_EQ(SAVE_SIZE, GetFileLength(fd));
+
+		ASSERT_EQ(HEADER_SIZE, Read(fd, HEADER_SIZE));
+		data_matches &= memcmp(Buffer(), m_save.data(), HEADER_SIZE) == 0;
+		for (u32 offset = HEADER_SIZE; offset < SAVE_SIZE; offset += CHUNK_SIZE)
+		{
+			u32 size = std::min(CHUNK_SIZE, SAVE_SIZE - offset);
+			ASSERT_EQ(size, Read(fd, size));
+			data_matches &= memcmp(Buffer(), &m_save[offset], size) == 0;
+		}
+		fd.Close(COMMAND_ADDRESS, false);
+	}
+	auto ipc_end = std::chrono::high_resolution_clock::now();
+	EXPECT_TRUE(data_matches);
+
+	// The same reads done the way FileIO did them before it kept the file
+	// open: open, seek and read for every request.
+	std::vector<u8> buffer(CHUNK_SIZE);
+	auto reopen_start = std::chrono::high_resolution_clock::now();
+	for (int i = 0; i < num_loads; ++i)
+	{
+		for (u32 offset = 0; offset < SAVE_SIZE; offset += offset ? CHUNK_SIZE : HEADER_SIZE)
+		{
+			File::IOFile file(m_root + SAVE_NAME, "rb");
+			file.Seek(offset, SEEK_SET);
+			fread(buffer.data(), 1, offset ? CHUNK_SIZE : HEADER_SIZE, file.GetHandle());
+		}
+	}
+	auto reopen_end = std::chrono::high_resolution_clock::now();
+
+	printf("%d loads of 0x%x bytes in 0x%x byte reads:\n", num_loads, SAVE_SIZE, CHUNK_SIZE);
+	printf("FileIO                 %llu us\n", AS_US(ipc_end - start));
+	printf("Reopening per read     %llu us\n", AS_US(reopen_end - reopen_start));
+}
+
+TEST_F(FileIOTest, WritesAreSeenByOtherFds)
+{
+	CWII_IPC_HLE_Device_FileIO reader(0x30, SAVE_NAME);
+	CWII_IPC_HLE_Device_FileIO writer(0x31, SAVE_NAME);
+	reader.Open(COMMAND_ADDRESS, 1); // ISFS_OPEN_READ
+	writer.Open(COMMAND_ADDRESS, 3); // ISFS_OPEN_RW
+
+	// Fill the read-ahead buffer, then change data inside it.
+	ASSERT_EQ(HEADER_SIZE, Read(reader, HEADER_SIZE));
+
+	memset(Memory::GetPointer(BUFFER_ADDRESS), 0xAB, CHUNK_SIZE);
+	ASSERT_EQ(0x100u, Seek(writer, 0x100));
+	ASSERT_EQ(CHUNK_SIZE, Write(writer, CHUNK_SIZE));
+
+	ASSERT_EQ(0x100u, Seek(reader, 0x100));
+	ASSERT_EQ(CHUNK_SIZE, Read(reader, CHUNK_SIZE));
+	for (u32 i = 0; i < CHUNK_SIZE; ++i)
+		ASSERT_EQ(0xAB, Buffer()[i]);
+
+	// Read-only fds can't write.
+	EXPECT_NE(CHUNK_SIZE, Write(reader, CHUNK_SIZE));
+
+	// Reads at the end of the file are short.
+	ASSERT_EQ(SAVE_SIZE - 0x10, Seek(reader, SAVE_SIZE - 0x10));
+	EXPECT_EQ(0x10u, Read(reader, CHUNK_SIZE));
+	// And empty past it.
+	EXPECT_EQ(0u, Read(reader, 0x10));
+
+	reader.Close(COMMAND_ADDRESS, false);
+	writer.Close(COMMAND_ADDRESS, false);
+}
@@ -0,0 +1,611 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <atomic>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <enet/enet.h>
+#include <gtest/gtest.h>
+
+#include "Common/ChunkFile.h"
+#include "Common/CommonPaths.h"
+#include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
+#include "Common/Thread.h"
+#include "Core/ConfigManager.h"
+#include "Core/HW/EXI_DeviceMemoryCard.h"
+#include "Core/NetPlayClient.h"
+#include "Core/NetPlayServer.h"
+
+namespace
+{
+
+class TestNetPlayUI : public NetPlayUI
+{
+public:
+	void BootGame(const std::string&) override {}
+	void StopGame() override {}
+
+	void Update() override {}
+	void AppendChat(const std::string&) override {}
+
+	void OnMsgChangeGame(const std::string&) override {}
+	void OnMsgStartGame() override
+	{
+		client->StartGame("");
+		started = true;
+	}
+	void OnMsgStopGame() override {}
+	bool IsRecording() override { return false; }
+	void OnSaveSyncProgress(int save_index, u32 blocks_done, u32 blocks_total) override
+	{
+		save_blocks_done[save_index] = blocks_done;
+		save_blocks_total[save_index] = blocks_total;
+	}
+
+	NetPlayClient* client = nullptr;
+	std::atomic<bool> started{false};
+	std::atomic<u32> save_blocks_done[NUM_SAVE_SYNCS];
+	std::atomic<u32> save_blocks_total[NUM_SAVE_SYNCS];
+};
+
+// Stands in for the emulated game: its state is the pad values it was given
+// in each frame, which rollbacks save and load instead of a savestate.
+class TestNetPlayClient : public NetPlayClient
+{
+public:
+	TestNetPlayClient(u16 port, NetPlayUI* ui, const std::string& name)
+		: NetPlayClient("127.0.0.1", port, ui, name, false, "", 0)
+	{
+	}
+
+	// Polls both pads like SI does, with the frame number on the local pad,
+	// then runs the rollback event like CoreTiming would once SI is done.
+	bool RunFrame()
+	{
+		const u32 frame = next_frame;
+		for (u8 pad = 0; pad < 2; ++pad)
+		{
+			GCPadStatus status = {};
+			status.button = (u16)frame;
+			if (!GetNetPads(pad, &status))
+				return false;
+			received[pad].resize(frame);
+			received[pad].push_back(status.button);
+		}
+		next_frame = frame + 1;
+
+		if (m_event_scheduled)
+		{
+			m_event_scheduled = false;
+			OnRollbackEvent();
+			// Whether or not the game was rolled back, the client must be in the
+			// frame the game has just polled the pads for.
+			if (GetRollbackFrame() + 1 != next_frame)
+				++frame_mismatches;
+		}
+		return true;
+	}
+
+	struct Rollback
+	{
+		// the first frame the game was given a wrong prediction in
+		u32 first_wrong;
+		// the frame the game was in, and the one it was rolled back to
+		u32 from;
+		u32 to;
+	};
+
+	u32 next_frame = 0;
+	std::vector<u16> received[2];
+	u32 num_loads = 0;
+	std::vector<Rollback> rollbacks;
+	u32 frame_mismatches = 0;
+
+protected:
+	void ScheduleRollbackEvent() override { m_event_scheduled = true; }
+
+	void SaveRollbackBuffer(std::vector<u8>& buffer) override
+	{
+		u8* ptr = buffer.data();
+		PointerWrap p(&ptr, &buffer);
+		DoGameState(p);
+		buffer.resize(ptr - buffer.data());
+	}
+
+	void LoadRollbackBuffer(std::vector<u8>& buffer) override
+	{
+		// Each pad's input is the frame number of the client it belongs to.
+		Rollback rollback;
+		rollback.first_wrong = next_frame;
+		for (const std::vector<u16>& pad : received)
+		{
+			for (u32 frame = 0; frame < rollback.first_wrong && frame < pad.size(); ++frame)
+			{
+				if (pad[frame] != frame)
+					rollback.first_wrong = frame;
+			}
+		}
+		rollback.from = next_frame;
+
+		u8* ptr = buffer.data();
+		PointerWrap p(&ptr, PointerWrap::MODE_READ);
+		DoGameState(p);
+		++num_loads;
+
+		rollback.to = next_frame;
+		rollbacks.push_back(rollback);
+	}
+
+private:
+	void DoGameState(PointerWrap& p)
+	{
+		p.Do(next_frame);
+		p.Do(received[0]);
+		p.Do(received[1]);
+	}
+
+	bool m_event_scheduled = false;
+};
+
+// Forwards UDP datagrams between a client and a server on localhost, each
+// one after a delay, like a slow connection would.
+class LatencyProxy
+{
+public:
+	LatencyProxy(u16 port, u16 server_port, u32 delay_ms)
+		: m_delay(delay_ms)
+	{
+		enet_initialize();
+
+		ENetAddress address;
+		enet_address_set_host(&address, "127.0.0.1");
+		address.port = port;
+		m_client_socket = enet_socket_create(ENET_SOCKET_TYPE_DATAGRAM);
+		is_bound = m_client_socket != ENET_SOCKET_NULL && enet_socket_bind(m_client_socket, &address) == 0;
+
+		address.port = 0;
+		m_server_socket = enet_socket_create(ENET_SOCKET_TYPE_DATAGRAM);
+		is_bound = is_bound && m_server_socket != ENET_SOCKET_NULL && enet_socket_bind(m_server_socket, &address) == 0;
+
+		enet_address_set_host(&m_server_address, "127.0.0.1");
+		m_server_address.port = server_port;
+
+		if (!is_bound)
+			return;
+		enet_socket_set_option(m_client_socket, ENET_SOCKOPT_NONBLOCK, 1);
+		enet_socket_set_option(m_server_socket, ENET_SOCKOPT_NONBLOCK, 1);
+		m_running = true;
+		m_thread = std::thread(&LatencyProxy::Run, this);
+	}
+
+	~LatencyProxy()
+	{
+		if (m_running)
+		{
+			m_running = false;
+			m_thread.join();
+		}
+		if (m_client_socket != ENET_SOCKET_NULL)
+			enet_socket_destroy(m_client_socket);
+		if (m_server_socket != ENET_SOCKET_NULL)
+			enet_socket_destroy(m_server_socket);
+		enet_deinitialize();
+	}
+
+	bool is_bound;
+
+private:
+	struct Datagram
+	{
+		u32 time;
+		bool to_server;
+		std::vector<u8> data;
+	};
+
+	void Run()
+	{
+		while (m_running)
+		{
+			Receive(m_client_socket, true);
+			Receive(m_server_socket, false);
+
+			// Everything is delayed by the same time, so the queue is in the
+			// order the datagrams are due in.
+			const u32 now = enet_time_get();
+			while (!m_queue.empty() && now - m_queue.front().time >= m_delay)
+			{
+				Datagram& datagram = m_queue.front();
+				ENetBuffer buffer;
+				buffer.data = datagram.data.data();
+				buffer.dataLength = datagram.data.size();
+				if (datagram.to_server)
+					enet_socket_send(m_server_socket, &m_server_address, &buffer, 1);
+				else
+					enet_socket_send(m_client_socket, &m_client_address, &buffer, 1);
+				m_queue.pop_front();
+			}
+
+			Common::SleepCurrentThread(1);
+		}
+	}
+
+	void Receive(ENetSocket socket, bool to_server)
+	{
+		u8 data[ENET_PROTOCOL_MAXIMUM_MTU];
+		ENetBuffer buffer;
+		buffer.data = data;
+		buffer.dataLength = sizeof(data);
+		ENetAddress address;
+		int length;
+		while ((length = enet_socket_receive(socket, &address, &buffer, 1)) > 0)
+		{
+			if (to_server)
+				m_client_address = address;
+			m_queue.push_back({enet_time_get(), to_server, std::vector<u8>(data, data + length)});
+		}
+	}
+
+	const u32 m_delay;
+	ENetSocket m_client_socket;
+	ENetSocket m_server_socket;
+	ENetAddress m_client_address = {};
+	ENetAddress m_server_address;
+	std::deque<Datagram> m_queue;
+	std::atomic<bool> m_running{false};
+	std::thread m_thread;
+};
+
+template <typename Predicate>
+bool WaitUntil(Predicate pred)
+{
+	for (int i = 0; i < 5000 && !pred(); ++i)
+		Common::SleepCurrentThread(1);
+	return pred();
+}
+
+}  // namespace
+
+class NetPlayTest : public testing::Test
+{
+protected:
+	static const u16 PORT = 52626;
+
+	virtual void SetUp() override
+	{
+		SConfig::Init();
+
+		m_server.reset(new NetPlayServer(PORT, false, "", 0));
+		ASSERT_TRUE(m_server->is_connected);
+
+		for (int i = 0; i < 2; ++i)
+		{
+			m_clients[i].reset(new TestNetPlayClient(GetClientPort(i), &m_ui[i], i ? "two" : "one"));
+			ASSERT_TRUE(m_clients[i]->is_connected);
+			m_ui[i].client = m_clients[i].get();
+		}
+		for (auto& client : m_clients)
+		{
+			ASSERT_TRUE(WaitUntil([&] {
+				std::vector<const Player*> players;
+				client->GetPlayers(players);
+				return players.size() == 2;
+			}));
+		}
+	}
+
+	virtual void TearDown() override
+	{
+		for (auto& client : m_clients)
+		{
+			if (client)
+				client->StopGame();
+		}
+		m_clients[0].reset();
+		m_clients[1].reset();
+		m_server.reset();
+	}
+
+	virtual u16 GetClientPort(int client) { return PORT; }
+
+	void StartGame()
+	{
+		m_server->StartGame("");
+		ASSERT_TRUE(WaitUntil([&] { return m_ui[0].started && m_ui[1].started; }));
+	}
+
+	// Runs both clients until their games have reached the given frame. The
+	// second one runs at half the speed of the first if <slow_second> is set.
+	void Run(u32 num_frames, bool slow_second = false)
+	{
+		auto run = [&](int client) {
+			while (m_clients[client]->next_frame < num_frames)
+			{
+				ASSERT_TRUE(m_clients[client]->RunFrame());
+				// Roughly the rate a game polls pads at.
+				Common::SleepCurrentThread(client && slow_second ? 2 : 1);
+			}
+		};
+		std::thread first(run, 0);
+		std::thread second(run, 1);
+		first.join();
+		second.join();
+	}
+
+	std::unique_ptr<NetPlayServer> m_server;
+	TestNetPlayUI m_ui[2];
+	std::unique_ptr<TestNetPlayClient> m_clients[2];
+};
+
+TEST_F(NetPlayTest, LoopbackPads)
+{
+	const u32 num_frames = 300;
+	StartGame();
+	Run(num_frames);
+
+	// Both clients must see the same input, delayed by the pad buffer.
+	for (int pad = 0; pad < 2; ++pad)
+	{
+		ASSERT_EQ(m_clients[0]->received[pad], m_clients[1]->received[pad]);
+		EXPECT_EQ(num_frames - 1 - 5, m_clients[0]->received[pad].back());
+	}
+	EXPECT_EQ(0u, m_clients[0]->num_loads);
+
+	// The latency of the other client's input was measured.
+	for (auto& client : m_clients)
+	{
+		std::vector<const Player*> players;
+		client->GetPlayers(players);
+		int measured = 0;
+		for (const Player* player : players)
+		{
+			if (!player->input_latency.count)
+				continue;
+			++measured;
+			printf("%s: %s\n", player->name.c_str(), player->input_latency.ToString().c_str());
+		}
+		EXPECT_EQ(1, measured);
+	}
+}
+
+// The local input is used right away and the other player's is predicted.
+// The first client runs ahead of the second one, so its predictions are wrong
+// and it has to roll back and run the frames again with the right input.
+TEST_F(NetPlayTest, RollbackPads)
+{
+	const int num_frames = 300;
+	const int rollback_frames = 4;
+	m_server->SetRollbackFrames(rollback_frames);
+	StartGame();
+	Run(num_frames, true);
+
+	EXPECT_LT(0u, m_clients[0]->num_loads);
+	for (auto& client : m_clients)
+	{
+		for (int pad = 0; pad < 2; ++pad)
+		{
+			const std::vector<u16>& received = client->received[pad];
+			ASSERT_EQ(num_frames, (int)received.size());
+			for (int frame = 0; frame < num_frames; ++frame)
+			{
+				// Wrong predictions can only be left in the last frames, which
+				// weren't run again before the game stopped.
+				if (frame < num_frames - 2 * rollback_frames)
+					EXPECT_EQ(frame, received[frame]) << "pad " << pad;
+				// The other client can't be further behind than the rollback window.
+				EXPECT_LE(frame - rollback_frames, received[frame]);
+				EXPECT_GE(frame, received[frame]);
+			}
+		}
+	}
+}
+
+// The second client is connected through a proxy that delays everything it
+// sends and receives.
+class NetPlayLatencyTest : public NetPlayTest
+{
+protected:
+	static const u16 PROXY_PORT = 52628;
+	static const u32 LATENCY_MS = 20;
+
+	virtual void SetUp() override
+	{
+		m_proxy.reset(new LatencyProxy(PROXY_PORT, PORT, LATENCY_MS));
+		ASSERT_TRUE(m_proxy->is_bound);
+		NetPlayTest::SetUp();
+	}
+
+	virtual void TearDown() override
+	{
+		NetPlayTest::TearDown();
+		m_proxy.reset();
+	}
+
+	u16 GetClientPort(int client) override { return client ? PROXY_PORT : PORT; }
+
+	std::unique_ptr<LatencyProxy> m_proxy;
+};
+
+// Each client's input takes longer to reach the other one than the frames
+// that can be rolled back last, so both keep running ahead on predictions that
+// are wrong (the input changes every frame) and have to roll back.
+TEST_F(NetPlayLatencyTest, RollbackPads)
+{
+	const int num_frames = 300;
+	const int rollback_frames = 4;
+	m_server->SetRollbackFrames(rollback_frames);
+	StartGame();
+	Run(num_frames);
+
+	for (auto& client : m_clients)
+	{
+		printf("%u rollbacks\n", client->num_loads);
+		EXPECT_LT(0u, client->num_loads);
+		EXPECT_EQ(0u, client->frame_mismatches);
+
+		// The game goes back to the state from just before the first frame it
+		// got a wrong prediction in.
+		for (const TestNetPlayClient::Rollback& rollback : client->rollbacks)
+		{
+			EXPECT_EQ(rollback.first_wrong, rollback.to);
+			EXPECT_LT(rollback.to, rollback.from);
+		}
+
+		// The frames were run again with the input the other client sent.
+		for (int pad = 0; pad < 2; ++pad)
+		{
+			const std::vector<u16>& received = client->received[pad];
+			ASSERT_EQ(num_frames, (int)received.size());
+			for (int frame = 0; frame < num_frames - 2 * rollback_frames; ++frame)
+				EXPECT_EQ(frame, received[frame]) << "pad " << pad;
+		}
+	}
+}
+
+// Only the blocks of the host's memory card that differ from the client's copy
+// are transferred before the game starts. The host's own client keeps using
+// the card itself.
+TEST(NetPlayMemcardTest, SyncsDifferingBlocks)
+{
+	const u16 port = 52627;
+	const u32 num_blocks = 64;
+	SConfig::Init();
+
+	const std::string old_gc_dir = File::GetUserPath(D_GCUSER_IDX);
+	const std::string root = File::GetTempFilenameForAtomicWrite("NetPlayMemcardTest") + "/";
+	File::CreateFullPath(root);
+	File::SetUserPath(D_GCUSER_IDX, root);
+
+	std::vector<u8> card(num_blocks * SAVE_SYNC_BLOCK_SIZE);
+	for (size_t i = 0; i < card.size(); ++i)
+		card[i] = (u8)(i * 7 / 3);
+	SConfig::GetInstance().m_strMemoryCardA = root + "HostA.raw";
+	File::IOFile(SConfig::GetInstance().m_strMemoryCardA, "wb").WriteBytes(card.data(), card.size());
+
+	NetPlayServer server(port, false, "", 0);
+	ASSERT_TRUE(server.is_connected);
+	NetSettings settings = {};
+	settings.m_EXIDevice[0] = EXIDEVICE_MEMORYCARD;
+	settings.m_EXIDevice[1] = EXIDEVICE_NONE;
+	server.SetNetSettings(settings);
+
+	TestNetPlayUI host_ui;
+	NetPlayClient host("127.0.0.1", port, &host_ui, "host", false, "", 0);
+	ASSERT_TRUE(host.is_connected);
+	host_ui.client = &host;
+	server.SetHostPlayer(host.GetLocalPlayerId());
+	ASSERT_TRUE(WaitUntil([&] {
+		std::vector<const Player*> players;
+		host.GetPlayers(players);
+		return players.size() == 1;
+	}));
+
+	TestNetPlayUI ui;
+	NetPlayClient client("127.0.0.1", port, &ui, "one", false, "", 0);
+	ASSERT_TRUE(client.is_connected);
+	ui.client = &client;
+
+	auto sync = [&] {
+		host_ui.started = false;
+		ui.started = false;
+		ui.save_blocks_total[0] = 0xFFFFFFFF;
+		server.StartGame("");
+		ASSERT_TRUE(WaitUntil([&] { return host_ui.started && ui.started; }));
+		host.StopGame();
+		client.StopGame();
+		ASSERT_EQ("", host.GetMemcardPath(0));
+		ASSERT_EQ(root + "NetPlayA.raw", client.GetMemcardPath(0));
+		ASSERT_EQ("", client.GetMemcardPath(1));
+
+		std::string synced;
+		ASSERT_TRUE(File::ReadFileToString(root + "NetPlayA.raw", synced));
+		ASSERT_EQ(std::string(card.begin(), card.end()), synced);
+	};
+
+	// The client has no copy yet, so every block is transferred.
+	sync();
+	EXPECT_EQ(num_blocks, ui.save_blocks_total[0]);
+	EXPECT_EQ(num_blocks, ui.save_blocks_done[0]);
+
+	card[3 * SAVE_SYNC_BLOCK_SIZE + 5] ^= 1;
+	card[40 * SAVE_SYNC_BLOCK_SIZE] ^= 1;
+	File::IOFile(SConfig::GetInstance().m_strMemoryCardA, "wb").WriteBytes(card.data(), card.size());
+	sync();
+	EXPECT_EQ(2u, ui.save_blocks_total[0]);
+	EXPECT_EQ(2u, ui.save_blocks_done[0]);
+
+	sync();
+	EXPECT_EQ(0u, ui.save_blocks_total[0]);
+
+	File::SetUserPath(D_GCUSER_IDX, old_gc_dir);
+	File::DeleteDirRecursively(root);
+}
+
+// A GCI folder is synced file by file, and the client's copy ends up with
+// exactly the host's files.
+TEST(NetPlayMemcardTest, SyncsGciFolder)
+{
+	const u16 port = 52627;
+	SConfig::Init();
+
+	const std::string old_gc_dir = File::GetUserPath(D_GCUSER_IDX);
+	const std::string root = File::GetTempFilenameForAtomicWrite("NetPlayMemcardTest") + "/";
+	File::CreateFullPath(root);
+	File::SetUserPath(D_GCUSER_IDX, root);
+
+	const std::string host_dir = root + EUR_DIR DIR_SEP "Card A" DIR_SEP;
+	const std::string client_dir = root + "NetPlay Card A" DIR_SEP;
+	ASSERT_EQ(root + EUR_DIR DIR_SEP "Card A", CEXIMemoryCard::GetGciFolderPathForGame(0, ""));
+	File::CreateFullPath(host_dir);
+	File::CreateFullPath(client_dir);
+	const std::string save(3 * SAVE_SYNC_BLOCK_SIZE + 100, 'x');
+	ASSERT_TRUE(File::WriteStringToFile(save, host_dir + "01-GALE-save.gci"));
+	ASSERT_TRUE(File::WriteStringToFile("not a save", host_dir + "notes.txt"));
+	ASSERT_TRUE(File::WriteStringToFile("old", client_dir + "01-GALE-old.gci"));
+
+	NetPlayServer server(port, false, "", 0);
+	ASSERT_TRUE(server.is_connected);
+	NetSettings settings = {};
+	settings.m_EXIDevice[0] = EXIDEVICE_MEMORYCARDFOLDER;
+	settings.m_EXIDevice[1] = EXIDEVICE_NONE;
+	server.SetNetSettings(settings);
+
+	TestNetPlayUI host_ui;
+	NetPlayClient host("127.0.0.1", port, &host_ui, "host", false, "", 0);
+	ASSERT_TRUE(host.is_connected);
+	host_ui.client = &host;
+	server.SetHostPlayer(host.GetLocalPlayerId());
+	ASSERT_TRUE(WaitUntil([&] {
+		std::vector<const Player*> players;
+		host.GetPlayers(players);
+		return players.size() == 1;
+	}));
+
+	TestNetPlayUI ui;
+	NetPlayClient client("127.0.0.1", port, &ui, "one", false, "", 0);
+	ASSERT_TRUE(client.is_connected);
+	ui.client = &client;
+
+	server.StartGame("");
+	ASSERT_TRUE(WaitUntil([&] { return host_ui.started && ui.started; }));
+	host.StopGame();
+	client.StopGame();
+
+	EXPECT_EQ("", host.GetMemcardPath(0));
+	EXPECT_EQ(root + "NetPlay Card A", client.GetMemcardPath(0));
+	EXPECT_EQ(4u, ui.save_blocks_total[0]);
+	EXPECT_EQ(4u, ui.save_blocks_done[0]);
+
+	std::string synced;
+	EXPECT_TRUE(File::ReadFileToString(client_dir + "01-GALE-save.gci", synced));
+	EXPECT_EQ(save, synced);
+	EXPECT_FALSE(File::Exists(client_dir + "notes.txt"));
+	EXPECT_FALSE(File::Exists(client_dir + "01-GALE-old.gci"));
+
+	File::SetUserPath(D_GCUSER_IDX, old_gc_dir);
+	File::DeleteDirRecursively(root);
+}
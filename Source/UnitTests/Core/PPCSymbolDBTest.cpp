@@ -0,0 +1,196 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "Common/CommonFuncs.h"
+#include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
+#include "Common/StringUtil.h"
+#include "Core/HW/Memmap.h"
+#include "Core/PowerPC/PowerPC.h"
+#include "Core/PowerPC/PPCAnalyst.h"
+#include "Core/PowerPC/PPCSymbolDB.h"
+#include "Core/PowerPC/PPCTables.h"
+
+#define AS_US(diff) ((unsigned long long)std::chrono::duration_cast<std::chrono::microseconds>(diff).count())
+
+namespace
+{
+
+const int NUM_FUNCTIONS = 50000;
+
+// The lookup as it was done before the ranges were indexed.
+Symbol* LinearLookup(PPCSymbolDB& db, u32 addr)
+{
+	auto it = db.AccessSymbols().find(addr);
+	if (it != db.AccessSymbols().end())
+		return &it->second;
+
+	for (auto& p : db.AccessSymbols())
+	{
+		if (addr >= p.second.address && addr < p.second.address + p.second.size)
+			return &p.second;
+	}
+	return nullptr;
+}
+
+}
+
+class PPCSymbolDBTest : public testing::Test
+{
+protected:
+	virtual void SetUp() override
+	{
+		// Functions are analyzed when they are added, which only needs RAM to
+		// be there; the rest of the memory system isn't set up.
+		m_ram.resize(Memory::RAM_SIZE);
+		Memory::m_pRAM = m_ram.data();
+		PPCTables::InitTables(PowerPC::CORE_INTERPRETER);
+		UReg_MSR msr = MSR;
+		msr.DR = 1;
+		MSR = msr.Hex;
+
+		m_map_filename = File::GetTempFilenameForAtomicWrite("PPCSymbolDBTest.map");
+		WriteMap();
+	}
+
+	virtual void TearDown() override
+	{
+		File::Delete(m_map_filename);
+		Memory::m_pRAM = nullptr;
+	}
+
+	// A map of mostly adjacent functions, with some gaps and some functions
+	// overlapping the ones after them.
+	void WriteMap()
+	{
+		std::mt19937 rng(42);
+		std::uniform_int_distribution<int> size_dist(1, 64);
+		std::uniform_int_distribution<int> kind_dist(0, 9);
+
+		File::IOFile f(m_map_filename, "w");
+		fprintf(f.GetHandle(), ".text section layout\n");
+
+		u32 address = 0x80004000;
+		for (int i = 0; i < NUM_FUNCTIONS; ++i)
+		{
+			u32 size = size_dist(rng) * 4;
+			int kind = kind_dist(rng);
+			u32 listed_size = kind == 0 ? size * 3 : size;
+			fprintf(f.GetHandle(), "  %08x %06x %08x  4 func_%d \tfile.o\n", address & 0x0FFFFFFF, listed_size, address, i);
+
+			address += size;
+			if (kind == 1)
+				address += 0x20;
+		}
+		m_end_address = address;
+
+		// The functions are analyzed when loading the map, give them valid
+		// instructions.
+		for (u32 addr = 0x80004000; addr < m_end_address + 0x1000; addr += 4)
+			*(u32*)&m_ram[addr & Memory::RAM_MASK] = Common::swap32(0x60000000); // nop
+	}
+
+	std::vector<u8> m_ram;
+	std::string m_map_filename;
+	u32 m_end_address;
+};
+
+TEST_F(PPCSymbolDBTest, LookupMatchesLinearScan)
+{
+	PPCSymbolDB db;
+	auto start = std::chrono::high_resolution_clock::now();
+	ASSERT_TRUE(db.LoadMap(m_map_filename));
+	auto loaded = std::chrono::high_resolution_clock::now();
+	EXPECT_EQ(NUM_FUNCTIONS, (int)db.Symbols().size());
+
+	std::mt19937 rng(1234);
+	std::uniform_int_distribution<u32> addr_dist(0x80003F00, m_end_address + 0x100);
+	const int num_linear_lookups = 2000;
+	std::vector<u32> addresses;
+	std::vector<Symbol*> expected;
+	auto linear_start = std::chrono::high_resolution_clock::now();
+	for (int i = 0; i < num_linear_lookups; ++i)
+	{
+		addresses.push_back(addr_dist(rng) & ~3);
+		expected.push_back(LinearLookup(db, addresses.back()));
+	}
+	auto linear_end = std::chrono::high_resolution_clock::now();
+
+	for (int i = 0; i < num_linear_lookups; ++i)
+		ASSERT_EQ(expected[i], db.GetSymbolFromAddr(addresses[i])) << StringFromFormat("address %08x", addresses[i]);
+
+	const int num_lookups = 1000000;
+	int found = 0;
+	auto lookup_start = std::chrono::high_resolution_clock::now();
+	for (int i = 0; i < num_lookups; ++i)
+	{
+		if (db.GetSymbolFromAddr(addr_dist(rng) | 2))
+			++found;
+	}
+	auto lookup_end = std::chrono::high_resolution_clock::now();
+	EXPECT_GT(found, 0);
+
+	printf("%d symbols:\n", NUM_FUNCTIONS);
+	printf("LoadMap                %llu us\n", AS_US(loaded - start));
+	printf("%d linear lookups   %llu us\n", num_linear_lookups, AS_US(linear_end - linear_start));
+	printf("%d lookups        %llu us\n", num_lookups, AS_US(lookup_end - lookup_start));
+}
+
+TEST_F(PPCSymbolDBTest, RangesFollowChanges)
+{
+	PPCSymbolDB db;
+	db.AddKnownSymbol(0x80001000, 0x100, "first");
+	ASSERT_NE(nullptr, db.GetSymbolFromAddr(0x80001080));
+	EXPECT_EQ("first", db.GetSymbolFromAddr(0x80001080)->name);
+	EXPECT_EQ(nullptr, db.GetSymbolFromAddr(0x80002080));
+
+	db.AddKnownSymbol(0x80002000, 0x100, "second");
+	ASSERT_NE(nullptr, db.GetSymbolFromAddr(0x80002080));
+	EXPECT_EQ("second", db.GetSymbolFromAddr(0x80002080)->name);
+
+	db.Clear();
+	EXPECT_EQ(nullptr, db.GetSymbolFromAddr(0x80001080));
+}
+
+TEST_F(PPCSymbolDBTest, FindFunctions)
+{
+	// Many small functions, each one called by the one before it, and every
+	// fourth one only reachable by following the one before it.
+	const u32 start = 0x80100000;
+	const int num_funcs = 4000;
+	const u32 func_size = 0x10;
+	for (int i = 0; i < num_funcs; ++i)
+	{
+		u32 addr = start + i * func_size;
+		bool call_next = i + 1 < num_funcs && (i + 1) % 4 != 0;
+		PowerPC::HostWrite_U32(0x60000000, addr); // nop
+		PowerPC::HostWrite_U32(call_next ? 0x48000000 | (func_size - 4) | 1 : 0x60000000, addr + 4); // bl next : nop
+		PowerPC::HostWrite_U32(0x60000000, addr + 8); // nop
+		PowerPC::HostWrite_U32(0x4e800020, addr + 12); // blr
+	}
+	// The first function is called from somewhere else.
+	PowerPC::HostWrite_U32(0x48000001 | (start - 0x80000100), 0x80000100);
+	PowerPC::HostWrite_U32(0, start + num_funcs * func_size);
+
+	g_symbolDB.Clear();
+	PPCAnalyst::FindFunctions(0x80000000, start + num_funcs * func_size, &g_symbolDB);
+
+	EXPECT_EQ(num_funcs, (int)g_symbolDB.Symbols().size());
+	for (int i = 0; i < num_funcs; ++i)
+	{
+		u32 addr = start + i * func_size;
+		Symbol* symbol = g_symbolDB.GetSymbolFromAddr(addr);
+		ASSERT_NE(nullptr, symbol) << StringFromFormat("function %d", i);
+		EXPECT_EQ(addr, symbol->address);
+		EXPECT_EQ((int)func_size, symbol->size);
+	}
+	g_symbolDB.Clear();
+}
@@ -0,0 +1,201 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/Thread.h"
+#include "Core/ConfigManager.h"
+#include "VideoCommon/AsyncRequests.h"
+#include "VideoCommon/RenderBase.h"
+
+namespace
+{
+
+const int NUM_PRODUCERS = 4;
+
+// Records the pokes of each producer, which uses its index as x, and answers
+// peeks with their coordinates.
+class TestRenderer : public Renderer
+{
+public:
+	void SetColorMask() override {}
+	void SetBlendMode(bool forceUpdate) override {}
+	void SetScissorRect(const EFBRectangle& rc) override {}
+	void SetGenerationMode() override {}
+	void SetDepthMode() override {}
+	void SetLogicOpMode() override {}
+	void SetDitherMode() override {}
+	void SetSamplerState(int stage, int texindex, bool custom_tex) override {}
+	void SetInterlacingMode() override {}
+	void SetViewport() override {}
+	void ApplyState(bool bUseDstAlpha) override {}
+	void RestoreState() override {}
+	TargetRectangle ConvertEFBRectangle(const EFBRectangle& rc) override { return TargetRectangle(); }
+	void RenderText(const std::string& text, int left, int top, u32 color) override {}
+	void ClearScreen(const EFBRectangle& rc, bool colorEnable, bool alphaEnable, bool zEnable, u32 color, u32 z) override {}
+	void ReinterpretPixelData(unsigned int convtype) override {}
+	u16 BBoxRead(int index) override { return (u16)index; }
+	void BBoxWrite(int index, u16 value) override {}
+	void ResetAPIState() override {}
+	void RestoreAPIState() override {}
+	void SwapImpl(u32 xfbAddr, u32 fbWidth, u32 fbStride, u32 fbHeight, const EFBRectangle& rc, float Gamma) override {}
+	bool SaveScreenshot(const std::string& filename, const TargetRectangle& rc) override { return false; }
+	int GetMaxTextureSize() override { return 0; }
+
+	u32 AccessEFB(EFBAccessType type, u32 x, u32 y, u32 poke_data) override
+	{
+		if (type == POKE_COLOR)
+		{
+			pokes[x].push_back(poke_data);
+			return 0;
+		}
+		return x << 16 | y;
+	}
+
+	std::vector<u32> pokes[NUM_PRODUCERS];
+};
+
+}  // namespace
+
+class AsyncRequestsTest : public testing::Test
+{
+protected:
+	virtual void SetUp() override
+	{
+		SConfig::Init();
+		// RunGpu only wakes up the GPU thread then, which the tests stand in for.
+		SConfig::GetInstance().m_LocalCoreStartupParameter.bCPUThread = true;
+
+		m_renderer = new TestRenderer;
+		g_renderer = m_renderer;
+		m_requests = AsyncRequests::GetInstance();
+		m_requests->SetEnable(true);
+		m_requests->SetPassthrough(false);
+	}
+
+	virtual void TearDown() override
+	{
+		StopGpuThread();
+		m_requests->SetEnable(false);
+		m_requests->SetPassthrough(true);
+		g_renderer = nullptr;
+		delete m_renderer;
+		SConfig::Shutdown();
+	}
+
+	void StartGpuThread()
+	{
+		m_gpu_running = true;
+		m_gpu_thread = std::thread([this] {
+			while (m_gpu_running)
+			{
+				m_requests->PullEvents();
+				Common::YieldCPU();
+			}
+		});
+	}
+
+	void StopGpuThread()
+	{
+		m_gpu_running = false;
+		if (m_gpu_thread.joinable())
+			m_gpu_thread.join();
+	}
+
+	static AsyncRequests::Event Poke(u16 x, u32 data)
+	{
+		AsyncRequests::Event e = {};
+		e.type = AsyncRequests::Event::EFB_POKE_COLOR;
+		e.efb_poke.x = x;
+		e.efb_poke.y = 0;
+		e.efb_poke.data = data;
+		return e;
+	}
+
+	static AsyncRequests::Event Peek(u16 x, u16 y, u32* data)
+	{
+		AsyncRequests::Event e = {};
+		e.type = AsyncRequests::Event::EFB_PEEK_COLOR;
+		e.efb_peek.x = x;
+		e.efb_peek.y = y;
+		e.efb_peek.data = data;
+		return e;
+	}
+
+	TestRenderer* m_renderer;
+	AsyncRequests* m_requests;
+	std::thread m_gpu_thread;
+	std::atomic<bool> m_gpu_running{false};
+};
+
+// Several threads queue pokes and wait for peeks at once. The GPU thread
+// starts late, so the ring fills up first. Every event arrives once, in the
+// order each thread queued it.
+TEST_F(AsyncRequestsTest, MultipleProducers)
+{
+	const u32 num_pokes = 10000;
+	std::vector<std::thread> producers;
+	std::atomic<int> wrong_peeks(0);
+	for (int p = 0; p < NUM_PRODUCERS; ++p)
+	{
+		producers.emplace_back([&, p] {
+			for (u32 i = 0; i < num_pokes; ++i)
+			{
+				m_requests->PushEvent(Poke((u16)p, i), false);
+				if (i % 1000 == 999)
+				{
+					u32 result = 0;
+					m_requests->PushEvent(Peek((u16)p, (u16)i, &result), true);
+					if (result != ((u32)p << 16 | (u16)i))
+						++wrong_peeks;
+				}
+			}
+		});
+	}
+
+	Common::SleepCurrentThread(20);
+	StartGpuThread();
+	for (std::thread& producer : producers)
+		producer.join();
+	StopGpuThread();
+
+	EXPECT_EQ(0, wrong_peeks.load());
+	for (int p = 0; p < NUM_PRODUCERS; ++p)
+	{
+		const std::vector<u32>& pokes = m_renderer->pokes[p];
+		ASSERT_EQ(num_pokes, pokes.size()) << "producer " << p;
+		for (u32 i = 0; i < num_pokes; ++i)
+			ASSERT_EQ(i, pokes[i]) << "producer " << p;
+	}
+}
+
+// Once the GPU thread has stopped, threads waiting for it to make room in a
+// full ring or to handle a blocking event give up.
+TEST_F(AsyncRequestsTest, GiveUpWhenDisabled)
+{
+	std::atomic<int> returned(0);
+	std::vector<std::thread> producers;
+	producers.emplace_back([&] {
+		for (u32 i = 0; i < 5000; ++i)
+			m_requests->PushEvent(Poke(0, i), false);
+		++returned;
+	});
+	producers.emplace_back([&] {
+		u32 result = 0;
+		m_requests->PushEvent(Peek(1, 1, &result), true);
+		++returned;
+	});
+
+	Common::SleepCurrentThread(20);
+	EXPECT_EQ(0, returned.load());
+	m_requests->SetEnable(false);
+	for (std::thread& producer : producers)
+		producer.join();
+	EXPECT_EQ(2, returned.load());
+	EXPECT_TRUE(m_renderer->pokes[0].empty());
+}
@@ -0,0 +1,82 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Core/ConfigManager.h"
+#include "VideoCommon/AsyncRequests.h"
+#include "VideoCommon/EFBCache.h"
+
+TEST(EFBCache, LookupStoredTile)
+{
+	EFBCache::Invalidate();
+
+	// The last row of tiles is cut off by the bottom of the EFB.
+	const u32 x = 130, y = EFB_HEIGHT - 1;
+	EFBRectangle rc = EFBCache::GetTileRect(x, y);
+	EXPECT_EQ(128, rc.left);
+	EXPECT_EQ(192, rc.right);
+	EXPECT_EQ(EFBCache::TILE_SIZE * (EFBCache::TILES_HIGH - 1), rc.top);
+	EXPECT_EQ(EFB_HEIGHT, rc.bottom);
+
+	std::vector<u32> tile(EFBCache::TILE_SIZE * EFBCache::TILE_SIZE);
+	for (size_t i = 0; i < tile.size(); ++i)
+		tile[i] = (u32)i;
+
+	u32 value = 0;
+	EXPECT_FALSE(EFBCache::Lookup(PEEK_COLOR, x, y, &value));
+	EFBCache::StoreTile(PEEK_COLOR, x, y, tile.data());
+
+	ASSERT_TRUE(EFBCache::Lookup(PEEK_COLOR, x, y, &value));
+	EXPECT_EQ((y - rc.top) * EFBCache::TILE_SIZE + (x - rc.left), value);
+	ASSERT_TRUE(EFBCache::Lookup(PEEK_COLOR, rc.left, rc.top, &value));
+	EXPECT_EQ(0u, value);
+
+	// Depth and the neighbouring tiles aren't cached.
+	EXPECT_FALSE(EFBCache::Lookup(PEEK_Z, x, y, &value));
+	EXPECT_FALSE(EFBCache::Lookup(PEEK_COLOR, rc.right, y, &value));
+	EXPECT_FALSE(EFBCache::Lookup(PEEK_COLOR, x, EFB_HEIGHT, &value));
+
+	EFBCache::Invalidate();
+	EXPECT_FALSE(EFBCache::Lookup(PEEK_COLOR, x, y, &value));
+}
+
+// A peek after a queued poke or swap must wait for the GPU thread to get to
+// them, rather than see the cached EFB from before.
+TEST(EFBCache, QueuedChangesInvalidate)
+{
+	SConfig::Init();
+	// Only wakes up the GPU thread, which isn't running here.
+	SConfig::GetInstance().m_LocalCoreStartupParameter.bCPUThread = true;
+	AsyncRequests* requests = AsyncRequests::GetInstance();
+	requests->SetEnable(true);
+	requests->SetPassthrough(false);
+
+	std::vector<u32> tile(EFBCache::TILE_SIZE * EFBCache::TILE_SIZE);
+	u32 value = 0;
+	for (auto type : { AsyncRequests::Event::EFB_POKE_COLOR, AsyncRequests::Event::SWAP_EVENT })
+	{
+		EFBCache::StoreTile(PEEK_COLOR, 0, 0, tile.data());
+		ASSERT_TRUE(EFBCache::Lookup(PEEK_COLOR, 1, 1, &value));
+
+		AsyncRequests::Event e = {};
+		e.type = type;
+		requests->PushEvent(e, false);
+		EXPECT_FALSE(EFBCache::Lookup(PEEK_COLOR, 1, 1, &value)) << type;
+	}
+
+	// Other requests leave the EFB alone.
+	EFBCache::StoreTile(PEEK_COLOR, 0, 0, tile.data());
+	AsyncRequests::Event e = {};
+	e.type = AsyncRequests::Event::BBOX_READ;
+	requests->PushEvent(e, false);
+	EXPECT_TRUE(EFBCache::Lookup(PEEK_COLOR, 1, 1, &value));
+
+	requests->SetEnable(false);
+	requests->SetPassthrough(true);
+	EFBCache::Invalidate();
+	SConfig::Shutdown();
+}
@@ -0,0 +1,199 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/StringUtil.h"
+#include "VideoBackends/Software/EfbInterface.h"
+#include "VideoBackends/Software/Tev.h"
+#include "VideoCommon/BPMemory.h"
+
+#define AS_US(diff) ((unsigned long long)std::chrono::duration_cast<std::chrono::microseconds>(diff).count())
+
+class TevTest : public testing::Test
+{
+protected:
+	virtual void SetUp() override
+	{
+		memset(&bpmem, 0, sizeof(bpmem));
+		bpmem.alpha_test.comp0 = AlphaTest::ALWAYS;
+		bpmem.alpha_test.comp1 = AlphaTest::ALWAYS;
+		bpmem.blendmode.colorupdate = 1;
+		bpmem.blendmode.alphaupdate = 1;
+		bpmem.genMode.numcolchans = 2;
+
+		m_scalar.reset(new Tev);
+		m_quad.reset(new Tev);
+		m_scalar->Init();
+		m_quad->Init();
+	}
+
+	// Random combiners without textures and indirect stages.
+	void RandomizeStages(std::mt19937& rng, int num_stages)
+	{
+		bpmem.genMode.numtevstages = num_stages - 1;
+		for (int i = 0; i < 16; ++i)
+		{
+			bpmem.combiners[i].colorC.hex = rng() & 0xffffff;
+			bpmem.combiners[i].alphaC.hex = rng() & 0xffffff;
+		}
+		for (int i = 0; i < 8; ++i)
+		{
+			bpmem.tevorders[i].hex = rng() & 0xffffff;
+			bpmem.tevorders[i].enable0 = 0;
+			bpmem.tevorders[i].enable1 = 0;
+			bpmem.tevksel[i].hex = rng() & 0xffffff;
+		}
+	}
+
+	void RandomizeRegisters(std::mt19937& rng)
+	{
+		for (int reg = 0; reg < 4; ++reg)
+		{
+			for (int comp = 0; comp < 4; ++comp)
+			{
+				s16 color = (s16)(rng() % 2048) - 1024;
+				s16 konst = (s16)(rng() % 256);
+				m_scalar->SetRegColor(reg, comp, false, color);
+				m_quad->SetRegColor(reg, comp, false, color);
+				m_scalar->SetRegColor(reg, comp, true, konst);
+				m_quad->SetRegColor(reg, comp, true, konst);
+			}
+		}
+	}
+
+	// A 2x2 block at x, y with random colors.
+	static void SetQuad(Tev* tev, std::mt19937& rng, int x, int y)
+	{
+		for (int i = 0; i < 4; ++i)
+		{
+			Tev::PixelInputs& pixel = tev->Quad[i];
+			pixel.Position[0] = x + (i & 1);
+			pixel.Position[1] = y + (i >> 1);
+			pixel.Position[2] = 0;
+			for (auto& color : pixel.Color)
+				for (u8& comp : color)
+					comp = (u8)rng();
+			memset(pixel.Uv, 0, sizeof(pixel.Uv));
+		}
+	}
+
+	// Draws the quad one pixel at a time.
+	static void DrawScalar(Tev* tev)
+	{
+		for (const Tev::PixelInputs& pixel : tev->Quad)
+		{
+			memcpy(tev->Position, pixel.Position, sizeof(tev->Position));
+			memcpy(tev->Color, pixel.Color, sizeof(tev->Color));
+			memcpy(tev->Uv, pixel.Uv, sizeof(tev->Uv));
+			tev->Draw();
+		}
+	}
+
+	std::unique_ptr<Tev> m_scalar;
+	std::unique_ptr<Tev> m_quad;
+};
+
+TEST_F(TevTest, QuadsMatchPixels)
+{
+	std::mt19937 rng(42);
+	int num_vectorized = 0;
+
+	for (int config = 0; config < 20000; ++config)
+	{
+		RandomizeStages(rng, 1 + config % 4);
+		RandomizeRegisters(rng);
+		bpmem.zcontrol.pixel_format = (config & 4) ? PEControl::RGBA6_Z24 : PEControl::RGB8_Z24;
+		if (!m_quad->CanDrawQuad())
+			continue;
+		++num_vectorized;
+
+		// The left half of the EFB is drawn one pixel at a time, the right one
+		// by quads. A few quads in a row, so registers carry over.
+		const int num_quads = 4;
+		for (int i = 0; i < num_quads; ++i)
+		{
+			std::mt19937 quad_rng(config * num_quads + i);
+			SetQuad(m_scalar.get(), quad_rng, i * 2, 0);
+			DrawScalar(m_scalar.get());
+
+			quad_rng.seed(config * num_quads + i);
+			SetQuad(m_quad.get(), quad_rng, EFB_WIDTH / 2 + i * 2, 0);
+			m_quad->DrawQuad(4);
+		}
+
+		for (int x = 0; x < num_quads * 2; ++x)
+		{
+			for (int y = 0; y < 2; ++y)
+			{
+				u8 expected[4], color[4];
+				EfbInterface::GetColor(x, y, expected);
+				EfbInterface::GetColor(EFB_WIDTH / 2 + x, y, color);
+				ASSERT_EQ(0, memcmp(expected, color, 4)) << StringFromFormat("config %d, pixel %d,%d", config, x, y);
+			}
+		}
+	}
+
+	EXPECT_GT(num_vectorized, 1000);
+}
+
+// Shading a 640x528 frame with four stages that don't depend on the previous
+// pixel.
+TEST_F(TevTest, Frame)
+{
+	std::mt19937 rng(42);
+	bpmem.genMode.numtevstages = 3;
+	for (int i = 0; i < 4; ++i)
+	{
+		TevStageCombiner::ColorCombiner& cc = bpmem.combiners[i].colorC;
+		TevStageCombiner::AlphaCombiner& ac = bpmem.combiners[i].alphaC;
+		cc.a = i ? 0 : 10; // prev.rgb or ras.rgb
+		cc.b = 14; // konst
+		cc.c = 10; // ras.rgb
+		cc.d = 2; // c0.rgb
+		cc.clamp = 1;
+		ac.a = i ? 0 : 5; // prev or ras
+		ac.b = 6; // konst
+		ac.c = 5; // ras
+		ac.d = 7; // zero
+		ac.clamp = 1;
+		bpmem.tevorders[i / 2].hex = 0;
+		bpmem.tevorders[i / 2].colorchan0 = 0;
+		bpmem.tevorders[i / 2].colorchan1 = 1;
+		bpmem.tevksel[i / 2].kcsel0 = 12 + i;
+		bpmem.tevksel[i / 2].kcsel1 = 12 + i;
+	}
+	RandomizeRegisters(rng);
+	ASSERT_TRUE(m_quad->CanDrawQuad());
+
+	const int width = 640, height = 528;
+	auto scalar_start = std::chrono::high_resolution_clock::now();
+	for (int y = 0; y < height; y += 2)
+	{
+		for (int x = 0; x < width; x += 2)
+		{
+			SetQuad(m_scalar.get(), rng, x, y);
+			DrawScalar(m_scalar.get());
+		}
+	}
+	auto quad_start = std::chrono::high_resolution_clock::now();
+	for (int y = 0; y < height; y += 2)
+	{
+		for (int x = 0; x < width; x += 2)
+		{
+			SetQuad(m_quad.get(), rng, x, y);
+			m_quad->DrawQuad(4);
+		}
+	}
+	auto quad_end = std::chrono::high_resolution_clock::now();
+
+	printf("%dx%d, 4 stages: per pixel %llu us, quads %llu us\n", width, height,
+	       AS_US(quad_start - scalar_start), AS_US(quad_end - quad_start));
+}
@@ -0,0 +1,231 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/StringUtil.h"
+#include "Core/HW/Memmap.h"
+#include "VideoBackends/Software/TextureSampler.h"
+#include "VideoCommon/BPMemory.h"
+#include "VideoCommon/TextureDecoder.h"
+
+#define AS_US(diff) ((unsigned long long)std::chrono::duration_cast<std::chrono::microseconds>(diff).count())
+
+namespace
+{
+
+const u32 TEXTURE_ADDRESS = 0x100000;
+const u32 TLUT_TMEM_OFFSET = 0x200; // In units of 512 bytes
+const int TEXTURE_SIZE = 128;
+
+const int FORMATS[] = {
+	GX_TF_I4, GX_TF_I8, GX_TF_IA4, GX_TF_IA8, GX_TF_RGB565, GX_TF_RGB5A3,
+	GX_TF_RGBA8, GX_TF_C4, GX_TF_C8, GX_TF_C14X2, GX_TF_CMPR
+};
+
+}
+
+class TextureSamplerTest : public testing::Test
+{
+protected:
+	virtual void SetUp() override
+	{
+		m_ram.resize(Memory::RAM_SIZE);
+		Memory::m_pRAM = m_ram.data();
+
+		std::mt19937 rng(42);
+		for (u32 i = 0; i < TEXTURE_SIZE * TEXTURE_SIZE * 4; ++i)
+			m_ram[TEXTURE_ADDRESS + i] = (u8)rng();
+		for (u32 i = 0; i < 0x8000; ++i)
+			texMem[(TLUT_TMEM_OFFSET << 9) + i] = (u8)rng();
+
+		memset(&bpmem, 0, sizeof(bpmem));
+		TextureSampler::Shutdown();
+	}
+
+	virtual void TearDown() override
+	{
+		TextureSampler::Shutdown();
+		Memory::m_pRAM = nullptr;
+	}
+
+	void SetTexture(int format)
+	{
+		FourTexUnits& unit = bpmem.tex[0];
+		unit.texImage0[0].width = TEXTURE_SIZE - 1;
+		unit.texImage0[0].height = TEXTURE_SIZE - 1;
+		unit.texImage0[0].format = format;
+		unit.texImage3[0].image_base = TEXTURE_ADDRESS >> 5;
+		unit.texTlut[0].tmem_offset = TLUT_TMEM_OFFSET;
+		unit.texTlut[0].tlut_format = GX_TL_RGB5A3;
+		unit.texMode0[0].wrap_s = 1;
+		unit.texMode0[0].wrap_t = 1;
+		TextureSampler::InvalidateCache();
+	}
+
+	// Wrap mode 1 of the sampler, including how it maps -1 to size - 2.
+	static int Wrap(int coord)
+	{
+		coord %= TEXTURE_SIZE;
+		return coord < 0 ? TEXTURE_SIZE - 1 + coord : coord;
+	}
+
+	// Bilinear filtering the way TextureSampler did it before it cached
+	// decoded textures.
+	void SampleDirect(s32 s, s32 t, int format, u8* sample)
+	{
+		const u8* src = Memory::GetPointer(TEXTURE_ADDRESS);
+		const u8* tlut = &texMem[TLUT_TMEM_OFFSET << 9];
+		s -= 64;
+		t -= 64;
+		int s0 = Wrap(s >> 7), s1 = Wrap((s >> 7) + 1);
+		int t0 = Wrap(t >> 7), t1 = Wrap((t >> 7) + 1);
+		int fs = s & 0x7f, ft = t & 0x7f;
+		u8 texels[4][4];
+		TexDecoder_DecodeTexel(texels[0], src, s0, t0, TEXTURE_SIZE - 1, format, tlut, GX_TL_RGB5A3);
+		TexDecoder_DecodeTexel(texels[1], src, s1, t0, TEXTURE_SIZE - 1, format, tlut, GX_TL_RGB5A3);
+		TexDecoder_DecodeTexel(texels[2], src, s0, t1, TEXTURE_SIZE - 1, format, tlut, GX_TL_RGB5A3);
+		TexDecoder_DecodeTexel(texels[3], src, s1, t1, TEXTURE_SIZE - 1, format, tlut, GX_TL_RGB5A3);
+		for (int c = 0; c < 4; ++c)
+		{
+			u32 sum = texels[0][c] * (128 - fs) * (128 - ft) + texels[1][c] * fs * (128 - ft) +
+			          texels[2][c] * (128 - fs) * ft + texels[3][c] * fs * ft;
+			sample[c] = (u8)(sum >> 14);
+		}
+	}
+
+	std::vector<u8> m_ram;
+};
+
+TEST_F(TextureSamplerTest, MatchesDirectDecoding)
+{
+	for (int format : FORMATS)
+	{
+		SetTexture(format);
+		const u8* tlut = &texMem[TLUT_TMEM_OFFSET << 9];
+		for (int t = 0; t < TEXTURE_SIZE; ++t)
+		{
+			for (int s = 0; s < TEXTURE_SIZE; ++s)
+			{
+				u8 expected[4], sample[4];
+				TexDecoder_DecodeTexel(expected, Memory::GetPointer(TEXTURE_ADDRESS), s, t, TEXTURE_SIZE - 1, format, tlut, GX_TL_RGB5A3);
+				TextureSampler::SampleMip(s << 7, t << 7, 0, false, 0, sample);
+				ASSERT_EQ(0, memcmp(expected, sample, 4)) << StringFromFormat("format %d, texel %d,%d", format, s, t);
+			}
+		}
+
+		// Bilinear filtering at places between texels.
+		for (s32 t = 0; t < TEXTURE_SIZE << 7; t += 37)
+		{
+			u8 expected[4], sample[4];
+			s32 s = (t * 7) % (TEXTURE_SIZE << 7);
+			SampleDirect(s, t, format, expected);
+			TextureSampler::SampleMip(s, t, 0, true, 0, sample);
+			ASSERT_EQ(0, memcmp(expected, sample, 4)) << StringFromFormat("format %d, sample %d,%d", format, s, t);
+		}
+	}
+}
+
+TEST_F(TextureSamplerTest, NoticesChangedTextures)
+{
+	SetTexture(GX_TF_I8);
+	u8 sample[4];
+	m_ram[TEXTURE_ADDRESS] = 0x10;
+	TextureSampler::SampleMip(0, 0, 0, false, 0, sample);
+	EXPECT_EQ(0x10, sample[0]);
+
+	// New texture data is picked up by the next draw.
+	m_ram[TEXTURE_ADDRESS] = 0x20;
+	TextureSampler::InvalidateCache();
+	TextureSampler::SampleMip(0, 0, 0, false, 0, sample);
+	EXPECT_EQ(0x20, sample[0]);
+
+	// So is a different palette.
+	SetTexture(GX_TF_C8);
+	TextureSampler::SampleMip(0, 0, 0, false, 0, sample);
+	u8 before = sample[0];
+	u8 index = m_ram[TEXTURE_ADDRESS];
+	texMem[(TLUT_TMEM_OFFSET << 9) + index * 2] ^= 0x7f;
+	TextureSampler::InvalidateCache();
+	TextureSampler::SampleMip(0, 0, 0, false, 0, sample);
+	EXPECT_NE(before, sample[0]);
+}
+
+TEST_F(TextureSamplerTest, SamplesMipLevels)
+{
+	SetTexture(GX_TF_I8);
+	const u8* src = Memory::GetPointer(TEXTURE_ADDRESS);
+	u32 level_offset = 0;
+	for (int mip = 0; mip < 3; ++mip)
+	{
+		const int size = TEXTURE_SIZE >> mip;
+		for (int t = 0; t < size; ++t)
+		{
+			for (int s = 0; s < size; ++s)
+			{
+				u8 expected[4], sample[4], base[4];
+				TexDecoder_DecodeTexel(expected, src + level_offset, s, t, size - 1, GX_TF_I8, nullptr, GX_TL_IA8);
+				TextureSampler::SampleMip((s << 7) << mip, (t << 7) << mip, mip, false, 0, sample);
+				ASSERT_EQ(0, memcmp(expected, sample, 4)) << StringFromFormat("mip %d, texel %d,%d", mip, s, t);
+				// Alternate with the base level, like trilinear filtering.
+				TextureSampler::SampleMip(s << 7, t << 7, 0, false, 0, base);
+			}
+		}
+		level_offset += size * size;
+	}
+
+	// Each level is only checked once per draw, also when levels alternate.
+	u8 before[4], sample[4];
+	TextureSampler::SampleMip(0, 0, 1, false, 0, before);
+	m_ram[TEXTURE_ADDRESS + TEXTURE_SIZE * TEXTURE_SIZE] ^= 0xff;
+	TextureSampler::SampleMip(0, 0, 0, false, 0, sample);
+	TextureSampler::SampleMip(0, 0, 1, false, 0, sample);
+	EXPECT_EQ(0, memcmp(before, sample, 4));
+
+	TextureSampler::InvalidateCache();
+	TextureSampler::SampleMip(0, 0, 1, false, 0, sample);
+	EXPECT_NE(before[0], sample[0]);
+}
+
+// Bilinear sampling of a 640x528 frame, which takes four texels per pixel.
+TEST_F(TextureSamplerTest, BilinearFrame)
+{
+	const int width = 640, height = 528;
+	for (int format : {GX_TF_RGB5A3, GX_TF_C8, GX_TF_CMPR})
+	{
+		SetTexture(format);
+		u32 checksum_direct = 0, checksum_cached = 0;
+		u8 sample[4];
+
+		auto direct_start = std::chrono::high_resolution_clock::now();
+		for (int y = 0; y < height; ++y)
+		{
+			for (int x = 0; x < width; ++x)
+			{
+				SampleDirect(x * 29, y * 31, format, sample);
+				checksum_direct = checksum_direct * 31 + sample[0] + sample[3];
+			}
+		}
+		auto cached_start = std::chrono::high_resolution_clock::now();
+		for (int y = 0; y < height; ++y)
+		{
+			for (int x = 0; x < width; ++x)
+			{
+				TextureSampler::SampleMip(x * 29, y * 31, 0, true, 0, sample);
+				checksum_cached = checksum_cached * 31 + sample[0] + sample[3];
+			}
+		}
+		auto cached_end = std::chrono::high_resolution_clock::now();
+
+		EXPECT_EQ(checksum_direct, checksum_cached);
+		printf("Format %2d: decoding per texel %7llu us, cached %7llu us\n", format,
+		       AS_US(cached_start - direct_start), AS_US(cached_end - cached_start));
+	}
+}
@@ -0,0 +1,116 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/StringUtil.h"
+#include "VideoBackends/Software/NativeVertexFormat.h"
+#include "VideoBackends/Software/TransformUnit.h"
+#include "VideoCommon/XFMemory.h"
+
+#define AS_US(diff) ((unsigned long long)std::chrono::duration_cast<std::chrono::microseconds>(diff).count())
+
+class TransformUnitTest : public testing::Test
+{
+protected:
+	virtual void SetUp() override
+	{
+		memset(&xfmem, 0, sizeof(xfmem));
+
+		std::mt19937 rng(42);
+		std::uniform_real_distribution<float> matrix_dist(-2.0f, 2.0f);
+		for (u32& entry : xfmem.posMatrices)
+		{
+			float value = matrix_dist(rng);
+			memcpy(&entry, &value, sizeof(entry));
+		}
+		for (u32& entry : xfmem.normalMatrices)
+		{
+			float value = matrix_dist(rng);
+			memcpy(&entry, &value, sizeof(entry));
+		}
+		for (float& value : xfmem.projection.rawProjection)
+			value = matrix_dist(rng);
+	}
+
+	static std::vector<InputVertexData> RandomVertices(int count, bool same_matrix)
+	{
+		std::mt19937 rng(1234);
+		std::uniform_real_distribution<float> dist(-1000.0f, 1000.0f);
+		std::vector<InputVertexData> vertices(count);
+		for (InputVertexData& vertex : vertices)
+		{
+			memset(&vertex, 0, sizeof(vertex));
+			vertex.posMtx = same_matrix ? 0 : (rng() % 21) * 3;
+			vertex.position = Vec3(dist(rng), dist(rng), dist(rng));
+			for (Vec3& normal : vertex.normal)
+				normal = Vec3(dist(rng), dist(rng), dist(rng));
+		}
+		return vertices;
+	}
+
+	static void TransformScalar(const std::vector<InputVertexData>& src, std::vector<OutputVertexData>* dst)
+	{
+		for (size_t i = 0; i < src.size(); ++i)
+		{
+			TransformUnit::TransformPosition(&src[i], &(*dst)[i]);
+			TransformUnit::TransformNormal(&src[i], true, &(*dst)[i]);
+		}
+	}
+
+	static void TransformBatch(const std::vector<InputVertexData>& src, std::vector<OutputVertexData>* dst)
+	{
+		TransformUnit::TransformPositions(src.data(), dst->data(), (int)src.size());
+		TransformUnit::TransformNormals(src.data(), true, dst->data(), (int)src.size());
+	}
+};
+
+TEST_F(TransformUnitTest, BatchMatchesScalar)
+{
+	for (u32 type : {GX_PERSPECTIVE, GX_ORTHOGRAPHIC})
+	{
+		xfmem.projection.type = type;
+
+		// Not a multiple of four, so the remainder is transformed too.
+		std::vector<InputVertexData> src = RandomVertices(1001, false);
+		std::vector<OutputVertexData> expected(src.size());
+		std::vector<OutputVertexData> result(src.size());
+		memset(expected.data(), 0, expected.size() * sizeof(OutputVertexData));
+		memset(result.data(), 0, result.size() * sizeof(OutputVertexData));
+
+		TransformScalar(src, &expected);
+		TransformBatch(src, &result);
+
+		for (size_t i = 0; i < src.size(); ++i)
+			ASSERT_EQ(0, memcmp(&expected[i], &result[i], sizeof(OutputVertexData))) << StringFromFormat("type %u, vertex %zu", type, i);
+	}
+}
+
+TEST_F(TransformUnitTest, VerticesPerSecond)
+{
+	xfmem.projection.type = GX_PERSPECTIVE;
+	const int num_vertices = 200000;
+	std::vector<InputVertexData> src = RandomVertices(num_vertices, true);
+	std::vector<OutputVertexData> dst(src.size());
+	TransformScalar(src, &dst);
+
+	auto scalar_start = std::chrono::high_resolution_clock::now();
+	TransformScalar(src, &dst);
+	auto batch_start = std::chrono::high_resolution_clock::now();
+	TransformBatch(src, &dst);
+	auto batch_end = std::chrono::high_resolution_clock::now();
+
+	auto per_second = [](std::chrono::high_resolution_clock::duration diff) {
+		return num_vertices * 1000000ull / std::max(1ull, AS_US(diff));
+	};
+	printf("Position and normal transform of %d vertices:\n", num_vertices);
+	printf("Per vertex   %8llu us, %10llu vertices/s\n", AS_US(batch_start - scalar_start), per_second(batch_start - scalar_start));
+	printf("Batched      %8llu us, %10llu vertices/s\n", AS_US(batch_end - batch_start), per_second(batch_end - batch_start));
+}